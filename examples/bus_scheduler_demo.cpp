@@ -0,0 +1,158 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "devices/terminal.hpp"
+#include "common/command_scheduler.hpp"
+
+// One Terminal bus shared by three threads polling ALIVE back to back and a
+// passenger-feedback thread beeping every 50 ms. Run once with every command
+// in one FIFO class and once with BEEP as FEEDBACK; prints how long the
+// beeps sat behind polls and what the polls paid for it.
+//
+//   bus_scheduler_demo [seconds] [terminal_latency_ms]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct TerminalSim
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    int latency_ms;
+
+    explicit TerminalSim(int latency_ms) : latency_ms(latency_ms)
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+        thread = std::thread([this] { run(); });
+    }
+    ~TerminalSim()
+    {
+        running = false;
+        thread.join();
+        ::close(master);
+    }
+
+    void run()
+    {
+        std::vector<uint8_t> rx;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[256];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+                auto request = EpdiFrame::decode(rx.data(), len);
+                rx.erase(rx.begin(), rx.begin() + len);
+                if (!request.ok() || request.value().size() < 2) continue;
+
+                std::vector<uint8_t> reply(10, 0);
+                reply[0] = request.value()[0] & 0x7F;
+                reply[1] = request.value()[1];
+                std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+                auto frame = EpdiFrame::encode(reply.data(), reply.size());
+                (void)::write(master, frame.data(), frame.size());
+            }
+        }
+    }
+};
+
+double pct(std::vector<double> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+void run(const char* label, bool priority, double seconds, const std::string& port)
+{
+    SerialPort serial;
+    if (!serial.open(port).ok()) {
+        std::cerr << "Failed to open " << port << "\n";
+        std::exit(1);
+    }
+    Terminal terminal(serial);
+
+    obu::CommandScheduler bus;
+    bus.start();
+
+    std::atomic<bool> running{true};
+    std::mutex mutex;
+    std::vector<double> beep_ms, poll_ms;
+    int beep_failed = 0;
+
+    auto timed = [&](obu::CommandClass cls, auto fn, std::vector<double>& out) {
+        auto t0 = Clock::now();
+        auto r = bus.call(cls, fn);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        out.push_back(ms);
+        return r.ok();
+    };
+
+    std::vector<std::thread> pollers;
+    for (int i = 0; i < 3; i++) {
+        pollers.emplace_back([&] {
+            while (running) {
+                timed(obu::CommandClass::TELEMETRY, [&] { return terminal.alive(); }, poll_ms);
+            }
+        });
+    }
+    std::thread beeper([&] {
+        auto next = Clock::now();
+        while (running) {
+            next += std::chrono::milliseconds(50);
+            std::this_thread::sleep_until(next);
+            auto cls = priority ? obu::CommandClass::FEEDBACK : obu::CommandClass::TELEMETRY;
+            if (!timed(cls, [&] { return terminal.beep(); }, beep_ms)) beep_failed++;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    beeper.join();
+    for (auto& t : pollers) t.join();
+    bus.stop();
+
+    std::cout << std::fixed << std::setprecision(1) << label
+              << "beep p50 " << std::setw(5) << pct(beep_ms, 0.5) << "  p99 " << std::setw(5) << pct(beep_ms, 0.99)
+              << "  max " << std::setw(5) << pct(beep_ms, 1.0) << " ms (" << beep_ms.size() << ", "
+              << beep_failed << " failed) | poll p50 " << std::setw(5) << pct(poll_ms, 0.5)
+              << "  max " << std::setw(5) << pct(poll_ms, 1.0) << " ms (" << poll_ms.size() << ")\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 3.0;
+    int latency_ms = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    TerminalSim sim(latency_ms);
+    std::cout << "3 pollers back to back, beep every 50 ms, terminal answers in " << latency_ms << " ms\n";
+    run("  one FIFO class   ", false, seconds, sim.slave);
+    run("  BEEP as FEEDBACK ", true, seconds, sim.slave);
+    return 0;
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "transport/epdi.hpp"
+#include "validator/nfc_reader.hpp"
+#include "common/callback_executor.hpp"
+
+// A validator presenting a card every tap_ms to a card callback that takes
+// callback_ms (a slow consumer: a database write, a network call). The reader
+// only re-arms after the callback returns, so run inline the validator sees
+// it disarmed and taps are lost; behind a CallbackExecutor the read thread
+// re-arms at once and the callbacks queue instead.
+//
+//   callback_executor_demo [seconds] [tap_ms] [callback_ms]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct NfcSim
+{
+    int master = -1;
+    std::string slave;
+    std::thread reader;
+    std::thread tapper;
+    std::atomic<bool> running{true};
+    std::atomic<bool> armed{false};
+    std::atomic<bool> tapping{false};
+    std::mutex write_mutex;
+
+    int tap_ms;
+    std::mutex sent_mutex;
+    std::vector<Clock::time_point> sent;    // by card number
+    int missed = 0;
+
+    explicit NfcSim(int tap_ms) : tap_ms(tap_ms)
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+        reader = std::thread([this] { read_loop(); });
+        tapper = std::thread([this] { tap_loop(); });
+    }
+    ~NfcSim()
+    {
+        running = false;
+        reader.join();
+        tapper.join();
+        ::close(master);
+    }
+
+    void send(const std::vector<uint8_t>& bytes)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        (void)::write(master, bytes.data(), bytes.size());
+    }
+
+    // ENABLE arms the reader for one card; AUTH_A/AUTH_B get an ack.
+    void read_loop()
+    {
+        std::vector<uint8_t> rx;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[256];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            while (rx.size() >= 3) {
+                if (rx[0] != validator::NfcReader::ADDR_REQ) {
+                    rx.erase(rx.begin());
+                    continue;
+                }
+                uint8_t cmd = rx[1];
+                rx.clear();
+                if (cmd == validator::NfcReader::CMD_ENABLE) {
+                    armed = true;
+                } else {
+                    uint8_t ack[] = {0x72, cmd, 0x00, 0x00, 0x00};
+                    send(EpdiFrame::encode(ack, sizeof(ack)));
+                }
+            }
+        }
+    }
+
+    void tap_loop()
+    {
+        auto next = Clock::now();
+        while (running) {
+            next += std::chrono::milliseconds(tap_ms);
+            std::this_thread::sleep_until(next);
+            if (!tapping) continue;
+            if (!armed.exchange(false)) {
+                std::lock_guard<std::mutex> lock(sent_mutex);
+                missed++;
+                continue;
+            }
+
+            uint32_t number;
+            {
+                std::lock_guard<std::mutex> lock(sent_mutex);
+                number = static_cast<uint32_t>(sent.size());
+                sent.push_back(Clock::now());
+            }
+            std::vector<uint8_t> payload = {0x72, validator::NfcReader::SERVICE_READ_CARD, 0x00, 0xF2, 0x00,
+                                            0x00, 0x44, 0x88, 0x04, 0x00, 0x00, 0x00,
+                                            static_cast<uint8_t>(number >> 24), static_cast<uint8_t>(number >> 16),
+                                            static_cast<uint8_t>(number >> 8), static_cast<uint8_t>(number),
+                                            0x00, 0x20};
+            send(EpdiFrame::encode(payload.data(), payload.size()));
+        }
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(sent_mutex);
+        sent.clear();
+        missed = 0;
+    }
+};
+
+double pct(std::vector<double> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+void run(const char* label, obu::CallbackExecutor* executor, NfcSim& sim, double seconds, int callback_ms)
+{
+    validator::NfcReader reader(sim.slave.c_str());
+    auto init = reader.initialize();
+    if (!init.ok()) {
+        std::cerr << "initialize failed: " << static_cast<int>(init.error()) << "\n";
+        std::exit(1);
+    }
+
+    std::mutex mutex;
+    std::vector<double> start_ms;
+    reader.set_callback_executor(executor);
+    reader.set_card_callback([&](const validator::NfcCardInfo& card) {
+        auto now = Clock::now();
+        uint32_t number = static_cast<uint32_t>(std::strtoul(card.uid_hex.c_str() + 6, nullptr, 16));
+        {
+            std::lock_guard<std::mutex> lock(sim.sent_mutex);
+            if (number < sim.sent.size()) {
+                std::lock_guard<std::mutex> lock2(mutex);
+                start_ms.push_back(std::chrono::duration<double, std::milli>(now - sim.sent[number]).count());
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(callback_ms));
+    });
+
+    std::thread thread([&] { reader.start_reading(); });
+    sim.reset();
+    sim.tapping = true;
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    sim.tapping = false;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(callback_ms * 2));
+    reader.stop();
+    thread.join();
+    if (executor) executor->stop();
+
+    size_t presented, missed;
+    {
+        std::lock_guard<std::mutex> lock(sim.sent_mutex);
+        presented = sim.sent.size();
+        missed = sim.missed;
+    }
+    std::cout << std::fixed << std::setprecision(1) << label << std::setw(4) << start_ms.size() << " run / "
+              << std::setw(4) << presented << " read, " << std::setw(4) << missed << " taps missed";
+    if (executor) std::cout << ", " << std::setw(3) << executor->dropped() << " dropped";
+    std::cout << " | tap -> callback p50 " << std::setw(6) << pct(start_ms, 0.5) << "  p99 " << std::setw(6)
+              << pct(start_ms, 0.99) << " ms\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 2.0;
+    int tap_ms = argc > 2 ? std::atoi(argv[2]) : 25;
+    int callback_ms = argc > 3 ? std::atoi(argv[3]) : 20;
+
+    NfcSim sim(tap_ms);
+    std::cout << "tap every " << tap_ms << " ms, callback takes " << callback_ms << " ms\n";
+
+    run("  inline              ", nullptr, sim, seconds, callback_ms);
+
+    obu::CallbackExecutor::Options options;
+    obu::CallbackExecutor queued(options);
+    queued.start();
+    run("  executor DROP_OLDEST", &queued, sim, seconds, callback_ms);
+
+    // Callback slower than taps, small queue: the backlog is capped and the
+    // most recent card still runs.
+    options.capacity = 4;
+    options.overflow = obu::OverflowPolicy::COALESCE;
+    obu::CallbackExecutor coalesced(options);
+    coalesced.start();
+    run("  executor COALESCE/4 ", &coalesced, sim, seconds, callback_ms * 2);
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cstdlib>
+#include "devices/corvus_nfc_reader.hpp"
+
+using namespace obu;
+
+// Both reader specializations are plain classes: no vtable anywhere on the
+// request/response path.
+static_assert(!std::is_polymorphic<CorvusNfcReader>::value, "CorvusNfcReader must not be polymorphic");
+static_assert(!std::is_polymorphic<CorvusIsoReader>::value, "CorvusIsoReader must not be polymorphic");
+static_assert(!std::is_polymorphic<corvus::LengthPrefixedCodec>::value, "codec must be static");
+static_assert(!std::is_polymorphic<corvus::IsoCodec>::value, "codec must be static");
+
+namespace {
+
+// A runtime-polymorphic codec, as the reader would need without the policy
+// template. Only used as a reference point.
+struct VirtualCodec
+{
+    virtual ~VirtualCodec() = default;
+    virtual bool read_uid(corvus::SendBuffer& out, uint16_t seq) = 0;
+    virtual void feed(const uint8_t* data, size_t len) = 0;
+    virtual Result<bool> next(std::vector<uint8_t>& msg) = 0;
+    virtual bool matches(std::string_view msg, uint16_t seq) = 0;
+    virtual Result<corvus::Reply> decode(std::string_view msg, corvus::Command command) = 0;
+};
+
+template <typename Codec>
+struct VirtualAdapter : VirtualCodec
+{
+    typename Codec::Decoder rx;
+    bool read_uid(corvus::SendBuffer& out, uint16_t seq) override { return Codec::read_uid(out, seq); }
+    void feed(const uint8_t* data, size_t len) override { rx.feed(data, len); }
+    Result<bool> next(std::vector<uint8_t>& msg) override { return rx.next(msg); }
+    bool matches(std::string_view msg, uint16_t seq) override { return Codec::matches(msg, seq); }
+    Result<corvus::Reply> decode(std::string_view msg, corvus::Command command) override
+    {
+        return Codec::decode(msg, command);
+    }
+};
+
+// One tap: build the 95/UID request, take the reply off the stream, match and decode it.
+template <typename Codec>
+size_t tap_static(typename Codec::Decoder& rx, corvus::SendBuffer& tx, const std::vector<uint8_t>& reply,
+                  std::vector<uint8_t>& msg)
+{
+    Codec::read_uid(tx, 1);
+    rx.feed(reply.data(), reply.size());
+    if (!rx.next(msg).ok()) return 0;
+    auto view = corvus::as_view(msg);
+    if (!Codec::matches(view, 1)) return 0;
+    auto r = Codec::decode(view, corvus::Command::READ_UID);
+    return r.ok() ? r.value().data.size() + tx.size() : 0;
+}
+
+size_t tap_virtual(VirtualCodec& codec, corvus::SendBuffer& tx, const std::vector<uint8_t>& reply,
+                   std::vector<uint8_t>& msg)
+{
+    codec.read_uid(tx, 1);
+    codec.feed(reply.data(), reply.size());
+    if (!codec.next(msg).ok()) return 0;
+    auto view = corvus::as_view(msg);
+    if (!codec.matches(view, 1)) return 0;
+    auto r = codec.decode(view, corvus::Command::READ_UID);
+    return r.ok() ? r.value().data.size() + tx.size() : 0;
+}
+
+std::vector<uint8_t> length_prefixed_reply()
+{
+    std::string body = "1100000001950000" "4A1B2C3D4E5F6";
+    std::vector<uint8_t> frame = {0, static_cast<uint8_t>(body.size())};
+    frame.insert(frame.end(), body.begin(), body.end());
+    return frame;
+}
+
+std::vector<uint8_t> iso_reply()
+{
+    std::string body = "02109001000001\x1C" "6304A1B2C3D4E5F6";
+    uint8_t lrc = 0;
+    for (char c : body) lrc ^= static_cast<uint8_t>(c);
+    std::vector<uint8_t> frame = {0x02};
+    frame.insert(frame.end(), body.begin(), body.end());
+    frame.push_back(0x03);
+    frame.push_back(lrc);
+    return frame;
+}
+
+template <typename Fn>
+void report(const char* name, int iterations, Fn&& fn)
+{
+    size_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink += fn();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+    std::cout << name << ns << " ns/tap" << (sink ? "" : "  (decode failed)") << "\n";
+}
+
+template <typename Codec>
+void bench(const char* label, const std::vector<uint8_t>& reply, int iterations)
+{
+    corvus::SendBuffer tx;
+    std::vector<uint8_t> msg;
+    typename Codec::Decoder rx;
+    std::unique_ptr<VirtualCodec> virt(new VirtualAdapter<Codec>());
+
+    std::cout << label << "\n";
+    report("  static policy:    ", iterations, [&] { return tap_static<Codec>(rx, tx, reply, msg); });
+    report("  virtual baseline: ", iterations, [&] { return tap_virtual(*virt, tx, reply, msg); });
+}
+
+} // anonymous namespace
+
+// Measures the per-tap codec cost of each reader specialization.
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000000;
+
+    bench<corvus::LengthPrefixedCodec>("Length-prefixed (ECRProxy):", length_prefixed_reply(), iterations);
+    bench<corvus::IsoCodec>("STX/ETX/LRC:", iso_reply(), iterations);
+    return 0;
+}
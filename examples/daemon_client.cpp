@@ -0,0 +1,179 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <csignal>
+#include "daemon/client.hpp"
+#include "daemon/remote.hpp"
+
+// Talks to a running obu-daemon through the remote device classes.
+//
+//   daemon_client [--socket path] alive         mboard and terminal ALIVE
+//   daemon_client [--socket path] beep          terminal beep
+//   daemon_client [--socket path] gps           last NMEA sentence
+//   daemon_client [--socket path] regs s n [fresh]  Mboard registers s..s+n-1
+//   daemon_client [--socket path] set s v...    write Mboard registers from s
+//   daemon_client [--socket path] nfc           wait for one validator card
+//   daemon_client [--socket path] corvus        wait for one Corvus card
+//   daemon_client [--socket path] qr            wait for one QR code
+//   daemon_client [--socket path] watch         print cards, codes and register changes until ^C
+//   daemon_client [--socket path] ping [n]      n pipelined PINGs, reports throughput
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+obu::remote::EventLoop* g_loops[2] = {nullptr, nullptr};
+
+void on_signal(int)
+{
+    for (auto* loop : g_loops) {
+        if (loop) loop->stop();
+    }
+}
+
+int fail(const char* what, Error error)
+{
+    std::cout << "[FAIL] " << what << " (error " << static_cast<int>(error) << ")\n";
+    return 1;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    std::string path = obu::DaemonClient::DEFAULT_PATH;
+    int arg = 1;
+    if (argc > 2 && std::string(argv[1]) == "--socket") {
+        path = argv[2];
+        arg = 3;
+    }
+    std::string cmd = argc > arg ? argv[arg] : "alive";
+
+    obu::DaemonClient client(path);
+    if (!client.connect().ok()) {
+        std::cerr << "Cannot connect to " << path << "\n";
+        return 1;
+    }
+
+    if (cmd == "alive") {
+        obu::remote::Mboard mboard(client);
+        auto r = mboard.alive();
+        if (r.ok()) {
+            std::cout << "[OK] Mboard - Uptime: " << r.value().uptime_seconds << "s\n";
+        } else {
+            fail("Mboard ALIVE", r.error());
+        }
+        obu::remote::Terminal terminal(client);
+        auto t = terminal.alive();
+        if (t.ok()) {
+            std::cout << "[OK] Terminal - HW: 0x" << std::hex << t.value().hw_version << std::dec << "\n";
+        } else {
+            fail("Terminal ALIVE", t.error());
+        }
+        return r.ok() && t.ok() ? 0 : 1;
+    }
+
+    if (cmd == "beep") {
+        obu::remote::Terminal terminal(client);
+        auto r = terminal.beep();
+        return r.ok() ? (std::cout << "[OK] Beep\n", 0) : fail("Beep", r.error());
+    }
+
+    if (cmd == "gps") {
+        obu::remote::Mboard mboard(client);
+        auto r = mboard.gps();
+        return r.ok() ? (std::cout << "[OK] " << r.value().nmea << "\n", 0) : fail("GPS", r.error());
+    }
+
+    if (cmd == "regs") {
+        obu::remote::Mboard mboard(client);
+        uint8_t start = static_cast<uint8_t>(argc > arg + 1 ? std::strtoul(argv[arg + 1], nullptr, 0) : 0);
+        uint8_t count = static_cast<uint8_t>(argc > arg + 2 ? std::strtoul(argv[arg + 2], nullptr, 0) : 1);
+        bool fresh = argc > arg + 3 && std::string(argv[arg + 3]) == "fresh";
+        auto r = mboard.read_registers(start, count, fresh);
+        if (!r.ok()) return fail("READ_REGISTERS", r.error());
+        std::cout << "[OK]" << std::hex;
+        for (uint8_t value : r.value()) std::cout << " " << static_cast<int>(value);
+        std::cout << std::dec << "\n";
+        return 0;
+    }
+
+    if (cmd == "set") {
+        obu::remote::Mboard mboard(client);
+        if (argc < arg + 3) return fail("WRITE_REGISTERS", Error::PARSE_ERROR);
+        uint8_t start = static_cast<uint8_t>(std::strtoul(argv[arg + 1], nullptr, 0));
+        std::vector<uint8_t> values;
+        for (int i = arg + 2; i < argc; i++) values.push_back(static_cast<uint8_t>(std::strtoul(argv[i], nullptr, 0)));
+        auto r = mboard.write_registers(start, values);
+        return r.ok() ? (std::cout << "[OK] Written\n", 0) : fail("WRITE_REGISTERS", r.error());
+    }
+
+    if (cmd == "nfc") {
+        obu::remote::NfcReader nfc(client);
+        auto r = nfc.read_single_card();
+        return r.ok() ? (std::cout << "[OK] Card UID: " << r.value().uid_hex << "\n", 0) : fail("NFC", r.error());
+    }
+
+    if (cmd == "corvus") {
+        obu::remote::CorvusNfcReader corvus(client);
+        auto r = corvus.read_nfc_uid();
+        return r.ok() ? (std::cout << "[OK] Card UID: " << r.value() << "\n", 0) : fail("Corvus", r.error());
+    }
+
+    if (cmd == "qr") {
+        obu::remote::QrScanner qr(client);
+        auto r = qr.scan_once();
+        return r.ok() ? (std::cout << "[OK] Code: " << r.value() << "\n", 0) : fail("QR", r.error());
+    }
+
+    if (cmd == "watch") {
+        obu::remote::NfcReader nfc(client);
+        obu::remote::QrScanner qr(client);
+        g_loops[0] = &nfc;
+        g_loops[1] = &qr;
+        std::signal(SIGINT, on_signal);
+        std::signal(SIGTERM, on_signal);
+
+        nfc.set_card_callback([](const validator::NfcCardInfo& card) {
+            std::cout << "card " << card.uid_hex << std::endl;
+        });
+        qr.set_scan_callback([](const std::string& code) {
+            std::cout << "qr   " << code << std::endl;
+        });
+        client.add_listener(obu::daemon::TOPIC_REGISTERS, [](const std::vector<uint8_t>& payload) {
+            std::cout << "regs" << std::hex;
+            for (size_t i = 0; i + 1 < payload.size(); i += 2) {
+                std::cout << " " << static_cast<int>(payload[i]) << "=" << static_cast<int>(payload[i + 1]);
+            }
+            std::cout << std::dec << std::endl;
+        });
+        std::thread cards([&nfc] { nfc.start_reading(); });
+        auto r = qr.start_continuous();
+        nfc.stop();
+        cards.join();
+        return r.ok() ? 0 : fail("watch", r.error());
+    }
+
+    if (cmd == "ping") {
+        int n = argc > arg + 1 ? std::atoi(argv[arg + 1]) : 10000;
+        std::vector<std::future<obu::DaemonClient::Reply>> replies;
+        replies.reserve(n);
+        auto t0 = Clock::now();
+        for (int i = 0; i < n; i++) {
+            replies.push_back(client.request(obu::daemon::MSG_PING));
+        }
+        int failed = 0;
+        for (auto& reply : replies) {
+            if (!reply.get().ok()) failed++;
+        }
+        double s = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::cout << n << " pings in " << s * 1000 << " ms (" << static_cast<long>(n / s) << "/s), "
+                  << failed << " failed\n";
+        return failed ? 1 : 0;
+    }
+
+    std::cerr << "Unknown command " << cmd << "\n";
+    return 1;
+}
@@ -0,0 +1,481 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "transport/epdi.hpp"
+#include "common/protocol.hpp"
+#include "daemon/daemon.hpp"
+#include "daemon/protocol.hpp"
+#include "validator/nfc_reader.hpp"
+
+// Scaling benchmark for obu-daemon. The daemon runs on pty simulators of the
+// Mboard, Terminal, QR scanner and validator; for each client count N the
+// load generator opens N connections, all subscribed to every topic, while a
+// few of them send a steady mix of MBOARD_ALIVE, TERMINAL_ALIVE and PING.
+// Simulated taps carry their send time, so each delivery gives a latency:
+//
+//   card / qr    device write -> client read. The floor is the reader's
+//                SerialPort frame gap (5 ms validator, 100 ms QR).
+//   spread       first -> last client to receive the same event, i.e. the
+//                cost of the fan-out itself.
+//
+//   daemon_load [clients=1,10,50,100,200,400] [seconds=3] [taps_per_s=10]
+//               [cmd_clients=8] [cmd_per_s=50]
+
+using Clock = std::chrono::steady_clock;
+using namespace obu::daemon;
+
+namespace {
+
+uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+struct Pty
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    std::mutex write_mutex;
+
+    Pty()
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+    }
+    virtual ~Pty()
+    {
+        stop();
+        ::close(master);
+    }
+
+    void start() { thread = std::thread([this] { run(); }); }
+    // Before destruction: run() calls into the derived simulator.
+    void stop()
+    {
+        running = false;
+        if (thread.joinable()) thread.join();
+    }
+
+    void send(const std::vector<uint8_t>& bytes)
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        (void)::write(master, bytes.data(), bytes.size());
+    }
+
+    void run()
+    {
+        std::vector<uint8_t> rx;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[256];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+            on_data(rx);
+        }
+    }
+
+    virtual void on_data(std::vector<uint8_t>& rx) = 0;
+};
+
+// Answers ALIVE with a 17-byte reply and GPS with a sentence stamped with the reply time.
+struct MboardSim : Pty
+{
+    void on_data(std::vector<uint8_t>& rx) override
+    {
+        while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+            auto request = EpdiFrame::decode(rx.data(), len);
+            rx.erase(rx.begin(), rx.begin() + len);
+            if (!request.ok() || request.value().size() < 4) continue;
+
+            auto& cmd = request.value();
+            std::vector<uint8_t> reply(5, 0);
+            reply[0] = Protocol::Mboard::RESPONSE;
+            reply[1] = cmd[1];
+            reply[2] = cmd[2];
+            reply[3] = cmd[3];
+            if (cmd[1] == Protocol::Service::GPS) {
+                std::string nmea = "$GPTST," + std::to_string(now_ns());
+                reply.insert(reply.end(), nmea.begin(), nmea.end());
+            } else {
+                reply.resize(17, 0);
+            }
+            send(EpdiFrame::encode(reply.data(), reply.size()));
+        }
+    }
+};
+
+// Answers every terminal request from the terminal's own address.
+struct TerminalSim : Pty
+{
+    void on_data(std::vector<uint8_t>& rx) override
+    {
+        while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+            auto request = EpdiFrame::decode(rx.data(), len);
+            rx.erase(rx.begin(), rx.begin() + len);
+            if (!request.ok() || request.value().size() < 2) continue;
+
+            std::vector<uint8_t> reply(10, 0);
+            reply[0] = request.value()[0] & 0x7F;
+            reply[1] = request.value()[1];
+            send(EpdiFrame::encode(reply.data(), reply.size()));
+        }
+    }
+};
+
+// ACKs trigger commands; tap() sends a code holding the send time.
+struct QrSim : Pty
+{
+    void on_data(std::vector<uint8_t>& rx) override
+    {
+        rx.clear();
+        send({0x06});
+    }
+
+    void tap()
+    {
+        std::string code = "Q" + std::to_string(now_ns()) + "\r";
+        send(std::vector<uint8_t>(code.begin(), code.end()));
+    }
+};
+
+// Answers AUTH_A / AUTH_B; after each ENABLE, tap() sends one card whose
+// 7-byte UID is the low 56 bits of the send time.
+struct NfcSim : Pty
+{
+    std::atomic<bool> enabled{false};
+    std::atomic<int> skipped{0};
+
+    void on_data(std::vector<uint8_t>& rx) override
+    {
+        while (rx.size() >= 3) {
+            if (rx[0] != validator::NfcReader::ADDR_REQ) {
+                rx.erase(rx.begin());
+                continue;
+            }
+            uint8_t cmd = rx[1];
+            rx.clear();
+            if (cmd == validator::NfcReader::CMD_ENABLE) {
+                enabled = true;
+            } else {
+                uint8_t ack[] = {0x72, cmd, 0x00, 0x00, 0x00};
+                send(EpdiFrame::encode(ack, sizeof(ack)));
+            }
+        }
+    }
+
+    void tap()
+    {
+        if (!enabled.exchange(false)) {
+            skipped++;
+            return;
+        }
+        uint64_t t = now_ns();
+        uint8_t uid[7];
+        for (int i = 0; i < 7; i++) uid[i] = static_cast<uint8_t>(t >> ((6 - i) * 8));
+
+        std::vector<uint8_t> payload = {0x72, validator::NfcReader::SERVICE_READ_CARD, 0x00, 0xF2, 0x00,
+                                        0x00, 0x44, 0x88, uid[0], uid[1], uid[2], 0x00,
+                                        uid[3], uid[4], uid[5], uid[6], 0x00, 0x20};
+        send(EpdiFrame::encode(payload.data(), payload.size()));
+    }
+};
+
+// Send time carried by an event payload, 0 if none.
+uint64_t stamp_of(uint8_t topic, const std::vector<uint8_t>& payload)
+{
+    if (topic == TOPIC_CARD) {
+        auto card = decode_card(payload);
+        if (!card.ok() || card.value().uid.size() != 14) return 0;
+        uint64_t low = std::strtoull(card.value().uid.c_str(), nullptr, 16);
+        uint64_t now = now_ns();
+        uint64_t t = (now & ~((1ull << 56) - 1)) | low;
+        return t > now ? t - (1ull << 56) : t;
+    }
+    std::string text(payload.begin(), payload.end());
+    size_t digits = text.find_first_of("0123456789");
+    return digits == std::string::npos ? 0 : std::strtoull(text.c_str() + digits, nullptr, 10);
+}
+
+struct Delivery
+{
+    uint64_t first = 0;
+    uint64_t last = 0;
+    int count = 0;
+};
+
+struct Conn
+{
+    int fd = -1;
+    FrameReader rx;
+    std::map<uint32_t, std::pair<uint8_t, uint64_t>> in_flight;   // id -> type, send time
+    uint32_t next_id = 1;
+};
+
+struct Step
+{
+    int clients = 0;
+    int taps = 0;
+    long delivered = 0;
+    long expected = 0;
+    std::vector<double> card_us, qr_us, spread_us;
+    std::map<uint8_t, std::vector<double>> cmd_us;
+    long cmd_errors = 0;
+    double seconds = 0;
+};
+
+double pct(std::vector<double>& v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+int connect_to(const std::string& path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void send_request(Conn& conn, uint8_t type, const std::vector<uint8_t>& body)
+{
+    uint32_t id = conn.next_id++;
+    conn.in_flight[id] = {type, now_ns()};
+    auto frame = encode_frame(type, id, body.data(), body.size());
+    (void)::send(conn.fd, frame.data(), frame.size(), MSG_NOSIGNAL);
+}
+
+Step run_step(const std::string& path, int clients, double seconds, int taps_per_s,
+              int cmd_clients, int cmd_per_s, QrSim& qr, NfcSim& nfc)
+{
+    Step step;
+    step.clients = clients;
+
+    std::vector<Conn> conns(clients);
+    std::vector<uint8_t> topics;
+    put_be(topics, (1u << TOPIC_CARD) | (1u << TOPIC_QR) | (1u << TOPIC_GPS), 4);
+    for (auto& conn : conns) {
+        conn.fd = connect_to(path);
+        if (conn.fd < 0) {
+            std::cerr << "connect failed after " << (&conn - conns.data()) << " clients\n";
+            std::exit(1);
+        }
+        send_request(conn, MSG_SUBSCRIBE, topics);
+    }
+
+    std::map<uint64_t, Delivery> deliveries;
+    std::vector<struct pollfd> pfds(clients);
+    for (int i = 0; i < clients; i++) pfds[i] = {conns[i].fd, POLLIN, 0};
+
+    auto receive = [&](bool measuring) {
+        if (poll(pfds.data(), pfds.size(), 1) <= 0) return;
+        Frame frame;
+        uint8_t buf[16 * 1024];
+        for (int i = 0; i < clients; i++) {
+            if (!(pfds[i].revents & POLLIN)) continue;
+            Conn& conn = conns[i];
+            ssize_t n = ::read(conn.fd, buf, sizeof(buf));
+            if (n <= 0) continue;
+            conn.rx.feed(buf, n);
+            uint64_t t = now_ns();
+            for (;;) {
+                auto next = conn.rx.next(frame);
+                if (!next.ok() || !next.value()) break;
+                if (frame.type == MSG_REPLY) {
+                    auto it = conn.in_flight.find(frame.id);
+                    if (it == conn.in_flight.end()) continue;
+                    if (measuring && it->second.first != MSG_SUBSCRIBE) {
+                        if (decode_reply(frame.body).ok()) {
+                            step.cmd_us[it->second.first].push_back((t - it->second.second) / 1e3);
+                        } else {
+                            step.cmd_errors++;
+                        }
+                    }
+                    conn.in_flight.erase(it);
+                } else if (frame.type == MSG_EVENT && !frame.body.empty() && measuring) {
+                    uint8_t topic = frame.body[0];
+                    std::vector<uint8_t> payload(frame.body.begin() + 1, frame.body.end());
+                    uint64_t sent = stamp_of(topic, payload);
+                    if (!sent) continue;
+                    step.delivered++;
+                    if (topic == TOPIC_CARD) step.card_us.push_back((t - sent) / 1e3);
+                    if (topic == TOPIC_QR) step.qr_us.push_back((t - sent) / 1e3);
+                    auto& d = deliveries[sent];
+                    if (!d.count++) d.first = t;
+                    d.last = t;
+                }
+            }
+        }
+    };
+
+    // Subscriptions in place before any event is counted.
+    auto settle = Clock::now() + std::chrono::seconds(2);
+    while (Clock::now() < settle &&
+           std::any_of(conns.begin(), conns.end(), [](const Conn& c) { return !c.in_flight.empty(); })) {
+        receive(false);
+    }
+
+    std::atomic<bool> tapping{true};
+    std::atomic<int> taps{0};
+    std::thread tapper([&] {
+        auto next = Clock::now();
+        for (int i = 0; tapping; i++) {
+            next += std::chrono::microseconds(1000000 / std::max(1, taps_per_s));
+            std::this_thread::sleep_until(next);
+            if (!tapping) break;
+            if (i % 2) qr.tap(); else nfc.tap();
+            taps++;
+        }
+    });
+
+    static const uint8_t mix[] = {MSG_MBOARD_ALIVE, MSG_TERMINAL_ALIVE, MSG_PING};
+    int senders = std::min(clients, cmd_clients);
+    auto period = std::chrono::microseconds(1000000 / std::max(1, cmd_per_s * std::max(1, senders)));
+    auto next_cmd = Clock::now();
+    int sent = 0;
+
+    auto t0 = Clock::now();
+    auto end = t0 + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    while (Clock::now() < end) {
+        while (senders > 0 && cmd_per_s > 0 && Clock::now() >= next_cmd) {
+            uint8_t type = mix[sent % 3];
+            std::vector<uint8_t> body;
+            if (type == MSG_TERMINAL_ALIVE) body.push_back(static_cast<uint8_t>(TerminalAddress::TERMINAL_A));
+            send_request(conns[sent % senders], type, body);
+            sent++;
+            next_cmd += period;
+        }
+        receive(true);
+    }
+    tapping = false;
+    tapper.join();
+
+    // Let the last events and replies drain.
+    auto drain = Clock::now() + std::chrono::milliseconds(300);
+    while (Clock::now() < drain) receive(true);
+    step.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    for (auto& entry : deliveries) {
+        step.spread_us.push_back((entry.second.last - entry.second.first) / 1e3);
+        step.expected += clients;
+    }
+    step.taps = taps.load();
+    for (auto& conn : conns) ::close(conn.fd);
+    return step;
+}
+
+std::vector<int> parse_list(const char* arg)
+{
+    std::vector<int> out;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) out.push_back(std::atoi(item.c_str()));
+    return out;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> steps = parse_list(argc > 1 ? argv[1] : "1,10,50,100,200,400");
+    double seconds = argc > 2 ? std::atof(argv[2]) : 3.0;
+    int taps_per_s = argc > 3 ? std::atoi(argv[3]) : 10;
+    int cmd_clients = argc > 4 ? std::atoi(argv[4]) : 8;
+    int cmd_per_s = argc > 5 ? std::atoi(argv[5]) : 50;
+
+    MboardSim mboard;
+    TerminalSim terminal;
+    QrSim qr;
+    NfcSim nfc;
+    mboard.start();
+    terminal.start();
+    qr.start();
+    nfc.start();
+
+    obu::DaemonConfig config;
+    config.socket_path = "/tmp/obu-daemon-load-" + std::to_string(getpid()) + ".sock";
+    config.mboard_port = mboard.slave;
+    config.terminal_port = terminal.slave;
+    config.qr_port = qr.slave;
+    config.validator_port = nfc.slave;
+    config.gps_interval_ms = 200;
+    config.max_clients = *std::max_element(steps.begin(), steps.end()) + 1;
+
+    obu::Daemon daemon(config);
+    if (!daemon.start().ok()) {
+        std::cerr << "Failed to start daemon on " << config.socket_path << "\n";
+        return 1;
+    }
+    // Readers finish their handshakes.
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    std::cout << "taps " << taps_per_s << "/s, GPS every " << config.gps_interval_ms << " ms, "
+              << cmd_clients << " command clients x " << cmd_per_s << " cmd/s, " << seconds << " s per step\n\n";
+    std::cout << std::fixed << std::setprecision(0)
+              << "clients  events  delivered  lost   deliv/s | card p50   p99 | qr p50    p99 |"
+              << " spread p50   p99   max | cmd/s  mboard p50  p99  term p50  p99  ping p50  p99  err  (us)\n";
+
+    for (int clients : steps) {
+        Step s = run_step(config.socket_path, clients, seconds, taps_per_s, cmd_clients, cmd_per_s, qr, nfc);
+        long cmds = 0;
+        for (auto& entry : s.cmd_us) cmds += entry.second.size();
+        auto& mb = s.cmd_us[MSG_MBOARD_ALIVE];
+        auto& term = s.cmd_us[MSG_TERMINAL_ALIVE];
+        auto& ping = s.cmd_us[MSG_PING];
+        std::cout << std::setw(7) << clients
+                  << std::setw(8) << s.spread_us.size()
+                  << std::setw(11) << s.delivered
+                  << std::setw(6) << (s.expected - s.delivered)
+                  << std::setw(10) << s.delivered / s.seconds << " |"
+                  << std::setw(9) << pct(s.card_us, 0.5) << std::setw(6) << pct(s.card_us, 0.99) << " |"
+                  << std::setw(7) << pct(s.qr_us, 0.5) << std::setw(7) << pct(s.qr_us, 0.99) << " |"
+                  << std::setw(11) << pct(s.spread_us, 0.5) << std::setw(6) << pct(s.spread_us, 0.99)
+                  << std::setw(6) << pct(s.spread_us, 1.0) << " |"
+                  << std::setw(6) << cmds / s.seconds
+                  << std::setw(12) << pct(mb, 0.5) << std::setw(5) << pct(mb, 0.99)
+                  << std::setw(10) << pct(term, 0.5) << std::setw(5) << pct(term, 0.99)
+                  << std::setw(10) << pct(ping, 0.5) << std::setw(5) << pct(ping, 0.99)
+                  << std::setw(5) << s.cmd_errors << "\n";
+    }
+
+    if (nfc.skipped) {
+        std::cout << "\n" << nfc.skipped << " card taps skipped, reader not yet re-enabled\n";
+    }
+    daemon.stop();
+    for (Pty* sim : std::initializer_list<Pty*>{&mboard, &terminal, &qr, &nfc}) sim->stop();
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "transport/serial.hpp"
+#include "devices/qr_scanner.hpp"
+#include "devices/corvus_nfc_reader.hpp"
+#include "validator/nfc_reader.hpp"
+
+// Wakeups-per-second measurement mode: runs each device read loop against an
+// idle line (a pty with nobody talking, or a silent TCP peer) and counts how
+// often the loop thread is scheduled, from the kernel's per-thread context
+// switch counters. A tickless loop should report ~0.
+
+namespace {
+
+uint64_t context_switches(long tid)
+{
+    std::ifstream status("/proc/self/task/" + std::to_string(tid) + "/status");
+    std::string line;
+    uint64_t total = 0;
+    while (std::getline(status, line)) {
+        if (line.find("ctxt_switches:") != std::string::npos) {
+            total += std::strtoull(line.substr(line.find(':') + 1).c_str(), nullptr, 10);
+        }
+    }
+    return total;
+}
+
+struct Pty
+{
+    int master = -1;
+    std::string slave;
+
+    bool open()
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) return false;
+        slave = ptsname(master);
+        return true;
+    }
+    ~Pty() { if (master >= 0) ::close(master); }
+};
+
+// Runs `loop` on its own thread, lets it settle, then samples its wakeups
+// over `seconds` before calling `stop` and joining.
+void measure(const char* name, int seconds, std::function<void()> loop, std::function<void()> stop)
+{
+    std::atomic<long> tid{0};
+    std::thread worker([&] {
+        tid.store(syscall(SYS_gettid));
+        loop();
+    });
+
+    while (tid.load() == 0) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::seconds(3));      // initialisation traffic
+
+    uint64_t before = context_switches(tid.load());
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    uint64_t after = context_switches(tid.load());
+
+    auto t0 = std::chrono::steady_clock::now();
+    stop();
+    worker.join();
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::cout << name << static_cast<double>(after - before) / seconds << " wakeups/s, stop took "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << " ms\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+
+    {
+        Pty pty;
+        SerialPort serial;
+        if (!pty.open() || !serial.open(pty.slave).ok()) {
+            std::cerr << "Failed to open pty\n";
+            return 1;
+        }
+        serial.set_timeout_ms(SerialPort::WAIT_FOREVER);
+        volatile bool running = true;
+        measure("SerialPort::read:            ", seconds,
+                [&] { serial.read(running); },
+                [&] { running = false; serial.cancel(); });
+    }
+
+    {
+        Pty pty;
+        SerialPort serial;
+        if (!pty.open() || !serial.open(pty.slave).ok()) {
+            std::cerr << "Failed to open pty\n";
+            return 1;
+        }
+        QrScanner qr(serial);
+        measure("QrScanner::start_continuous: ", seconds,
+                [&] { qr.start_continuous(); },
+                [&] { qr.stop(); });
+    }
+
+    {
+        Pty pty;
+        if (!pty.open()) {
+            std::cerr << "Failed to open pty\n";
+            return 1;
+        }
+        validator::NfcReader nfc(pty.slave.c_str());
+        measure("validator::NfcReader:        ", seconds,
+                [&] { nfc.start_reading(); },
+                [&] { nfc.stop(); });
+    }
+
+    {
+        // Accepts the connection through the backlog and never answers, so the
+        // reader sits in its response wait. ECRProxy requires a keepalive
+        // every KEEPALIVE_INTERVAL_MS while a request is outstanding.
+        int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (::bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listener, 1) < 0 ||
+            getsockname(listener, (struct sockaddr*)&addr, &len) < 0) {
+            std::cerr << "Failed to open listener\n";
+            return 1;
+        }
+        obu::CorvusNfcReader corvus("127.0.0.1", ntohs(addr.sin_port));
+        measure("CorvusNfcReader (keepalive): ", seconds,
+                [&] { corvus.start_reading(nullptr); },
+                [&] { corvus.stop_reading(); });
+        ::close(listener);
+    }
+
+    return 0;
+}
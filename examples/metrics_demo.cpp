@@ -0,0 +1,158 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "devices/mboard.hpp"
+#include "common/protocol.hpp"
+#include "common/metrics.hpp"
+#include "common/metrics_server.hpp"
+
+// Polls a simulated main board (pty, drops every 20th reply) from a device
+// thread while the exporter serves the registry on a Unix socket, then scrapes
+// it like Prometheus would and prints the last exposition.
+//
+//   metrics_demo [socket_path] [seconds]
+//   curl --unix-socket /tmp/obu-metrics.sock http://obu/metrics
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct BoardSim
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    int requests = 0;
+
+    BoardSim()
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+        thread = std::thread([this] { run(); });
+    }
+    ~BoardSim()
+    {
+        running = false;
+        thread.join();
+        ::close(master);
+    }
+
+    void run()
+    {
+        std::vector<uint8_t> rx;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[256];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+                auto request = EpdiFrame::decode(rx.data(), len);
+                rx.erase(rx.begin(), rx.begin() + len);
+                if (!request.ok() || request.value().size() < 4) continue;
+                if (++requests % 20 == 0) continue;
+
+                std::vector<uint8_t> reply(17, 0);
+                reply[0] = Protocol::Mboard::RESPONSE;
+                reply[1] = request.value()[1];
+                reply[2] = request.value()[2];
+                reply[3] = request.value()[3];
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                auto frame = EpdiFrame::encode(reply.data(), reply.size());
+                (void)::write(master, frame.data(), frame.size());
+            }
+        }
+    }
+};
+
+std::string scrape(const std::string& path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    std::string reply;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+        const char request[] = "GET /metrics HTTP/1.0\r\nHost: obu\r\n\r\n";
+        (void)::write(fd, request, sizeof(request) - 1);
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::read(fd, buf, sizeof(buf))) > 0) reply.append(buf, n);
+    }
+    ::close(fd);
+    return reply;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    std::string path = argc > 1 ? argv[1] : "/tmp/obu-metrics.sock";
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    BoardSim sim;
+    SerialPort serial;
+    if (!serial.open(sim.slave).ok()) {
+        std::cerr << "Failed to open " << sim.slave << "\n";
+        return 1;
+    }
+    Mboard mboard(serial);
+
+    obu::MetricsRegistry registry;
+    serial.register_metrics(registry, "mboard");
+    mboard.register_metrics(registry, "mboard");
+
+    obu::MetricsServer server(registry, path);
+    if (!server.start().ok()) {
+        std::cerr << "Failed to listen on " << path << "\n";
+        return 1;
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> calls{0};
+    std::thread device([&] {
+        while (running) {
+            mboard.alive();
+            calls++;
+        }
+    });
+
+    std::string last;
+    int scrapes = 0;
+    double scrape_us = 0;
+    auto end = Clock::now() + std::chrono::seconds(seconds);
+    while (Clock::now() < end) {
+        auto t0 = Clock::now();
+        last = scrape(path);
+        scrape_us += std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        scrapes++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    running = false;
+    device.join();
+    server.stop();
+
+    std::cout << last << "\n";
+    std::cout << calls.load() << " alive() calls, " << scrapes << " scrapes, mean scrape "
+              << scrape_us / scrapes << " us\n";
+    return 0;
+}
@@ -204,36 +204,31 @@ private slots:
         }
         
         if (!nfc_) {
-            logMsg("[NFC] Creating NFC reader on /dev/ttyACM2...");
-            nfc_ = std::make_unique<Nfc_reader>("127.0.0.1", 4543);
-            
-            nfc_->set_log_callback([this](const std::string& msg) {
-                std::lock_guard<std::mutex> lock(queue_mutex_);
-                log_queue_.push(QString::fromStdString(msg));
-            });
-            
-            nfc_->set_card_callback([this](const CardInfo& card) {
-                std::lock_guard<std::mutex> lock(queue_mutex_);
-                card_queue_.push(QString::fromStdString(card.uidHex));
-            });
+            logMsg("[NFC] Creating STX/ETX reader on 127.0.0.1:4543...");
+            nfc_ = std::make_unique<obu::CorvusIsoReader>("127.0.0.1", 4543);
         }
         
-        if (!nfc_->is_port_open()) {
-            logMsg(QString("[NFC] Port error: %1").arg(QString::fromStdString(nfc_->get_init_error())));
+        auto connected = nfc_->connect();
+        if (!connected.ok()) {
+            logMsg(QString("[NFC] Connect error: %1").arg(QString::fromStdString(nfc_->get_last_error())));
             return;
         }
         
-        logMsg("[NFC] Port open, initializing...");
-        nfc_->initialize();
-        
-        if (!nfc_->is_initialized()) {
-            logMsg("[NFC] Init failed");
+        logMsg("[NFC] Connected, logging on...");
+        if (!nfc_->logon().ok()) {
+            logMsg(QString("[NFC] Logon failed: %1").arg(QString::fromStdString(nfc_->get_last_error())));
             return;
         }
         
+        if (nfc_thread_.joinable()) {
+            nfc_thread_.join();     // previous loop ended on its own
+        }
         nfc_running_.store(true);
         nfc_thread_ = std::thread([this]() { 
-            nfc_->start(); 
+            nfc_->start_reading([this](const std::string& uid) {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                card_queue_.push(QString::fromStdString(uid));
+            });
             nfc_running_.store(false);
             nfc_stopped_flag_ = true;
         });
@@ -249,7 +244,7 @@ private slots:
     {
         if (!nfc_running_.load()) return;
         if (nfc_) {
-            nfc_->stop();
+            nfc_->stop_reading();
         }
         if (nfc_thread_.joinable()) {
             nfc_thread_.join();
@@ -274,7 +269,7 @@ private:
     Mboard mboard_;
     Terminal terminal_;
     QrScanner qr_;
-    std::unique_ptr<Nfc_reader> nfc_;
+    std::unique_ptr<obu::CorvusIsoReader> nfc_;
     
     std::thread nfc_thread_;
     std::atomic<bool> nfc_running_{false};
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "common/protocol.hpp"
+#include "devices/mboard.hpp"
+#include "devices/mboard_shadow.hpp"
+
+// An application watching doors (0x00..0x07), ignition (0x10..0x11) and I/O
+// lines (0x14..0x17) on a simulated Mboard whose door register flips every
+// 300 ms. Run once polling read_registers per range and diffing by hand,
+// once through MboardShadow: one coalesced refresh per period, reads served
+// from the copy, changes pushed to a subscriber.
+//
+//   register_shadow_demo [seconds] [period_ms] [board_latency_ms]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const obu::RegisterSpan WATCHED[] = {{0x00, 8}, {0x10, 2}, {0x14, 4}};
+
+struct MboardSim
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    int latency_ms;
+    Clock::time_point epoch = Clock::now();
+    std::atomic<long> transactions{0};
+
+    explicit MboardSim(int latency_ms) : latency_ms(latency_ms)
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+        thread = std::thread([this] { run(); });
+    }
+    ~MboardSim()
+    {
+        running = false;
+        thread.join();
+        ::close(master);
+    }
+
+    uint8_t value(size_t reg) const
+    {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count();
+        if (reg == 0x04) return (ms / 300) % 2 ? 0x01 : 0x00;     // rear door
+        return static_cast<uint8_t>(reg);
+    }
+
+    void run()
+    {
+        std::vector<uint8_t> rx;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[256];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+                auto request = EpdiFrame::decode(rx.data(), len);
+                rx.erase(rx.begin(), rx.begin() + len);
+                if (!request.ok() || request.value().size() < 6) continue;
+
+                auto& cmd = request.value();
+                std::vector<uint8_t> reply = {Protocol::Mboard::RESPONSE, cmd[1], cmd[2], cmd[3], 0x00};
+                for (size_t reg = cmd[4]; reg < 256u && reg < size_t(cmd[4]) + cmd[5]; reg++) {
+                    reply.push_back(value(reg));
+                }
+                transactions++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+                auto frame = EpdiFrame::encode(reply.data(), reply.size());
+                (void)::write(master, frame.data(), frame.size());
+            }
+        }
+    }
+};
+
+double pct(std::vector<double> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+void report(const char* label, MboardSim& sim, long before, double seconds, std::vector<double>& read_us, int changes)
+{
+    std::cout << std::fixed << std::setprecision(1) << label << std::setw(6)
+              << (sim.transactions - before) / seconds << " transactions/s | read p50 " << std::setw(7)
+              << pct(read_us, 0.5) << "  p99 " << std::setw(7) << pct(read_us, 0.99) << " us ("
+              << read_us.size() << ") | " << changes << " door changes seen\n";
+}
+
+void by_hand(MboardSim& sim, SerialPort& serial, double seconds, int period_ms)
+{
+    Mboard mboard(serial);
+    std::vector<std::vector<uint8_t>> last(3);
+    std::vector<double> read_us;
+    int changes = 0;
+    long before = sim.transactions;
+
+    auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    auto next = Clock::now();
+    while (Clock::now() < end) {
+        for (int i = 0; i < 3; i++) {
+            auto t0 = Clock::now();
+            auto r = mboard.read_registers(WATCHED[i].start, WATCHED[i].count);
+            read_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+            if (!r.ok()) continue;
+            if (i == 0 && !last[0].empty() && last[0][4] != r.value()[4]) changes++;
+            last[i] = r.value();
+        }
+        next += std::chrono::milliseconds(period_ms);
+        std::this_thread::sleep_until(next);
+    }
+    report("  read_registers per range ", sim, before, seconds, read_us, changes);
+}
+
+void shadowed(MboardSim& sim, SerialPort& serial, double seconds, int period_ms)
+{
+    Mboard mboard(serial);
+    obu::CommandScheduler bus;
+    bus.start();
+    obu::MboardShadow shadow(mboard, bus);
+    for (const auto& span : WATCHED) shadow.watch(span.start, span.count);
+
+    std::cout << "  shadow plan:";
+    for (const auto& span : shadow.plan()) {
+        std::cout << " 0x" << std::hex << int(span.start) << "+" << std::dec << int(span.count);
+    }
+    std::cout << "\n";
+
+    std::atomic<int> changes{0};
+    shadow.subscribe(0x04, 1, [&](const std::vector<obu::RegisterChange>& delta) { changes += delta.size(); });
+    shadow.read(0x00, 0x18);
+
+    std::vector<double> read_us;
+    long before = sim.transactions;
+    auto end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    auto next = Clock::now();
+    while (Clock::now() < end) {
+        shadow.refresh();
+        for (const auto& span : WATCHED) {
+            auto t0 = Clock::now();
+            shadow.read(span.start, span.count);
+            read_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        }
+        next += std::chrono::milliseconds(period_ms);
+        std::this_thread::sleep_until(next);
+    }
+    bus.stop();
+    report("  MboardShadow             ", sim, before, seconds, read_us, changes);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 3.0;
+    int period_ms = argc > 2 ? std::atoi(argv[2]) : 20;
+    int latency_ms = argc > 3 ? std::atoi(argv[3]) : 2;
+
+    MboardSim sim(latency_ms);
+    SerialPort serial;
+    if (!serial.open(sim.slave).ok()) {
+        std::cerr << "Failed to open " << sim.slave << "\n";
+        return 1;
+    }
+
+    std::cout << "3 ranges every " << period_ms << " ms, board answers in " << latency_ms << " ms\n";
+    by_hand(sim, serial, seconds, period_ms);
+    shadowed(sim, serial, seconds, period_ms);
+    return 0;
+}
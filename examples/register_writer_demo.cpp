@@ -0,0 +1,186 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <array>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "common/protocol.hpp"
+#include "common/command_scheduler.hpp"
+#include "devices/mboard.hpp"
+#include "devices/register_writer.hpp"
+
+// Lighting and destination-sign logic as it tends to be written: every
+// 50 ms it sets 16 lamp outputs (0x20..0x2F) one register at a time, pulses
+// the door chime (0x30 on, then off) and rewrites the sign's 8 registers
+// (0x40..0x47). Run once with a WRITE_REGISTERS per write, once through
+// RegisterWriter; prints frames per burst, how long a burst takes to land
+// and checks the board ends up with the same values.
+//
+//   register_writer_demo [bursts] [board_latency_ms]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct MboardSim
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    int latency_ms;
+    std::mutex mutex;
+    std::array<uint8_t, 256> registers{};
+    std::atomic<long> writes{0};
+
+    explicit MboardSim(int latency_ms) : latency_ms(latency_ms)
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+        thread = std::thread([this] { run(); });
+    }
+    ~MboardSim()
+    {
+        running = false;
+        thread.join();
+        ::close(master);
+    }
+
+    void run()
+    {
+        std::vector<uint8_t> rx;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[512];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+                auto request = EpdiFrame::decode(rx.data(), len);
+                rx.erase(rx.begin(), rx.begin() + len);
+                if (!request.ok() || request.value().size() < 6) continue;
+
+                auto& cmd = request.value();
+                if (cmd[1] == Protocol::Service::WRITE_REGISTERS) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (size_t i = 0; i < cmd[5] && 6 + i < cmd.size() && cmd[4] + i < 256; i++) {
+                        registers[cmd[4] + i] = cmd[6 + i];
+                    }
+                    writes++;
+                }
+                uint8_t reply[] = {Protocol::Mboard::RESPONSE, cmd[1], cmd[2], cmd[3], 0x00};
+                std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+                auto frame = EpdiFrame::encode(reply, sizeof(reply));
+                (void)::write(master, frame.data(), frame.size());
+            }
+        }
+    }
+
+    std::array<uint8_t, 256> snapshot()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return registers;
+    }
+};
+
+// One burst of output changes; `write` stages or sends a single write.
+template <typename Write>
+void burst(int n, Write write)
+{
+    for (int lamp = 0; lamp < 16; lamp++) {
+        write(0x20 + lamp, std::vector<uint8_t>{static_cast<uint8_t>((n + lamp) % 3 == 0)});
+    }
+    write(0x30, std::vector<uint8_t>{1});
+    write(0x30, std::vector<uint8_t>{0});
+    std::vector<uint8_t> sign(8);
+    for (int i = 0; i < 8; i++) sign[i] = static_cast<uint8_t>('A' + (n + i) % 26);
+    write(0x40, sign);
+}
+
+double pct(std::vector<double> v, double p)
+{
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p * v.size()))];
+}
+
+void report(const char* label, long frames, int bursts, std::vector<double>& burst_ms, int failed)
+{
+    std::cout << std::fixed << std::setprecision(1) << label << std::setw(5) << double(frames) / bursts
+              << " frames/burst | burst lands p50 " << std::setw(6) << pct(burst_ms, 0.5) << "  max "
+              << std::setw(6) << pct(burst_ms, 1.0) << " ms | " << failed << " failed\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int bursts = argc > 1 ? std::atoi(argv[1]) : 20;
+    int latency_ms = argc > 2 ? std::atoi(argv[2]) : 2;
+
+    MboardSim sim(latency_ms);
+    SerialPort serial;
+    if (!serial.open(sim.slave).ok()) {
+        std::cerr << "Failed to open " << sim.slave << "\n";
+        return 1;
+    }
+    Mboard mboard(serial);
+    obu::CommandScheduler bus;
+    bus.start();
+
+    std::cout << bursts << " bursts of 19 writes, board answers in " << latency_ms << " ms\n";
+
+    std::vector<double> direct_ms;
+    int direct_failed = 0;
+    long before = sim.writes;
+    for (int n = 0; n < bursts; n++) {
+        auto t0 = Clock::now();
+        burst(n, [&](uint8_t reg, const std::vector<uint8_t>& values) {
+            auto r = bus.call(obu::CommandClass::FEEDBACK, [&] { return mboard.write_registers(reg, values); });
+            if (!r.ok()) direct_failed++;
+        });
+        direct_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    report("  write_registers per write ", sim.writes - before, bursts, direct_ms, direct_failed);
+    auto direct_state = sim.snapshot();
+
+    obu::RegisterWriter writer(mboard, bus);
+    writer.start();
+    std::vector<double> batched_ms;
+    int batched_failed = 0;
+    before = sim.writes;
+    for (int n = 0; n < bursts; n++) {
+        auto t0 = Clock::now();
+        std::vector<std::future<Result<bool>>> done;
+        burst(n, [&](uint8_t reg, const std::vector<uint8_t>& values) { done.push_back(writer.write(reg, values)); });
+        for (auto& f : done) {
+            if (!f.get().ok()) batched_failed++;
+        }
+        batched_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    report("  RegisterWriter             ", sim.writes - before, bursts, batched_ms, batched_failed);
+
+    writer.stop();
+    bus.stop();
+    std::cout << "  final registers " << (sim.snapshot() == direct_state ? "match" : "DIFFER") << "\n";
+    return 0;
+}
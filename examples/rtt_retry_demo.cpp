@@ -0,0 +1,126 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "devices/mboard.hpp"
+#include "common/protocol.hpp"
+
+// Runs Mboard::alive() against a simulated board on a pty that answers after
+// a few milliseconds and silently drops every Nth reply. Prints the RTT
+// estimate, how many requests were resent and what the worst call cost.
+//
+//   rtt_retry_demo [calls] [drop_every] [board_latency_ms]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct BoardSim
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+    std::atomic<bool> running{true};
+    int drop_every;
+    int latency_ms;
+    int requests = 0;
+    int duplicates = 0;
+
+    BoardSim(int drop_every, int latency_ms) : drop_every(drop_every), latency_ms(latency_ms)
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+        thread = std::thread([this] { run(); });
+    }
+    ~BoardSim()
+    {
+        running = false;
+        thread.join();
+        ::close(master);
+    }
+
+    void run()
+    {
+        std::vector<uint8_t> rx;
+        int last_counter = -1;
+        while (running) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            uint8_t buf[256];
+            ssize_t n = ::read(master, buf, sizeof(buf));
+            if (n <= 0) continue;
+            rx.insert(rx.end(), buf, buf + n);
+
+            while (size_t len = EpdiFrame::complete_length(rx.data(), rx.size())) {
+                auto request = EpdiFrame::decode(rx.data(), len);
+                rx.erase(rx.begin(), rx.begin() + len);
+                if (!request.ok() || request.value().size() < 4) continue;
+
+                auto& cmd = request.value();
+                int counter = (cmd[2] << 8) | cmd[3];
+                if (counter == last_counter) duplicates++;
+                last_counter = counter;
+
+                if (drop_every > 0 && ++requests % drop_every == 0) continue;
+
+                std::vector<uint8_t> reply(17, 0);
+                reply[0] = Protocol::Mboard::RESPONSE;
+                reply[1] = cmd[1];
+                reply[2] = cmd[2];
+                reply[3] = cmd[3];
+                std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+                auto frame = EpdiFrame::encode(reply.data(), reply.size());
+                (void)::write(master, frame.data(), frame.size());
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int calls = argc > 1 ? std::atoi(argv[1]) : 200;
+    int drop_every = argc > 2 ? std::atoi(argv[2]) : 10;
+    int latency_ms = argc > 3 ? std::atoi(argv[3]) : 5;
+
+    BoardSim sim(drop_every, latency_ms);
+    SerialPort serial;
+    if (!serial.open(sim.slave).ok()) {
+        std::cerr << "Failed to open " << sim.slave << "\n";
+        return 1;
+    }
+    Mboard mboard(serial);
+
+    int failures = 0;
+    std::vector<double> ms;
+    for (int i = 0; i < calls; i++) {
+        auto t0 = Clock::now();
+        if (!mboard.alive().ok()) failures++;
+        ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    std::sort(ms.begin(), ms.end());
+
+    auto& rtt = mboard.rtt();
+    std::cout << calls << " calls, every " << drop_every << "th reply dropped, board latency "
+              << latency_ms << " ms\n";
+    std::cout << "  srtt " << rtt.srtt().count() / 1000.0 << " ms  rttvar " << rtt.rttvar().count() / 1000.0
+              << " ms  timeout " << rtt.timeout_ms() << " ms (initial " << Protocol::MBOARD_TIMEOUT_MS << ")\n";
+    std::cout << "  timeouts " << rtt.timeouts() << "  resent with same counter " << sim.duplicates
+              << "  failed calls " << failures << "\n";
+    std::cout << "  call latency median " << ms[ms.size() / 2] << " ms  max " << ms.back() << " ms\n";
+    return 0;
+}
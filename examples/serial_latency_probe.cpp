@@ -0,0 +1,94 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "transport/serial.hpp"
+
+// Byte-to-userspace latency of a serial link: time from handing one byte to
+// the driver until SerialPort returns it, once with the default profile and
+// once with low-latency mode. Needs TX looped back to RX on the port under
+// test; without a port argument a pty stands in (no UART, so only the tty
+// layer is measured).
+//
+//   serial_latency_probe [port] [baud] [samples]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+void probe(const char* label, const std::string& port, int master, SerialProfile profile, int samples)
+{
+    SerialPort serial;
+    if (!serial.open(port, profile).ok()) {
+        std::cerr << label << "cannot open " << port << "\n";
+        return;
+    }
+    serial.set_timeout_ms(200);
+
+    std::vector<double> us;
+    unsigned char byte = 0x55;
+    for (int i = 0; i < samples; i++) {
+        auto t0 = Clock::now();
+        if (master >= 0) {
+            (void)::write(master, &byte, 1);
+        } else {
+            serial.write(&byte, 1);
+        }
+        auto r = serial.read_frame([](const std::vector<unsigned char>& rx) { return !rx.empty(); });
+        auto t1 = Clock::now();
+        if (r.ok()) {
+            us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    }
+    serial.close();
+
+    if (us.empty()) {
+        std::cout << label << "no bytes came back (is TX looped to RX?)\n";
+        return;
+    }
+    std::sort(us.begin(), us.end());
+    auto pct = [&](double p) { return us[std::min(us.size() - 1, static_cast<size_t>(p * us.size()))]; };
+    std::cout << label << us.size() << "/" << samples << "  min " << us.front() << "  p50 " << pct(0.50)
+              << "  p99 " << pct(0.99) << "  max " << us.back() << " us"
+              << "  [low latency " << (serial.is_low_latency() ? "on" : "unsupported") << "]\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    std::string port;
+    int master = -1;
+    if (argc > 1) {
+        port = argv[1];
+    } else {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            return 1;
+        }
+        port = ptsname(master);
+    }
+    int baud = argc > 2 ? std::atoi(argv[2]) : 921600;
+    int samples = argc > 3 ? std::atoi(argv[3]) : 1000;
+
+    std::cout << port << " at " << baud << " baud, " << samples << " samples\n";
+
+    SerialProfile plain;
+    plain.baud = baud;
+    probe("default:     ", port, master, plain, samples);
+
+    SerialProfile fast = plain;
+    fast.low_latency = true;
+    fast.rx_trigger_bytes = 1;
+    probe("low latency: ", port, master, fast, samples);
+
+    if (master >= 0) {
+        ::close(master);
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "devices/mboard.hpp"
+#include "devices/terminal.hpp"
+#include "devices/qr_scanner.hpp"
+#include "validator/nfc_reader.hpp"
+#include "common/startup.hpp"
+#include "common/state_snapshot.hpp"
+
+// Brings up Mboard, terminal, QR scanner and validator NFC reader, once one
+// after another, once through StartupOrchestrator and once more as a warm
+// restart from the StateSnapshot the second pass left, and prints the
+// timelines. With --sim (the default when /dev/ttyS0 is missing) each device
+// is a pty answering its handshake after a fixed delay.
+
+namespace {
+
+struct SimDevice
+{
+    int master = -1;
+    std::string slave;
+    std::thread thread;
+};
+
+std::atomic<bool> sim_running{true};
+
+// Answers every request chunk with answer(chunk) after `delay_ms`.
+void simulate(SimDevice& dev, std::function<std::vector<uint8_t>(const std::vector<uint8_t>&)> answer, int delay_ms)
+{
+    dev.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (dev.master < 0 || grantpt(dev.master) < 0 || unlockpt(dev.master) < 0) {
+        std::cerr << "Failed to open pty\n";
+        std::exit(1);
+    }
+    dev.slave = ptsname(dev.master);
+    int fd = dev.master;
+    dev.thread = std::thread([fd, answer, delay_ms] {
+        uint8_t buf[256];
+        while (sim_running.load()) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) continue;
+            ssize_t n = ::read(fd, buf, sizeof(buf));
+            if (n <= 0) continue;
+            auto reply = answer(std::vector<uint8_t>(buf, buf + n));
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+            (void)::write(fd, reply.data(), reply.size());
+        }
+    });
+}
+
+void simulate(SimDevice& dev, std::vector<uint8_t> reply, int delay_ms)
+{
+    simulate(dev, [reply](const std::vector<uint8_t>&) { return reply; }, delay_ms);
+}
+
+std::vector<uint8_t> epdi(std::vector<uint8_t> payload)
+{
+    return EpdiFrame::encode(payload.data(), payload.size());
+}
+
+struct Ports
+{
+    std::string mboard = "/dev/ttyS0";
+    std::string terminal = "/dev/ttyUSB1";
+    std::string qr = "/dev/ttyACM0";
+    std::string validator = validator::NfcReader::DEFAULT_PORT;
+};
+
+// Adds one step per device; `chain` makes each wait for the previous one.
+// With a restored snapshot the steps resume instead of handshaking; either
+// way each successful step records its state for the next restart.
+void add_devices(obu::StartupOrchestrator& startup, const Ports& ports, bool chain,
+                 obu::StateSnapshot* snapshot, std::vector<std::shared_ptr<void>>& keep)
+{
+    auto mboard_serial = std::make_shared<SerialPort>();
+    auto term_serial = std::make_shared<SerialPort>();
+    auto qr_serial = std::make_shared<SerialPort>();
+    auto nfc = std::make_shared<validator::NfcReader>(ports.validator.c_str());
+    keep.insert(keep.end(), {mboard_serial, term_serial, qr_serial, nfc});
+
+    obu::DeviceState* state = snapshot ? &snapshot->state() : nullptr;
+    bool warm = snapshot && snapshot->restored();
+
+    startup.add("mboard", [=] {
+        auto opened = mboard_serial->open(ports.mboard);
+        if (!opened.ok()) return opened;
+        Mboard mboard(*mboard_serial);
+        if (warm && state->mboard_valid) {
+            mboard.set_counter(state->mboard_counter);
+        }
+        auto r = mboard.alive();
+        if (!r.ok()) return Result<bool>::failure(r.error());
+        if (state) {
+            state->mboard_valid = 1;
+            state->mboard_counter = mboard.counter();
+            state->mboard = {r.value().hw_version, r.value().sw_version, r.value().bootloader_version};
+        }
+        return Result<bool>::success(true);
+    });
+    // Terminals are powered through the Mboard.
+    startup.add("terminal", [=] {
+        auto opened = term_serial->open(ports.terminal);
+        if (!opened.ok()) return opened;
+        Terminal terminal(*term_serial);
+        auto r = terminal.alive();
+        if (!r.ok()) return Result<bool>::failure(r.error());
+        if (state) {
+            state->terminal_valid = 1;
+            state->terminal = {r.value().hw_version, r.value().sw_version, r.value().bootloader_version};
+        }
+        return Result<bool>::success(true);
+    }, {"mboard"});
+    startup.add("qr", [=] {
+        auto opened = qr_serial->open(ports.qr);
+        if (!opened.ok()) return opened;
+        QrScanner qr(*qr_serial);
+        if (warm && state->qr_valid && ports.qr == state->qr_port) {
+            qr.resume();
+            return Result<bool>::success(true);
+        }
+        auto r = qr.initialize();
+        if (r.ok() && state) {
+            state->qr_valid = 1;
+            std::snprintf(state->qr_port, sizeof(state->qr_port), "%s", ports.qr.c_str());
+        }
+        return r;
+    }, chain ? std::vector<std::string>{"terminal"} : std::vector<std::string>{}, false);
+    startup.add("validator", [=] {
+        Result<bool> r = Result<bool>::failure(Error::NFC_INIT);
+        if (warm && state->validator_valid && ports.validator == state->validator_port) {
+            validator::NfcReader::Session session;
+            session.counter = state->validator_counter;
+            session.key.assign(state->validator_key, state->validator_key + state->validator_key_len);
+            r = nfc->resume(session);
+        } else {
+            r = nfc->initialize();
+        }
+        if (r.ok() && state) {
+            auto session = nfc->session();
+            size_t len = std::min(session.key.size(), obu::DeviceState::MAX_KEY);
+            state->validator_valid = 1;
+            std::snprintf(state->validator_port, sizeof(state->validator_port), "%s", ports.validator.c_str());
+            state->validator_counter = session.counter;
+            state->validator_key_len = static_cast<uint8_t>(len);
+            std::copy(session.key.begin(), session.key.begin() + len, state->validator_key);
+        }
+        return r;
+    }, chain ? std::vector<std::string>{"qr"} : std::vector<std::string>{});
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    bool sim = (argc > 1 && std::string(argv[1]) == "--sim") || access("/dev/ttyS0", F_OK) != 0;
+
+    Ports ports;
+    SimDevice mboard, terminal, qr, nfc;
+    if (sim) {
+        // The board echoes service and counter; Mboard ignores replies that do not.
+        simulate(mboard, [](const std::vector<uint8_t>& request) {
+            std::vector<uint8_t> reply = {0x72, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x02, 0x00,
+                                          0x01, 0x00, 0x00, 0x00, 0x00, 0x2A};
+            auto cmd = EpdiFrame::decode(request.data(), request.size());
+            if (cmd.ok() && cmd.value().size() >= 4) {
+                std::copy(cmd.value().begin() + 1, cmd.value().begin() + 4, reply.begin() + 1);
+            }
+            return epdi(reply);
+        }, 25);
+        simulate(terminal, epdi({0x30, 0x00, 0x00, 0x01, 0x01, 0x00, 0x02, 0x00, 0x01, 0x00}), 15);
+        simulate(qr, {0x06}, 10);
+        // AUTH_A hands out a key, AUTH_B acknowledges it.
+        simulate(nfc, [](const std::vector<uint8_t>& request) {
+            if (request.size() > 1 && request[1] == validator::NfcReader::CMD_AUTH_B) {
+                return epdi({0x72, validator::NfcReader::CMD_AUTH_B, 0x00, 0x00, 0x00});
+            }
+            return epdi({0x72, 0x02, 0x00, 0x00, 0x11, 0x22, 0x33, 0x44});
+        }, 30);
+        ports.mboard = mboard.slave;
+        ports.terminal = terminal.slave;
+        ports.qr = qr.slave;
+        ports.validator = nfc.slave;
+        std::cout << "simulated devices on ptys\n";
+    }
+
+    std::string state_path = std::string("/tmp/obu-startup-demo-") + std::to_string(getpid());
+    std::vector<std::shared_ptr<void>> keep;
+    const char* passes[] = {"one after another", "orchestrated", "warm restart"};
+    for (int pass = 0; pass < 3; pass++) {
+        // A fresh snapshot object per pass, as a restarted process would have.
+        obu::StateSnapshot snapshot(state_path);
+        snapshot.open();
+
+        obu::StartupOrchestrator startup;
+        add_devices(startup, ports, pass == 0, pass == 0 ? nullptr : &snapshot, keep);
+        auto result = startup.run();
+        if (result.ok() && pass > 0) {
+            snapshot.commit();
+        }
+        std::cout << "\n" << passes[pass] << (snapshot.restored() ? " (state restored)" : "") << ": "
+                  << (result.ok() ? "ready" : "NOT ready") << "\n";
+        startup.print(std::cout);
+        keep.clear();
+    }
+    ::unlink(state_path.c_str());
+
+    sim_running = false;
+    for (auto* dev : {&mboard, &terminal, &qr, &nfc}) {
+        if (dev->thread.joinable()) dev->thread.join();
+        if (dev->master >= 0) ::close(dev->master);
+    }
+    return 0;
+}
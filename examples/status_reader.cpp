@@ -0,0 +1,132 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "common/status_segment.hpp"
+
+// Out-of-process view of the device status segment.
+//
+//   status_reader [name]            print the current status once
+//   status_reader --watch [name]    print on every publish
+//   status_reader --bench [reads]   fork a publisher hammering the segment
+//                                   and check every read for tearing
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+void print(const obu::DeviceStatus& s)
+{
+    std::cout << "mboard   ";
+    if (s.mboard_updated_ns) {
+        std::cout << "status 0x" << std::hex << s.mboard.status << std::dec << " sw " << s.mboard.sw_version
+                  << " uptime " << s.mboard.uptime_seconds << " s\n";
+    } else {
+        std::cout << "-\n";
+    }
+    for (size_t i = 0; i < obu::DeviceStatus::TERMINALS; i++) {
+        if (!s.terminal_updated_ns[i]) continue;
+        std::cout << "terminal " << i << " status 0x" << std::hex << s.terminal[i].status << std::dec
+                  << " sw " << s.terminal[i].sw_version << "\n";
+    }
+    std::cout << "uid      " << (s.uid_count ? s.uid : "-") << " (" << s.uid_count << " reads)\n";
+    std::cout << "qr       " << (s.qr_count ? s.qr_code : "-") << " (" << s.qr_count << " scans)\n";
+}
+
+int bench(long reads)
+{
+    const char* name = "/obu-status-bench";
+    obu::StatusPublisher publisher(name);
+    if (!publisher.open().ok()) {
+        std::cerr << "Failed to create " << name << "\n";
+        return 1;
+    }
+
+    // The child publishes uid == qr_code == str(n) and uid_count == qr_count == n,
+    // so any mix of two publishes in one read shows up as a mismatch. Three
+    // publishes every 20 us is orders of magnitude above any real device.
+    pid_t child = fork();
+    if (child == 0) {
+        for (uint64_t n = 1;; n++) {
+            std::string v = std::to_string(n);
+            AliveResponse alive = {static_cast<uint16_t>(n), 1, 2, 3, static_cast<uint32_t>(n)};
+            publisher.publish_mboard(alive);
+            publisher.publish_uid(obu::StatusSource::VALIDATOR, v);
+            publisher.publish_qr(v);
+            auto until = Clock::now() + std::chrono::microseconds(20);
+            while (Clock::now() < until) {}
+        }
+    }
+    publisher.close();
+
+    obu::StatusReader reader(name);
+    if (!reader.open().ok()) {
+        std::cerr << "Failed to open " << name << "\n";
+        return 1;
+    }
+
+    long torn = 0, failed = 0, changed = 0;
+    uint64_t last = 0;
+    auto t0 = Clock::now();
+    for (long i = 0; i < reads; i++) {
+        auto r = reader.read();
+        if (!r.ok()) { failed++; continue; }
+        const auto& s = r.value();
+        if (s.qr_count != last) changed++;
+        last = s.qr_count;
+        bool consistent = s.uid_count == s.qr_count || s.uid_count == s.qr_count + 1;
+        if (s.qr_count && (std::strtoull(s.qr_code, nullptr, 10) != s.qr_count || !consistent))
+            torn++;
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / reads;
+
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    reader.close();
+    publisher.unlink();
+
+    std::cout << reads << " reads against a busy publisher: " << ns << " ns/read, "
+              << changed << " distinct snapshots, " << torn << " torn, " << failed << " failed\n";
+    return torn || failed ? 1 : 0;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    bool watch = false;
+    int arg = 1;
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        return bench(argc > 2 ? std::atol(argv[2]) : 2000000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--watch") == 0) {
+        watch = true;
+        arg++;
+    }
+
+    obu::StatusReader reader(argc > arg ? argv[arg] : obu::StatusPublisher::DEFAULT_NAME);
+    if (!reader.open().ok()) {
+        std::cerr << "No status segment (is the SDK process running?)\n";
+        return 1;
+    }
+
+    uint32_t seen = 0;
+    do {
+        uint32_t seq = reader.sequence();
+        if (seq != seen) {
+            seen = seq;
+            auto status = reader.read();
+            if (status.ok()) {
+                std::cout << "--- publisher pid " << reader.publisher_pid() << ", sequence " << seq << "\n";
+                print(status.value());
+            }
+        }
+        if (watch) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    } while (watch);
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "transport/serial.hpp"
+#include "transport/epdi.hpp"
+#include "devices/qr_scanner.hpp"
+#include "devices/corvus_nfc_reader.hpp"
+#include "validator/nfc_reader.hpp"
+#include "common/cancellation.hpp"
+
+// Time from stop() (or cancelling a shared CancellationToken) until the
+// blocked worker thread has returned, for each blocking SDK loop. Devices are
+// ptys that go quiet after the handshake and a TCP listener that accepts and
+// stays silent.
+//
+//   stop_latency [rounds]
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int SETTLE_MS = 50;
+
+struct Pty
+{
+    int master = -1;
+    std::string slave;
+    std::thread responder;
+
+    Pty()
+    {
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+            std::cerr << "Failed to open pty\n";
+            std::exit(1);
+        }
+        slave = ptsname(master);
+    }
+    ~Pty()
+    {
+        if (responder.joinable()) responder.join();
+        ::close(master);
+    }
+
+    // Answers the first request with one EPDI frame, then goes quiet.
+    void answer_once()
+    {
+        responder = std::thread([this] {
+            uint8_t buf[64];
+            struct pollfd pfd = {master, POLLIN, 0};
+            if (poll(&pfd, 1, 1000) > 0 && ::read(master, buf, sizeof(buf)) > 0) {
+                uint8_t payload[] = {0x72, 0x03, 0x00, 0x00};
+                auto frame = EpdiFrame::encode(payload, sizeof(payload));
+                (void)::write(master, frame.data(), frame.size());
+            }
+        });
+    }
+};
+
+// Accepts connections and never answers, so every Corvus wait runs to its timeout.
+struct SilentServer
+{
+    int listen_fd = -1;
+    int port = 0;
+    std::vector<int> clients;
+    std::thread thread;
+
+    SilentServer()
+    {
+        listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(listen_fd, 8);
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        thread = std::thread([this] {
+            int fd;
+            while ((fd = accept(listen_fd, nullptr, nullptr)) >= 0) clients.push_back(fd);
+        });
+    }
+    ~SilentServer()
+    {
+        shutdown(listen_fd, SHUT_RDWR);
+        ::close(listen_fd);
+        thread.join();
+        for (int fd : clients) ::close(fd);
+    }
+};
+
+// Starts `body` on a thread, lets it block, fires `stop` and returns how long the thread took to exit.
+double measure(const std::function<void()>& body, const std::function<void()>& stop)
+{
+    std::thread worker(body);
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+    auto t0 = Clock::now();
+    stop();
+    worker.join();
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+void report(const char* label, std::vector<double> us)
+{
+    std::sort(us.begin(), us.end());
+    std::cout << label << "min " << us.front() << "  median " << us[us.size() / 2]
+              << "  max " << us.back() << " us\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20;
+    std::vector<double> qr_us, nfc_us, corvus_us, shared_us;
+
+    SilentServer server;
+
+    for (int i = 0; i < rounds; i++) {
+        {
+            Pty pty;
+            SerialPort serial;
+            serial.open(pty.slave);
+            QrScanner qr(serial);
+            qr.resume();
+            qr_us.push_back(measure([&] { qr.start_continuous(); }, [&] { qr.stop(); }));
+        }
+        {
+            Pty pty;
+            pty.answer_once();
+            validator::NfcReader nfc(pty.slave.c_str());
+            nfc.resume(validator::NfcReader::Session{0, {0x00}});
+            nfc_us.push_back(measure([&] { nfc.start_reading(); }, [&] { nfc.stop(); }));
+        }
+        {
+            obu::CorvusNfcReader corvus("127.0.0.1", server.port);
+            corvus_us.push_back(measure([&] { corvus.start_reading(nullptr); }, [&] { corvus.stop_reading(); }));
+        }
+        {
+            // One application-wide token stops a QR loop, a validator loop and a Corvus loop together.
+            obu::CancellationToken shutdown;
+            Pty qr_pty, nfc_pty;
+            nfc_pty.answer_once();
+            SerialPort qr_serial;
+            qr_serial.open(qr_pty.slave);
+            qr_serial.set_cancel_token(&shutdown);
+            QrScanner qr(qr_serial);
+            qr.resume();
+            validator::NfcReader nfc(nfc_pty.slave.c_str());
+            nfc.set_cancel_token(&shutdown);
+            nfc.resume(validator::NfcReader::Session{0, {0x00}});
+            obu::CorvusNfcReader corvus("127.0.0.1", server.port);
+            corvus.set_cancel_token(&shutdown);
+
+            shared_us.push_back(measure([&] {
+                std::thread a([&] { qr.start_continuous(); });
+                std::thread b([&] { nfc.start_reading(); });
+                corvus.start_reading(nullptr);
+                a.join();
+                b.join();
+            }, [&] { shutdown.cancel(); }));
+        }
+    }
+
+    std::cout << rounds << " rounds, stop() to worker exit:\n";
+    report("  QrScanner::stop             ", qr_us);
+    report("  NfcReader::stop             ", nfc_us);
+    report("  CorvusNfcReader::stop       ", corvus_us);
+    report("  shared token, three loops   ", shared_us);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "transport/serial.hpp"
+#include "devices/qr_scanner.hpp"
+#include "common/device_thread.hpp"
+
+// Tap-to-callback latency of a QrScanner worker fed through a pty while every
+// CPU is busy with background work, once as a plain thread and once launched
+// with SCHED_FIFO, CPU pinning, mlockall and a prefaulted stack. Latency
+// includes SerialPort::FRAME_GAP_MS, so compare the spread, not the floor.
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+void run(const char* label, const obu::ThreadOptions& options, int taps, int load_threads)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+        std::cerr << "Failed to open pty\n";
+        return;
+    }
+    SerialPort serial;
+    if (!serial.open(ptsname(master)).ok()) {
+        std::cerr << "Failed to open pty slave\n";
+        ::close(master);
+        return;
+    }
+
+    std::vector<Clock::time_point> sent(taps), received(taps);
+    std::atomic<int> delivered{0};
+
+    QrScanner qr(serial);
+    qr.set_scan_callback([&](const std::string& code) {
+        int i = std::atoi(code.c_str() + 3);
+        if (i >= 0 && i < taps) {
+            received[i] = Clock::now();
+            delivered++;
+        }
+    });
+
+    std::atomic<bool> loaded{true};
+    std::vector<std::thread> load;
+    for (int i = 0; i < load_threads; i++) {
+        load.emplace_back([&] {
+            std::vector<uint64_t> scratch(1 << 18);
+            uint64_t x = 1;
+            while (loaded.load(std::memory_order_relaxed)) {
+                for (auto& v : scratch) v = x = x * 6364136223846793005ULL + 1;
+            }
+        });
+    }
+
+    obu::DeviceThread worker;
+    worker.start(options, [&] { qr.start_continuous(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    char buf[32];
+    for (int i = 0; i < taps; i++) {
+        int n = std::snprintf(buf, sizeof(buf), "TAP%04d\r\n", i);
+        sent[i] = Clock::now();
+        (void)::write(master, buf, n);
+        std::this_thread::sleep_for(std::chrono::milliseconds(SerialPort::FRAME_GAP_MS + 50));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(SerialPort::FRAME_GAP_MS * 3));
+
+    qr.stop();
+    worker.join();
+    loaded = false;
+    for (auto& t : load) t.join();
+    ::close(master);
+
+    std::vector<double> ms;
+    for (int i = 0; i < taps; i++) {
+        if (received[i] > sent[i]) {
+            ms.push_back(std::chrono::duration<double, std::milli>(received[i] - sent[i]).count());
+        }
+    }
+    if (ms.empty()) {
+        std::cout << label << "no taps delivered\n";
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    auto pct = [&](double p) { return ms[std::min(ms.size() - 1, static_cast<size_t>(p * ms.size()))]; };
+
+    const auto& st = worker.status();
+    std::cout << label << delivered.load() << "/" << taps << " taps  min " << ms.front()
+              << "  p50 " << pct(0.50) << "  p99 " << pct(0.99) << "  max " << ms.back()
+              << "  spread " << ms.back() - ms.front() << " ms"
+              << "  [fifo " << st.realtime << " pinned " << st.pinned
+              << " mlock " << st.memory_locked << " stack " << st.stack_prefaulted << "]\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int taps = argc > 1 ? std::atoi(argv[1]) : 40;
+    int load_threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency()) * 2;
+
+    std::cout << taps << " taps, " << load_threads << " background load threads\n";
+
+    obu::ThreadOptions plain;
+    plain.name = "qr-plain";
+    run("default thread: ", plain, taps, load_threads);
+
+    obu::ThreadOptions rt;
+    rt.name = "qr-rt";
+    rt.rt_priority = 50;
+    rt.cpu = 0;
+    rt.lock_memory = true;
+    rt.prefault_stack = 256 * 1024;
+    run("rt worker:      ", rt, taps, load_threads);
+    return 0;
+}
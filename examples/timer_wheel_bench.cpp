@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <poll.h>
+#include "common/timer_wheel.hpp"
+
+// Runs a mix of periodic device tasks (Corvus keepalives, Mboard ALIVE polls,
+// GPS sampling, terminal health checks) on one TimerWheel driven by poll() on
+// its fd, then prints how many times the thread woke up and the per-task
+// lateness. Also times insert + cancel of short-lived timers such as QR
+// duplicate windows.
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct TaskClass
+{
+    const char* name;
+    int period_ms;
+    int count;
+    std::vector<obu::TimerWheel::TimerId> ids;
+};
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+    int scale = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    obu::TimerWheel wheel;
+    std::vector<TaskClass> classes = {
+        {"keepalive 200ms", 200, 4 * scale, {}},
+        {"mboard alive 1s", 1000, scale, {}},
+        {"gps 1s", 1000, scale, {}},
+        {"health 5s", 5000, 2 * scale, {}},
+    };
+
+    uint64_t work = 0;
+    for (auto& c : classes) {
+        for (int i = 0; i < c.count; i++) {
+            c.ids.push_back(wheel.schedule_every(std::chrono::milliseconds(c.period_ms), [&work] { work++; }));
+        }
+    }
+
+    uint64_t wakeups = 0;
+    auto end = Clock::now() + std::chrono::seconds(seconds);
+    while (Clock::now() < end) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(end - Clock::now()).count();
+        struct pollfd pfd = {wheel.fd(), POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(left) + 1) > 0) {
+            wakeups++;
+            wheel.dispatch();
+        }
+    }
+
+    std::cout << wheel.size() << " timers, " << seconds << " s: " << wakeups << " wakeups, "
+              << work << " callbacks\n";
+    for (const auto& c : classes) {
+        uint64_t fires = 0, skipped = 0;
+        Clock::duration total{0}, worst{0};
+        for (auto id : c.ids) {
+            const auto* st = wheel.stats(id);
+            if (!st) continue;
+            fires += st->fires;
+            skipped += st->skipped;
+            total += st->total_lateness;
+            worst = std::max(worst, st->max_lateness);
+        }
+        double mean_us = fires ? std::chrono::duration<double, std::micro>(total).count() / fires : 0.0;
+        std::cout << "  " << c.name << " x" << c.count << ": " << fires << " fires, lateness mean "
+                  << mean_us << " us, max " << std::chrono::duration<double, std::micro>(worst).count()
+                  << " us, skipped " << skipped << "\n";
+    }
+
+    const int churn = 1000000;
+    std::vector<obu::TimerWheel::TimerId> ids(churn);
+    auto t0 = Clock::now();
+    for (int i = 0; i < churn; i++) {
+        ids[i] = wheel.schedule(std::chrono::milliseconds(100 + i % 5000), [] {});
+    }
+    auto t1 = Clock::now();
+    for (int i = 0; i < churn; i++) {
+        wheel.cancel(ids[i]);
+    }
+    auto t2 = Clock::now();
+    std::cout << "insert " << std::chrono::duration<double, std::nano>(t1 - t0).count() / churn
+              << " ns, cancel " << std::chrono::duration<double, std::nano>(t2 - t1).count() / churn
+              << " ns per timer\n";
+    return 0;
+}
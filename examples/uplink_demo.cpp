@@ -0,0 +1,72 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "uplink/journal.hpp"
+#include "uplink/uploader.hpp"
+#include "uplink/standin_server.hpp"
+
+// Journals synthetic validation events, uploads them to a local stand-in
+// server, drops the link halfway and reports radio efficiency and resume time.
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 5000;
+
+    std::remove("uplink_demo.journal");
+    std::remove("uplink_demo.cursor");
+
+    obu::StandInServer server;
+    if (!server.start().ok()) {
+        std::cerr << "Failed to start stand-in server\n";
+        return 1;
+    }
+
+    obu::EventJournal journal("uplink_demo.journal");
+    if (!journal.open().ok()) {
+        std::cerr << "Failed to open journal\n";
+        return 1;
+    }
+
+    obu::UplinkConfig config;
+    config.port = server.port();
+    config.cursor_path = "uplink_demo.cursor";
+    obu::Uploader uploader(journal, config);
+
+    auto journal_events = [&](int from, int to) {
+        char buf[128];
+        for (int i = from; i < to; i++) {
+            int n = std::snprintf(buf, sizeof(buf),
+                "{\"t\":%d,\"type\":\"tap\",\"uid\":\"04A1%06X\",\"route\":12,\"stop\":%d}",
+                1700000000 + i, i * 7919 & 0xFFFFFF, i % 40);
+            journal.append(reinterpret_cast<const uint8_t*>(buf), n);
+        }
+    };
+
+    journal_events(0, count / 2);
+    auto first = uploader.flush();
+    std::cout << "First half acked: " << (first.ok() ? first.value() : 0) << " events\n";
+
+    server.drop_connection();
+    journal_events(count / 2, count);
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto second = uploader.flush();
+    if (!second.ok()) {
+        // Link loss is seen on the first send; the next flush reconnects.
+        second = uploader.flush();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    auto stats = uploader.stats();
+    double kb = stats.wire_bytes / 1024.0;
+    std::cout << "Server received: " << server.events_received() << "/" << count << " events\n";
+    std::cout << "Raw event bytes: " << stats.raw_bytes << ", on the wire: " << stats.wire_bytes
+              << " (" << (stats.raw_bytes ? 100.0 * stats.wire_bytes / stats.raw_bytes : 0.0) << "%)\n";
+    std::cout << "Events per KB:   " << (kb > 0 ? stats.events_acked / kb : 0.0) << "\n";
+    std::cout << "Resume + upload: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us\n";
+    std::cout << "Cursor:          " << uploader.cursor() << " / " << journal.end_offset() << "\n";
+
+    server.stop();
+    return server.events_received() == static_cast<uint64_t>(count) ? 0 : 1;
+}
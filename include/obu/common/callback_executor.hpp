@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/device_thread.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace obu {
+
+// What post() does when the queue is full.
+enum class OverflowPolicy : uint8_t
+{
+    DROP_OLDEST,    // discard the oldest queued task; the device thread never waits
+    BLOCK,          // wait for space; only for consumers that must see every task
+    COALESCE,       // park the task in a single overflow slot, replacing any task
+                    // parked there, so the most recent one always runs
+};
+
+// Runs device callbacks off the thread that reads the port. post() is a
+// lock-free push into a bounded ring (multi-producer, multi-consumer), so a
+// slow callback delays only other callbacks, never the next serial read.
+// Idle workers sleep on a condition variable that posters touch only when
+// someone is actually asleep.
+class CallbackExecutor
+{
+public:
+    using Task = std::function<void()>;
+
+    struct Options
+    {
+        size_t capacity = 256;          // rounded up to a power of two
+        OverflowPolicy overflow = OverflowPolicy::DROP_OLDEST;
+        int threads = 1;                // >1 runs callbacks concurrently, out of order
+        ThreadOptions thread;
+    };
+
+    CallbackExecutor();
+    explicit CallbackExecutor(Options options);
+    ~CallbackExecutor();
+
+    CallbackExecutor(const CallbackExecutor&) = delete;
+    CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+    Result<bool> start();
+    // Runs what is already queued, then joins the workers. Tasks posted
+    // afterwards, and posters blocked under BLOCK, are dropped.
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    // False if the task was dropped instead of queued.
+    bool post(Task task);
+
+    size_t depth() const;
+    uint64_t dropped() const { return dropped_overflow_.load() + dropped_coalesced_.load() + dropped_stopped_.load(); }
+    // Time from post() to the task starting.
+    const LatencyHistogram& run_delay() const { return run_delay_; }
+
+    // Queue depth, run delay, runs and drops by reason, labelled executor=<name>.
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        Task task;
+        Clock::time_point posted;
+    };
+
+    struct Parked
+    {
+        Task task;
+        Clock::time_point posted;
+    };
+
+    Options options_;
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    std::atomic<Parked*> parked_{nullptr};
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> accepting_{false};
+    std::vector<std::unique_ptr<DeviceThread>> workers_;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::atomic<int> idle_workers_{0};
+    std::atomic<int> blocked_posters_{0};
+
+    LatencyHistogram run_delay_;
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> blocked_{0};
+    std::atomic<uint64_t> dropped_overflow_{0};
+    std::atomic<uint64_t> dropped_coalesced_{0};
+    std::atomic<uint64_t> dropped_stopped_{0};
+
+    bool try_push(Task& task, Clock::time_point posted);
+    bool try_pop(Task& task, Clock::time_point& posted);
+    bool take(Task& task, Clock::time_point& posted);
+    void wake_worker();
+    void run();
+};
+
+} // namespace obu
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+
+namespace obu {
+
+// Level-triggered stop signal backed by an eventfd. Blocking SDK waits put
+// fd() in their poll set next to the device fd, so cancel() wakes them at
+// once instead of at the next timeout, and every wait sharing the token sees
+// it until reset(). cancel() is safe from any thread and from signal handlers.
+class CancellationToken
+{
+public:
+    CancellationToken();
+    ~CancellationToken();
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel();
+    // Re-arms the token for the next run. Only call when no wait depends on
+    // the pending cancel, e.g. at the start of a read loop.
+    void reset();
+    bool is_cancelled() const { return cancelled_.load(std::memory_order_acquire); }
+
+    // Readable (POLLIN) while cancelled. Waiters poll it but never read it.
+    int fd() const { return fd_; }
+
+private:
+    int fd_{-1};
+    std::atomic<bool> cancelled_{false};
+};
+
+} // namespace obu
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/device_thread.hpp"
+#include <array>
+#include <deque>
+#include <future>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+namespace obu {
+
+// Priority classes on a shared bus, highest first.
+enum class CommandClass : uint8_t
+{
+    FEEDBACK,       // passenger-facing: beep, display
+    VALIDATION,     // on the path of a card or ticket check
+    TELEMETRY,      // background polls: alive, GPS, registers
+};
+
+constexpr size_t COMMAND_CLASSES = 3;
+
+const char* command_class_name(CommandClass cls);
+
+// Serializes every command on one serial bus through a single thread, so
+// callers on any thread can no longer interleave their reads, and orders
+// them by class instead of arrival:
+//
+//   - the highest non-empty class runs next, FIFO within a class;
+//   - a job that has waited max_wait for its class runs ahead of higher
+//     classes (aging), so telemetry is delayed, never starved;
+//   - the queue is bounded bus-wide; when full, a new job preempts the
+//     newest queued job of a lower class, otherwise it is rejected;
+//   - a keyed job replaces a queued job of the same class and key, so a
+//     slow bus coalesces repeated polls instead of backing up.
+//
+// A job already on the wire always completes; preemption only applies to
+// queued jobs. Dropped jobs get their drop callback with CMD_FAILURE.
+class CommandScheduler
+{
+public:
+    using Job = std::function<void()>;
+    using Drop = std::function<void(Error)>;
+
+    struct Options
+    {
+        size_t capacity = 64;
+        // Aging threshold per class; zero = never promoted.
+        std::array<std::chrono::milliseconds, COMMAND_CLASSES> max_wait = {
+            std::chrono::milliseconds(0), std::chrono::milliseconds(250), std::chrono::milliseconds(1000)};
+    };
+
+    CommandScheduler();
+    explicit CommandScheduler(Options options);
+    ~CommandScheduler();
+
+    CommandScheduler(const CommandScheduler&) = delete;
+    CommandScheduler& operator=(const CommandScheduler&) = delete;
+
+    Result<bool> start(const ThreadOptions& thread = {});
+    // Drops everything still queued.
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    // Queues run on the bus thread. False if rejected; drop is then called
+    // right away. key 0 = never coalesced.
+    bool submit(CommandClass cls, Job run, Drop drop = nullptr, uint64_t key = 0);
+
+    // Runs fn on the bus thread and waits for its Result; CMD_FAILURE if the
+    // job was rejected or dropped. Must not be called from the bus thread.
+    template <typename Fn>
+    auto call(CommandClass cls, Fn fn, uint64_t key = 0) -> decltype(fn())
+    {
+        using R = decltype(fn());
+        auto promise = std::make_shared<std::promise<R>>();
+        auto future = promise->get_future();
+        submit(cls, [promise, fn]() mutable { promise->set_value(fn()); },
+               [promise](Error error) { promise->set_value(R::failure(error)); }, key);
+        return future.get();
+    }
+
+    size_t depth(CommandClass cls) const { return stats_[index(cls)].depth.load(std::memory_order_relaxed); }
+    const LatencyHistogram& queue_delay(CommandClass cls) const { return stats_[index(cls)].queue_delay; }
+
+    // Per-class queueing delay, depth and drop counters, labelled bus=<name>.
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        Job run;
+        Drop drop;
+        uint64_t key;
+        Clock::time_point enqueued;
+    };
+
+    struct ClassStats
+    {
+        LatencyHistogram queue_delay;
+        std::atomic<size_t> depth{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> preempted{0};
+        std::atomic<uint64_t> superseded{0};
+        std::atomic<uint64_t> aged{0};
+    };
+
+    Options options_;
+    std::atomic<bool> running_{false};
+    DeviceThread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::array<std::deque<Entry>, COMMAND_CLASSES> queues_;
+    size_t queued_ = 0;
+    std::array<ClassStats, COMMAND_CLASSES> stats_;
+
+    static size_t index(CommandClass cls) { return static_cast<size_t>(cls); }
+    void run();
+    // Caller holds mutex_; queues_ non-empty.
+    size_t pick(Clock::time_point now);
+};
+
+} // namespace obu
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common/types.hpp"
+#include <pthread.h>
+#include <string>
+#include <functional>
+#include <cstddef>
+
+namespace obu {
+
+// How a device I/O worker should be scheduled. Everything is opt-in; the
+// defaults give an ordinary thread.
+struct ThreadOptions
+{
+    std::string name;               // shown in top/ps, truncated to 15 chars
+    int rt_priority = 0;            // >0: SCHED_FIFO at this priority (1..99)
+    int cpu = -1;                   // pin to this CPU, -1 = any
+    bool lock_memory = false;       // mlockall(MCL_CURRENT | MCL_FUTURE), process-wide
+    size_t stack_size = 0;          // 0 = default
+    size_t prefault_stack = 0;      // bytes of stack to touch before running
+};
+
+// What the kernel actually granted. SCHED_FIFO and mlockall need
+// CAP_SYS_NICE / CAP_IPC_LOCK or matching rlimits; without them the worker
+// still runs, just without that setting.
+struct ThreadStatus
+{
+    bool realtime = false;
+    bool pinned = false;
+    bool memory_locked = false;
+    bool stack_prefaulted = false;
+};
+
+// Launches a device worker (e.g. NfcReader::start_reading,
+// QrScanner::start_continuous) with the requested scheduling applied before
+// the worker body runs.
+class DeviceThread
+{
+public:
+    DeviceThread() = default;
+    ~DeviceThread();
+
+    DeviceThread(const DeviceThread&) = delete;
+    DeviceThread& operator=(const DeviceThread&) = delete;
+
+    // Returns once the thread is running and status() is filled in.
+    Result<bool> start(const ThreadOptions& options, std::function<void()> body);
+    void join();
+    bool joinable() const { return started_; }
+
+    const ThreadStatus& status() const { return status_; }
+
+private:
+    pthread_t thread_{};
+    bool started_ = false;
+    ThreadOptions options_;
+    ThreadStatus status_;
+    std::function<void()> body_;
+
+    static void* entry(void* arg);
+    void apply();
+};
+
+} // namespace obu
@@ -1,28 +1,54 @@
 #pragma once
 #include <cstdint>
-#include <bit>      
-#include <cstring>  
+#include <cstddef>
+#include <type_traits>
 
+namespace obu {
 
-constexpr uint16_t to_big_endian_16(uint16_t val) {
-    if constexpr (std::endian::native == std::endian::big) {
-        return val;
-    } else {
-        return std::byteswap(val);
+// Big-endian load/store of an integer. The trip count is sizeof(T), so the
+// compiler unrolls it into a plain load plus byte swap, with no branches.
+template <typename T>
+constexpr T load_be(const uint8_t* p)
+{
+    static_assert(std::is_integral<T>::value, "load_be needs an integer type");
+    using U = typename std::make_unsigned<T>::type;
+    U v = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+        v = static_cast<U>((v << 8) | p[i]);
     }
+    return static_cast<T>(v);
+}
+
+template <typename T>
+constexpr void store_be(uint8_t* p, T value)
+{
+    static_assert(std::is_integral<T>::value, "store_be needs an integer type");
+    using U = typename std::make_unsigned<T>::type;
+    U v = static_cast<U>(value);
+    for (size_t i = sizeof(T); i-- > 0;) {
+        p[i] = static_cast<uint8_t>(v);
+        v = static_cast<U>(v >> 8);
+    }
+}
+
+} // namespace obu
+
+constexpr uint16_t to_big_endian_16(uint16_t val) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return val;
+#else
+    return static_cast<uint16_t>((val >> 8) | (val << 8));
+#endif
 }
 
 constexpr uint16_t from_big_endian_16(uint16_t val) {
     return to_big_endian_16(val);
 }
 
-void write_be16(uint8_t* buf, uint16_t val) {
-    uint16_t be_val = to_big_endian_16(val);
-    std::memcpy(buf, &be_val, sizeof(be_val));
+inline void write_be16(uint8_t* buf, uint16_t val) {
+    obu::store_be<uint16_t>(buf, val);
 }
 
-uint16_t read_be16(const uint8_t* buf) {
-    uint16_t temp;
-    std::memcpy(&temp, buf, sizeof(temp));
-    return from_big_endian_16(temp);
-}
\ No newline at end of file
+inline uint16_t read_be16(const uint8_t* buf) {
+    return obu::load_be<uint16_t>(buf);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "common/types.hpp"
+
+// Byte-oriented LZ77 block codec (LZ4 block layout) used to shrink uplink
+// batches before they go over the mobile link. No external dependency.
+class LzCodec
+{
+public:
+    // Appends the compressed form of data to out.
+    static void compress(const uint8_t* data, size_t len, std::vector<uint8_t>& out);
+
+    // Decodes a block that expands to exactly raw_len bytes.
+    static Result<std::vector<uint8_t>> decompress(const uint8_t* data, size_t len, size_t raw_len);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "common/schema.hpp"
+#include "common/response.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Wire layouts of the device messages, each declared once. Device parsers
+// and the daemon protocol decode and encode through these.
+namespace obu {
+
+// Bytes in front of the message body in a device reply.
+constexpr size_t MBOARD_REPLY_HEADER = 5;      // [0x72][service][counter:2][ack]
+constexpr size_t TERMINAL_REPLY_HEADER = 2;    // [addr][service]
+
+using AliveSchema = schema::Message<AliveResponse,
+    schema::Be<&AliveResponse::status>,
+    schema::Be<&AliveResponse::hw_version>,
+    schema::Be<&AliveResponse::sw_version>,
+    schema::Be<&AliveResponse::bootloader_version>,
+    schema::Be<&AliveResponse::uptime_seconds>>;
+static_assert(AliveSchema::size == 12, "Mboard ALIVE body is 12 bytes");
+
+using TerminalAliveSchema = schema::Message<TerminalAliveResponse,
+    schema::Be<&TerminalAliveResponse::status>,
+    schema::Be<&TerminalAliveResponse::hw_version>,
+    schema::Be<&TerminalAliveResponse::sw_version>,
+    schema::Be<&TerminalAliveResponse::bootloader_version>>;
+static_assert(TerminalAliveSchema::size == 8, "Terminal ALIVE body is 8 bytes");
+
+// A block of Mboard registers: the READ_REGISTERS request, and the header
+// of WRITE_REGISTERS in front of the values.
+struct RegisterSpan
+{
+    uint8_t start = 0;
+    uint8_t count = 0;
+};
+
+using RegisterSpanSchema = schema::Message<RegisterSpan,
+    schema::Be<&RegisterSpan::start>,
+    schema::Be<&RegisterSpan::count>>;
+
+// Validator READ_CARD reply: EPDI header, ATQA, then the two anticollision
+// cascade levels of a 7-byte UID, each closed by its BCC, then SAK.
+struct CardReply
+{
+    uint8_t dest = 0;
+    uint8_t service = 0;
+    uint8_t counter = 0;
+    uint8_t source = 0;
+    uint8_t ack = 0;
+    uint16_t atqa = 0;
+    uint8_t ct = 0;
+    std::array<uint8_t, 3> uid_cl1{};
+    uint8_t bcc1 = 0;
+    std::array<uint8_t, 4> uid_cl2{};
+    uint8_t bcc2 = 0;
+    uint8_t sak = 0;
+};
+
+using CardReplySchema = schema::Message<CardReply,
+    schema::Be<&CardReply::dest>,
+    schema::Be<&CardReply::service>,
+    schema::Be<&CardReply::counter>,
+    schema::Be<&CardReply::source>,
+    schema::Be<&CardReply::ack>,
+    schema::Be<&CardReply::atqa>,
+    schema::Be<&CardReply::ct>,
+    schema::Bytes<&CardReply::uid_cl1>,
+    schema::Be<&CardReply::bcc1>,
+    schema::Bytes<&CardReply::uid_cl2>,
+    schema::Be<&CardReply::bcc2>,
+    schema::Be<&CardReply::sak>>;
+static_assert(CardReplySchema::size == 18, "READ_CARD reply is 18 bytes before the extra data");
+
+} // namespace obu
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace obu {
+
+// Fixed-bucket latency histogram. observe() is a handful of relaxed atomic
+// adds, so device threads record into it directly and a scrape reads it
+// without coordinating with them.
+class LatencyHistogram
+{
+public:
+    // Upper bucket bounds in microseconds; one more bucket catches the rest.
+    static constexpr std::array<int64_t, 13> BOUNDS_US = {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+
+    void observe(std::chrono::microseconds elapsed);
+
+    uint64_t bucket(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+    uint64_t sum_us() const { return sum_us_.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<uint64_t>, BOUNDS_US.size() + 1> buckets_{};
+    std::atomic<uint64_t> sum_us_{0};
+};
+
+// One histogram per command byte, created on first use with a CAS, so a new
+// command never takes a lock on the request path.
+class CommandLatency
+{
+public:
+    CommandLatency() = default;
+    ~CommandLatency();
+
+    CommandLatency(const CommandLatency&) = delete;
+    CommandLatency& operator=(const CommandLatency&) = delete;
+
+    void observe(uint8_t command, std::chrono::microseconds elapsed);
+    // nullptr until the command has been seen.
+    const LatencyHistogram* get(uint8_t command) const { return slots_[command].load(std::memory_order_acquire); }
+
+private:
+    std::array<std::atomic<LatencyHistogram*>, 256> slots_{};
+};
+
+// Prometheus text exposition of values owned elsewhere. Each series is a
+// reader over an existing atomic, evaluated only when render() runs, so
+// registering costs the device nothing per operation. Registration and
+// render() share a mutex; the sources themselves are never locked.
+// Registered sources must outlive the registry.
+class MetricsRegistry
+{
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+    using Reader = std::function<double()>;
+
+    void counter(const std::string& name, const std::string& help, Labels labels, Reader read);
+    void gauge(const std::string& name, const std::string& help, Labels labels, Reader read);
+    void histogram(const std::string& name, const std::string& help, Labels labels, const LatencyHistogram& histogram);
+    // Series for every command seen so far, labelled command="0xNN".
+    void histogram(const std::string& name, const std::string& help, Labels labels, const CommandLatency& commands);
+
+    std::string render() const;
+
+private:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Series
+    {
+        Labels labels;
+        Reader read;
+        const LatencyHistogram* histogram = nullptr;
+        const CommandLatency* commands = nullptr;
+    };
+
+    struct Family
+    {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<Series> series;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Family> families_;
+
+    Family& family(const std::string& name, const std::string& help, Type type);
+};
+
+} // namespace obu
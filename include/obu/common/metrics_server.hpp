@@ -0,0 +1,49 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/cancellation.hpp"
+#include <string>
+#include <atomic>
+#include <thread>
+
+namespace obu {
+
+// Serves MetricsRegistry::render() on a Unix domain socket. An HTTP GET gets
+// an HTTP/1.0 reply, so `curl --unix-socket PATH http://obu/metrics` and
+// Prometheus behind a socket proxy both work; any other client just gets the
+// text and EOF. One connection at a time on its own thread.
+class MetricsServer
+{
+public:
+    static constexpr const char* DEFAULT_PATH = "/run/obu/metrics.sock";
+
+    explicit MetricsServer(const MetricsRegistry& registry, std::string path = DEFAULT_PATH);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    Result<bool> start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    const std::string& path() const { return path_; }
+    uint64_t scrapes() const { return scrapes_.load(); }
+
+private:
+    static constexpr int REQUEST_TIMEOUT_MS = 200;
+
+    const MetricsRegistry& registry_;
+    std::string path_;
+    int listen_fd_{-1};
+    CancellationToken cancel_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> scrapes_{0};
+
+    void run();
+    void serve(int fd);
+};
+
+} // namespace obu
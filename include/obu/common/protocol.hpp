@@ -8,6 +8,9 @@ namespace Protocol
     constexpr int TERMINAL_TIMEOUT_MS = 120;
     constexpr int EPP_TIMEOUT_MS = 150;
     constexpr int QR_FRAME_TIMEOUT_MS = 200;
+    // Bounds for RTT-derived response timeouts; the constants above are the initial values.
+    constexpr int MIN_RESPONSE_TIMEOUT_MS = 10;
+    constexpr int MAX_RESPONSE_TIMEOUT_MS = 1000;
     
     // EPDI framing bytes
     constexpr uint8_t DLE = 0x10;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace obu {
+
+// Round-trip estimator for one request/response device, after RFC 6298:
+// SRTT and RTTVAR are smoothed from measured exchanges and the response
+// timeout is SRTT + 4 * RTTVAR, clamped to [min, max]. A timeout doubles the
+// current value until the next valid sample. Exchanges that needed a
+// retransmission are not sampled (Karn), since the reply may answer either send.
+class RttEstimator
+{
+public:
+    RttEstimator(int initial_timeout_ms, int min_timeout_ms, int max_timeout_ms);
+
+    void sample(std::chrono::microseconds rtt);
+    void backoff();
+
+    int timeout_ms() const { return timeout_ms_; }
+    // Zero until the first sample.
+    std::chrono::microseconds srtt() const { return srtt_; }
+    std::chrono::microseconds rttvar() const { return rttvar_; }
+    uint64_t samples() const { return samples_; }
+    uint64_t timeouts() const { return timeouts_; }
+
+private:
+    int min_timeout_ms_;
+    int max_timeout_ms_;
+    int timeout_ms_;
+    std::chrono::microseconds srtt_{0};
+    std::chrono::microseconds rttvar_{0};
+    uint64_t samples_{0};
+    uint64_t timeouts_{0};
+};
+
+// Bounded retransmission for EPDI request/response devices: a request is
+// sent at most 1 + retries times, each wait using the estimator's timeout.
+struct RetryPolicy
+{
+    int retries = 2;
+};
+
+} // namespace obu
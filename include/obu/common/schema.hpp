@@ -0,0 +1,161 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/endian.hpp"
+#include <array>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace obu {
+namespace schema {
+
+// A fixed-layout wire message declared once as a list of fields:
+//
+//   using AliveSchema = Message<AliveResponse,
+//       Be<&AliveResponse::status>, Be<&AliveResponse::hw_version>, ...>;
+//
+// Offsets and the total size are computed at compile time; decode checks
+// the length once, then every field is a load at a constant offset. Fields
+// only touch their member, so a struct may be filled by several schemas
+// (e.g. a fixed prefix followed by a variable tail handled by hand).
+
+template <typename T>
+struct member_traits;
+
+template <typename S, typename T>
+struct member_traits<T S::*>
+{
+    using Struct = S;
+    using Type = T;
+};
+
+// Big-endian integer, sizeof the member.
+template <auto Member>
+struct Be
+{
+    using Struct = typename member_traits<decltype(Member)>::Struct;
+    using Type = typename member_traits<decltype(Member)>::Type;
+    static_assert(std::is_integral<Type>::value, "Be<> needs an integer member");
+
+    static constexpr size_t size = sizeof(Type);
+
+    static constexpr void decode(const uint8_t* p, Struct& s) { s.*Member = load_be<Type>(p); }
+    static constexpr void encode(uint8_t* p, const Struct& s) { store_be<Type>(p, s.*Member); }
+};
+
+// Raw bytes into a std::array<uint8_t, N> member.
+template <auto Member>
+struct Bytes
+{
+    using Struct = typename member_traits<decltype(Member)>::Struct;
+    using Type = typename member_traits<decltype(Member)>::Type;
+
+    static constexpr size_t size = std::tuple_size<Type>::value;
+
+    static constexpr void decode(const uint8_t* p, Struct& s)
+    {
+        for (size_t i = 0; i < size; i++) (s.*Member)[i] = p[i];
+    }
+    static constexpr void encode(uint8_t* p, const Struct& s)
+    {
+        for (size_t i = 0; i < size; i++) p[i] = (s.*Member)[i];
+    }
+};
+
+// N bytes not mapped to a member; encoded as zero.
+template <size_t N>
+struct Skip
+{
+    static constexpr size_t size = N;
+
+    template <typename S>
+    static constexpr void decode(const uint8_t*, S&) {}
+    template <typename S>
+    static constexpr void encode(uint8_t* p, const S&)
+    {
+        for (size_t i = 0; i < N; i++) p[i] = 0;
+    }
+};
+
+template <typename S, typename... Fields>
+class Message
+{
+public:
+    using Struct = S;
+
+    static constexpr size_t size = (Fields::size + ... + 0);
+    static constexpr std::array<size_t, sizeof...(Fields)> offsets = [] {
+        std::array<size_t, sizeof...(Fields)> out{};
+        size_t sizes[] = {Fields::size..., 0};
+        size_t offset = 0;
+        for (size_t i = 0; i < sizeof...(Fields); i++) {
+            out[i] = offset;
+            offset += sizes[i];
+        }
+        return out;
+    }();
+
+    // INVALID_RESPONSE if len < size; bytes past the message are ignored.
+    static Result<S> decode(const uint8_t* data, size_t len)
+    {
+        if (len < size) {
+            return Result<S>::failure(Error::INVALID_RESPONSE);
+        }
+        S s{};
+        decode_into(data, s);
+        return Result<S>::success(std::move(s));
+    }
+
+    // The message starts `offset` bytes in, e.g. after a device reply header.
+    static Result<S> decode(const std::vector<uint8_t>& bytes, size_t offset = 0)
+    {
+        if (bytes.size() < offset) {
+            return Result<S>::failure(Error::INVALID_RESPONSE);
+        }
+        return decode(bytes.data() + offset, bytes.size() - offset);
+    }
+
+    // No length check: the caller guarantees size bytes.
+    static constexpr void decode_into(const uint8_t* data, S& s)
+    {
+        decode_fields(data, s, std::index_sequence_for<Fields...>());
+    }
+
+    static constexpr void encode_into(const S& s, uint8_t* out)
+    {
+        encode_fields(s, out, std::index_sequence_for<Fields...>());
+    }
+
+    static void append(std::vector<uint8_t>& out, const S& s)
+    {
+        size_t at = out.size();
+        out.resize(at + size);
+        encode_into(s, out.data() + at);
+    }
+
+    static std::vector<uint8_t> encode(const S& s)
+    {
+        std::vector<uint8_t> out(size);
+        encode_into(s, out.data());
+        return out;
+    }
+
+private:
+    template <size_t... I>
+    static constexpr void decode_fields(const uint8_t* data, S& s, std::index_sequence<I...>)
+    {
+        (Fields::decode(data + offsets[I], s), ...);
+    }
+
+    template <size_t... I>
+    static constexpr void encode_fields(const S& s, uint8_t* out, std::index_sequence<I...>)
+    {
+        (Fields::encode(out + offsets[I], s), ...);
+    }
+};
+
+} // namespace schema
+} // namespace obu
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "common/types.hpp"
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <ostream>
+
+namespace obu {
+
+// Brings devices up concurrently. Each step (open port + handshake) runs on
+// its own thread as soon as the steps it names in `after` have succeeded, so
+// independent devices overlap instead of queueing behind each other, and a
+// step whose dependency failed is skipped rather than left to time out.
+class StartupOrchestrator
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Step = std::function<Result<bool>()>;
+
+    enum class Outcome {
+        PENDING,
+        OK,
+        FAILED,
+        SKIPPED         // a dependency failed, is unknown or is part of a cycle
+    };
+
+    struct Entry
+    {
+        std::string name;
+        std::vector<std::string> after;
+        bool required = true;
+        Outcome outcome = Outcome::PENDING;
+        Error error = Error::DEVICE_ERROR;      // valid when FAILED
+        Clock::duration started{0};             // offsets from the start of run()
+        Clock::duration finished{0};
+    };
+
+    // Optional steps (required = false) may fail without failing run().
+    void add(std::string name, Step step, std::vector<std::string> after = {}, bool required = true);
+
+    // Returns once every step has finished or been skipped; fails if a
+    // required step did not succeed.
+    Result<bool> run();
+
+    const std::vector<Entry>& timeline() const { return entries_; }
+    // From the start of run() until the last required step succeeded.
+    Clock::duration ready_after() const { return ready_after_; }
+    // CLOCK_BOOTTIME when the last required step succeeded, i.e. time since the kernel booted.
+    std::chrono::milliseconds ready_since_boot() const { return ready_since_boot_; }
+
+    // One line per step with a bar showing when it ran.
+    void print(std::ostream& out) const;
+
+private:
+    std::vector<Entry> entries_;
+    std::vector<Step> steps_;
+    Clock::duration ready_after_{0};
+    std::chrono::milliseconds ready_since_boot_{0};
+};
+
+} // namespace obu
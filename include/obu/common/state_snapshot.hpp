@@ -0,0 +1,80 @@
+#pragma once
+
+#include "common/types.hpp"
+#include <string>
+#include <cstdint>
+
+namespace obu {
+
+struct DeviceVersions
+{
+    uint16_t hw_version;
+    uint16_t sw_version;
+    uint16_t bootloader_version;
+};
+
+// Everything a restarted process needs to skip device handshakes. Plain
+// data: it is copied byte for byte into the mapped file.
+struct DeviceState
+{
+    static constexpr size_t PORT_LEN = 64;
+    static constexpr size_t MAX_KEY = 64;
+
+    uint8_t validator_valid;
+    char validator_port[PORT_LEN];
+    uint8_t validator_counter;
+    uint8_t validator_key_len;
+    uint8_t validator_key[MAX_KEY];
+
+    uint8_t mboard_valid;
+    uint16_t mboard_counter;
+    DeviceVersions mboard;
+
+    uint8_t terminal_valid;
+    DeviceVersions terminal;
+
+    uint8_t qr_valid;
+    char qr_port[PORT_LEN];
+};
+
+// Memory-mapped device state that survives a process restart but not a
+// reboot (the kernel boot id is part of the snapshot). The file holds two
+// CRC-protected copies; commit() overwrites the older one, so a crash in the
+// middle of a commit still leaves the previous state loadable.
+class StateSnapshot
+{
+public:
+    static constexpr const char* DEFAULT_PATH = "/dev/shm/obu-state";
+
+    explicit StateSnapshot(std::string path = DEFAULT_PATH);
+    ~StateSnapshot();
+
+    StateSnapshot(const StateSnapshot&) = delete;
+    StateSnapshot& operator=(const StateSnapshot&) = delete;
+
+    // Maps the file and loads the newest valid copy from this boot. A missing,
+    // corrupt or stale file is not an error; the state just starts empty.
+    Result<bool> open();
+    void close();
+
+    // True if open() found usable state from before the restart.
+    bool restored() const { return restored_; }
+
+    DeviceState& state() { return state_; }
+    const DeviceState& state() const { return state_; }
+
+    Result<bool> commit();
+
+private:
+    struct Slot;
+
+    std::string path_;
+    int fd_{-1};
+    Slot* slots_{nullptr};
+    uint64_t sequence_{0};
+    bool restored_{false};
+    char boot_id_[40] = {};
+    DeviceState state_{};
+};
+
+} // namespace obu
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/response.hpp"
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+namespace obu {
+
+enum class StatusSource : uint8_t
+{
+    NONE = 0,
+    VALIDATOR = 1,
+    CORVUS = 2
+};
+
+// Latest device status as seen by the process that owns the devices. Fixed
+// layout shared with other processes: only explicit-width fields, no
+// pointers, every 8-byte field on an 8-byte offset. Timestamps are
+// CLOCK_MONOTONIC nanoseconds (comparable across processes), 0 = never.
+// The *_count fields grow with every publish, so a reader notices a second
+// tap of the same card.
+struct DeviceStatus
+{
+    static constexpr size_t TERMINALS = 4;      // TerminalAddress 0x30..0x33
+    static constexpr size_t UID_LEN = 32;       // hex UID, NUL terminated
+    static constexpr size_t CODE_LEN = 512;     // QR payload, NUL terminated
+
+    uint64_t mboard_updated_ns;
+    uint64_t terminal_updated_ns[TERMINALS];
+    uint64_t uid_updated_ns;
+    uint64_t uid_count;
+    uint64_t qr_updated_ns;
+    uint64_t qr_count;
+
+    AliveResponse mboard;
+    TerminalAliveResponse terminal[TERMINALS];
+
+    StatusSource uid_source;
+    uint8_t uid_len;
+    uint16_t qr_len;
+    char uid[UID_LEN];
+    char qr_code[CODE_LEN];
+};
+
+// Shared memory layout (header + DeviceStatus), defined in status_segment.cpp.
+struct StatusSegment;
+
+// Writer side of the status segment, a POSIX shared memory object guarded by
+// a seqlock. Publishing never blocks on readers: the sequence goes odd, the
+// block is copied in and the sequence goes even again. One publisher per
+// segment; its methods are safe to call from any device thread.
+class StatusPublisher
+{
+public:
+    static constexpr const char* DEFAULT_NAME = "/obu-status";
+
+    explicit StatusPublisher(std::string name = DEFAULT_NAME);
+    ~StatusPublisher();
+
+    StatusPublisher(const StatusPublisher&) = delete;
+    StatusPublisher& operator=(const StatusPublisher&) = delete;
+
+    // Creates or takes over the segment and clears the status.
+    Result<bool> open();
+    // Unmaps; the segment stays for readers until unlink().
+    void close();
+    void unlink();
+    bool is_open() const { return segment_ != nullptr; }
+
+    void publish_mboard(const AliveResponse& alive);
+    void publish_terminal(TerminalAddress addr, const TerminalAliveResponse& alive);
+    void publish_uid(StatusSource source, const std::string& uid);
+    void publish_qr(const std::string& code);
+
+private:
+    std::string name_;
+    StatusSegment* segment_{nullptr};
+    std::mutex mutex_;
+    DeviceStatus shadow_{};     // last published status, guarded by mutex_
+
+    void publish();
+};
+
+// Reader side: maps the segment read-only. read() costs two loads of the
+// sequence and a copy of the block, with no syscall and no lock; it retries
+// while a publish is in progress, yielding the CPU after a short spin in case
+// the publisher was preempted mid-write.
+class StatusReader
+{
+public:
+    explicit StatusReader(std::string name = StatusPublisher::DEFAULT_NAME);
+    ~StatusReader();
+
+    StatusReader(const StatusReader&) = delete;
+    StatusReader& operator=(const StatusReader&) = delete;
+
+    // Fails if the segment does not exist or has another layout version.
+    Result<bool> open();
+    void close();
+    bool is_open() const { return segment_ != nullptr; }
+
+    // Consistent snapshot. TIMEOUT if the publisher stays mid-write, which
+    // only happens when it died during a publish.
+    Result<DeviceStatus> read() const;
+    // Even value that changes with every publish; cheap to poll for changes.
+    uint32_t sequence() const;
+    // Process that owns the devices, for liveness checks.
+    int32_t publisher_pid() const;
+
+private:
+    static constexpr int SPIN_ATTEMPTS = 64;
+    static constexpr int MAX_READ_ATTEMPTS = 10000;
+
+    std::string name_;
+    const StatusSegment* segment_{nullptr};
+};
+
+} // namespace obu
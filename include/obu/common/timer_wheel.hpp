@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace obu {
+
+// Hierarchical timer wheel (4 levels x 64 slots) for periodic device tasks:
+// keepalives, ALIVE polls, GPS sampling, health checks. Insert and cancel are
+// O(1). The wheel owns one timerfd armed for its earliest expiry, so any
+// number of timers costs a single fd in the owner's poll set and no wakeups
+// between expiries. Timers fire up to one tick after their due time.
+//
+// Not thread-safe: schedule, cancel and dispatch belong to the thread that
+// polls fd(). Callbacks run inside dispatch() and may schedule or cancel
+// timers, including their own.
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    struct Stats
+    {
+        uint64_t fires = 0;
+        uint64_t skipped = 0;           // periods dropped because the timer ran too late
+        Clock::duration total_lateness{0};
+        Clock::duration max_lateness{0};
+    };
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1));
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    // Fires every `period`, scheduled from the previous due time rather than
+    // from when the callback ran, so lateness does not accumulate.
+    TimerId schedule_every(std::chrono::milliseconds period, Callback callback);
+    bool cancel(TimerId id);
+    bool active(TimerId id) const;
+    size_t size() const { return active_count_; }
+
+    // Poll this for POLLIN and call dispatch() when it is readable.
+    int fd() const { return timer_fd_; }
+    // Fires everything that is due and re-arms the timerfd. Returns the number fired.
+    size_t dispatch();
+    // Time until the earliest expiry for callers that wait with a poll timeout; -1 if idle.
+    int next_timeout_ms() const;
+
+    // Lateness of a live timer; nullptr once it is cancelled or has fired for good.
+    const Stats* stats(TimerId id) const;
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t MAX_DELTA = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    struct Node
+    {
+        Callback callback;
+        Clock::time_point due;
+        Clock::duration period{0};
+        uint64_t expires = 0;           // in ticks since origin_
+        uint32_t generation = 0;
+        int32_t prev = -1;
+        int32_t next = -1;
+        int8_t level = -1;              // -1: not linked
+        uint8_t slot = 0;
+        bool active = false;
+        Stats stats;
+    };
+
+    Clock::time_point origin_;
+    Clock::duration tick_;
+    uint64_t now_tick_ = 0;
+    uint64_t armed_tick_ = UINT64_MAX;
+    int timer_fd_ = -1;
+    size_t active_count_ = 0;
+
+    std::vector<Node> nodes_;
+    std::vector<int32_t> free_;
+    int32_t heads_[LEVELS][SLOTS];
+    uint64_t occupied_[LEVELS] = {};
+
+    TimerId add(Clock::time_point due, Clock::duration period, Callback callback);
+    int32_t lookup(TimerId id) const;
+    void release(int32_t idx);
+
+    uint64_t to_tick(Clock::time_point t) const;
+    void place(int32_t idx);
+    void unlink(int32_t idx);
+    void cascade(int level, uint64_t slot);
+    void fire(int32_t idx, Clock::time_point now);
+    uint64_t next_event_tick() const;
+    void rearm();
+};
+
+} // namespace obu
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/cancellation.hpp"
+#include "daemon/protocol.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+namespace obu {
+
+// Connection to obu-daemon. Requests are pipelined: request() returns at once
+// and any number may be in flight, each completed by the reply carrying its
+// id. Events for topics with a listener arrive on the reader thread, which
+// also runs the listener callbacks, so callbacks must not block on call().
+class DaemonClient
+{
+public:
+    using Reply = Result<std::vector<uint8_t>>;
+    using EventCallback = std::function<void(const std::vector<uint8_t>& payload)>;
+
+    static constexpr const char* DEFAULT_PATH = "/run/obu/obu.sock";
+    static constexpr int DEFAULT_TIMEOUT_MS = 2000;
+
+    explicit DaemonClient(std::string socket_path = DEFAULT_PATH);
+    ~DaemonClient();
+
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+
+    Result<bool> connect();
+    void disconnect();
+    bool is_connected() const { return connected_.load(); }
+
+    // Fails with PORT_ERROR once the connection drops.
+    std::future<Reply> request(uint8_t type, std::vector<uint8_t> body = {});
+    // request() and wait; TIMEOUT if no reply within timeout_ms.
+    Reply call(uint8_t type, std::vector<uint8_t> body = {}, int timeout_ms = DEFAULT_TIMEOUT_MS);
+
+    // Subscribes to topic for as long as any listener on it remains.
+    int add_listener(uint8_t topic, EventCallback callback);
+    void remove_listener(int handle);
+
+    // Cancelled while disconnected; blocking facades poll it next to their own stop token.
+    const CancellationToken& closed() const { return closed_; }
+
+private:
+    struct Listener
+    {
+        uint8_t topic;
+        EventCallback callback;
+    };
+
+    std::string path_;
+    int fd_{-1};
+    std::atomic<bool> connected_{false};
+    CancellationToken shutdown_;
+    CancellationToken closed_;
+    std::thread reader_;
+
+    std::mutex write_mutex_;
+    std::mutex pending_mutex_;
+    std::map<uint32_t, std::promise<Reply>> pending_;
+    uint32_t next_id_ = 1;
+
+    std::mutex listener_mutex_;
+    std::map<int, Listener> listeners_;
+    int next_listener_ = 1;
+    uint32_t topics_ = 0;
+
+    std::future<Reply> submit(uint8_t type, const std::vector<uint8_t>& body, uint32_t& id);
+    bool send_frame(const std::vector<uint8_t>& frame);
+    void update_subscription(bool force = false);
+    void run();
+    void dispatch(const daemon::Frame& frame);
+    void fail_pending();
+};
+
+} // namespace obu
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/cancellation.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
+#include "common/command_scheduler.hpp"
+#include "devices/mboard_shadow.hpp"
+#include "devices/register_writer.hpp"
+#include "daemon/protocol.hpp"
+#include "devices/corvus_reader_manager.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+class SerialPort;
+class Mboard;
+class Terminal;
+class QrScanner;
+namespace validator { class NfcReader; }
+
+namespace obu {
+
+struct DaemonConfig
+{
+    std::string socket_path = "/run/obu/obu.sock";
+
+    // Empty port / no endpoints = device not fitted.
+    std::string mboard_port;
+    std::string terminal_port;
+    std::string qr_port;
+    std::string validator_port;
+    std::vector<CorvusReaderManager::Endpoint> corvus;
+
+    int gps_interval_ms = 1000;             // 0 = no GPS polling
+    // Mboard registers kept in the shadow and published on TOPIC_REGISTERS
+    // when they change; none = every READ_REGISTERS goes to the board.
+    std::vector<RegisterSpan> watch_registers;
+    int register_interval_ms = 100;
+    int register_write_window_ms = 5;       // writes arriving within this go out together
+    int reader_retry_ms = 2000;             // restart a failed continuous reader after this
+    size_t max_clients = 32;
+    size_t max_client_backlog = 256 * 1024; // unsent bytes before a slow client is dropped
+
+    // Non-empty: also publish device status to this shared memory segment.
+    std::string status_segment;
+};
+
+// Single owner of every device port. Mboard and Terminal commands go through
+// a CommandScheduler per bus, so a BEEP overtakes queued polls; QR,
+// validator and Corvus readers run continuously and their results are fanned
+// out as events, so any number of clients can use the devices at once.
+// Client I/O runs on one poll loop thread and never waits on a device.
+class Daemon
+{
+public:
+    explicit Daemon(DaemonConfig config);
+    ~Daemon();
+
+    Daemon(const Daemon&) = delete;
+    Daemon& operator=(const Daemon&) = delete;
+
+    Result<bool> start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    size_t client_count() const { return client_count_.load(); }
+    void register_metrics(MetricsRegistry& registry) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Client
+    {
+        int fd = -1;
+        uint32_t topics = 0;
+        daemon::FrameReader rx;
+        std::vector<uint8_t> tx;
+        size_t tx_sent = 0;
+    };
+
+    // A QR_SCAN / CARD_READ waiting for the next matching event.
+    struct Waiter
+    {
+        uint64_t client = 0;
+        uint32_t id = 0;
+        uint8_t topic = 0;
+        uint8_t source = 0;
+        Clock::time_point deadline;
+    };
+
+    struct Posted
+    {
+        uint64_t client = 0;            // reply target, 0 for an event
+        uint8_t topic = 0;
+        uint8_t source = 0;
+        std::vector<uint8_t> bytes;     // encoded reply frame, or event payload
+    };
+
+    DaemonConfig config_;
+    std::atomic<bool> running_{false};
+    CancellationToken shutdown_;
+    int listen_fd_{-1};
+    int wake_fd_{-1};
+    std::thread loop_;
+
+    std::unique_ptr<SerialPort> mboard_serial_;
+    std::unique_ptr<SerialPort> terminal_serial_;
+    std::unique_ptr<SerialPort> qr_serial_;
+    std::unique_ptr<Mboard> mboard_;
+    std::unique_ptr<MboardShadow> shadow_;
+    std::unique_ptr<RegisterWriter> writer_;
+    std::unique_ptr<Terminal> terminal_;
+    std::unique_ptr<QrScanner> qr_;
+    std::unique_ptr<validator::NfcReader> validator_;
+    std::unique_ptr<CorvusReaderManager> corvus_;
+    std::unique_ptr<StatusPublisher> status_;
+    CommandScheduler mboard_bus_;
+    CommandScheduler terminal_bus_;
+    std::thread qr_thread_;
+    std::thread validator_thread_;
+
+    // Device threads -> loop
+    std::mutex posted_mutex_;
+    std::deque<Posted> posted_;
+
+    // Loop thread only
+    std::map<uint64_t, Client> clients_;
+    uint64_t next_client_ = 1;
+    std::vector<Waiter> waiters_;
+    Clock::time_point next_gps_;
+    Clock::time_point next_registers_;
+    std::atomic<size_t> client_count_{0};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> events_{0};
+    std::atomic<uint64_t> dropped_clients_{0};
+
+    Result<bool> open_devices();
+    void close_devices();
+    void run_reader(const std::function<Result<bool>()>& body);
+
+    void run();
+    void wake();
+    void post_reply(uint64_t client, std::vector<uint8_t> frame);
+    void post_event(uint8_t topic, uint8_t source, std::vector<uint8_t> payload);
+    void drain_posted();
+    void deliver_event(uint8_t topic, uint8_t source, const std::vector<uint8_t>& payload);
+    void expire_waiters(Clock::time_point now);
+    void poll_gps(Clock::time_point now);
+    void poll_registers(Clock::time_point now);
+    int next_timeout_ms(Clock::time_point now) const;
+
+    void accept_clients();
+    bool read_client(uint64_t id, Client& client);
+    bool flush_client(Client& client);
+    void queue_frame(uint64_t id, const std::vector<uint8_t>& frame);
+    void handle(uint64_t id, Client& client, const daemon::Frame& frame);
+};
+
+} // namespace obu
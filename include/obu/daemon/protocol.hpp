@@ -0,0 +1,119 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/response.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace obu {
+namespace daemon {
+
+// Wire format between obu-daemon and its clients (Unix stream socket).
+//
+//   frame := [type:1][id:4 BE][body_len:4 BE][body]
+//
+// Requests carry a client-chosen id that the REPLY echoes, so a client may
+// keep any number of requests in flight; replies for one device come back in
+// request order, replies for different devices may interleave. EVENT frames
+// use id 0 and go to every client subscribed to the topic.
+//
+//   REPLY body = [status:1][payload]     status 0 = ok, else Error + 1
+//   EVENT body = [topic:1][payload]
+//
+// Request bodies and reply payloads (integers BE):
+//   MBOARD_ALIVE            -                    -> alive (12 bytes)
+//   MBOARD_READ_REGISTERS   [start:1][count:1][flags:1]? -> register bytes
+//                           served from the register shadow when it holds
+//                           the range, unless flags has READ_FRESH
+//   MBOARD_GPS              -                    -> NMEA text
+//   MBOARD_WRITE_REGISTERS  [start:1][values]    -> -   (batched, see RegisterWriter)
+//   TERMINAL_ALIVE          [addr:1]             -> terminal alive (8 bytes)
+//   TERMINAL_BEEP           [addr:1]             -> -
+//   QR_SCAN                 [timeout_ms:4]       -> code of the next scan
+//   CARD_READ               [source:1][timeout_ms:4] -> card of the next tap
+//   SUBSCRIBE               [topics:4]           -> -   (bit n = topic n)
+//   PING                    -                    -> -
+constexpr uint8_t MSG_MBOARD_ALIVE = 0x01;
+constexpr uint8_t MSG_MBOARD_READ_REGISTERS = 0x02;
+constexpr uint8_t MSG_MBOARD_GPS = 0x03;
+constexpr uint8_t MSG_MBOARD_WRITE_REGISTERS = 0x04;
+constexpr uint8_t MSG_TERMINAL_ALIVE = 0x10;
+constexpr uint8_t MSG_TERMINAL_BEEP = 0x11;
+constexpr uint8_t MSG_QR_SCAN = 0x20;
+constexpr uint8_t MSG_CARD_READ = 0x30;
+constexpr uint8_t MSG_SUBSCRIBE = 0x40;
+constexpr uint8_t MSG_PING = 0x41;
+constexpr uint8_t MSG_REPLY = 0x80;
+constexpr uint8_t MSG_EVENT = 0x81;
+
+constexpr uint8_t READ_FRESH = 0x01;
+
+// Event topics. CARD payload = [source:1][atqa:2][sak:1][ct:1][bcc1:1][bcc2:1]
+// [uid_len:1][uid hex][extra], the fields of validator::NfcCardInfo; source as
+// in StatusSource (1 validator, 2 Corvus, 0 = any for CARD_READ). Corvus only
+// reports the UID, the rest is zero.
+// REGISTERS payload = ([reg:1][value:1])*, only the watched registers that changed.
+constexpr uint8_t TOPIC_CARD = 0;
+constexpr uint8_t TOPIC_QR = 1;
+constexpr uint8_t TOPIC_GPS = 2;
+constexpr uint8_t TOPIC_REGISTERS = 3;
+
+constexpr size_t FRAME_HEADER = 9;
+constexpr size_t MAX_FRAME_BODY = 64 * 1024;
+
+struct Frame
+{
+    uint8_t type = 0;
+    uint32_t id = 0;
+    std::vector<uint8_t> body;
+};
+
+struct CardEvent
+{
+    uint8_t source = 0;
+    uint16_t atqa = 0;
+    uint8_t sak = 0;
+    uint8_t ct = 0;
+    uint8_t bcc1 = 0;
+    uint8_t bcc2 = 0;
+    std::string uid;
+    std::vector<uint8_t> extra;
+};
+
+std::vector<uint8_t> encode_frame(uint8_t type, uint32_t id, const uint8_t* body, size_t len);
+std::vector<uint8_t> encode_reply(uint32_t id, Error error);
+std::vector<uint8_t> encode_reply(uint32_t id, const uint8_t* payload, size_t len);
+std::vector<uint8_t> encode_event(uint8_t topic, const uint8_t* payload, size_t len);
+
+// Splits a REPLY body into its payload, or the error it carries.
+Result<std::vector<uint8_t>> decode_reply(const std::vector<uint8_t>& body);
+
+std::vector<uint8_t> encode_alive(const AliveResponse& alive);
+Result<AliveResponse> decode_alive(const std::vector<uint8_t>& payload);
+std::vector<uint8_t> encode_terminal_alive(const TerminalAliveResponse& alive);
+Result<TerminalAliveResponse> decode_terminal_alive(const std::vector<uint8_t>& payload);
+std::vector<uint8_t> encode_card(const CardEvent& card);
+Result<CardEvent> decode_card(const std::vector<uint8_t>& payload);
+
+void put_be(std::vector<uint8_t>& out, uint32_t v, int bytes);
+uint32_t get_be(const uint8_t* p, int bytes);
+
+// Reassembles frames from a byte stream that may split or coalesce them.
+class FrameReader
+{
+public:
+    void feed(const uint8_t* data, size_t len) { buffer_.insert(buffer_.end(), data, data + len); }
+
+    // Returns true and fills frame when a complete frame is buffered.
+    Result<bool> next(Frame& frame);
+
+    void clear() { buffer_.clear(); start_ = 0; }
+
+private:
+    std::vector<uint8_t> buffer_;
+    size_t start_ = 0;      // consumed prefix, compacted lazily
+};
+
+} // namespace daemon
+} // namespace obu
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/response.hpp"
+#include "common/cancellation.hpp"
+#include "daemon/client.hpp"
+#include "validator/nfc_reader.hpp"
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+// Stand-ins for the device classes that go through obu-daemon instead of
+// opening the port. Method names, defaults and results match the local
+// classes, so switching is a matter of constructing these on a DaemonClient.
+// Reads return the next card/code the daemon's continuous reader sees.
+namespace obu {
+namespace remote {
+
+class Mboard
+{
+public:
+    explicit Mboard(DaemonClient& client) : client_(client) {}
+
+    Result<AliveResponse> alive();
+    Result<GpsData> gps();
+    // From the daemon's register shadow when it watches the range; fresh
+    // always reads the board.
+    Result<std::vector<uint8_t>> read_registers(uint8_t start, uint8_t count, bool fresh = false);
+    // Batched with other clients' writes inside the daemon's write window.
+    Result<bool> write_registers(uint8_t start, const std::vector<uint8_t>& values);
+
+private:
+    DaemonClient& client_;
+};
+
+class Terminal
+{
+public:
+    explicit Terminal(DaemonClient& client) : client_(client) {}
+
+    Result<TerminalAliveResponse> alive(TerminalAddress addr = TerminalAddress::TERMINAL_A);
+    Result<bool> beep(TerminalAddress addr = TerminalAddress::TERMINAL_A);
+
+private:
+    DaemonClient& client_;
+};
+
+// Shared by the readers: blocks in start_*() delivering events until stop()
+// or the connection drops.
+class EventLoop
+{
+public:
+    explicit EventLoop(DaemonClient& client) : client_(client) {}
+
+    void stop() { running_.store(false); stop_.cancel(); }
+    bool is_running() const { return running_.load(); }
+
+protected:
+    DaemonClient& client_;
+
+    Result<bool> run(uint8_t topic, DaemonClient::EventCallback callback);
+
+private:
+    std::atomic<bool> running_{false};
+    CancellationToken stop_;
+};
+
+class QrScanner : public EventLoop
+{
+public:
+    using ScanCallback = std::function<void(const std::string& code)>;
+
+    static constexpr int SCAN_TIMEOUT_MS = 3000;
+
+    explicit QrScanner(DaemonClient& client) : EventLoop(client) {}
+
+    Result<std::string> scan_once();
+
+    void set_scan_callback(ScanCallback callback) { scan_callback_ = std::move(callback); }
+    Result<bool> start_continuous();
+
+private:
+    ScanCallback scan_callback_;
+};
+
+class NfcReader : public EventLoop
+{
+public:
+    using CardCallback = std::function<void(const validator::NfcCardInfo&)>;
+
+    explicit NfcReader(DaemonClient& client) : EventLoop(client) {}
+
+    Result<validator::NfcCardInfo> read_single_card(int timeout_ms = 5000);
+
+    void set_card_callback(CardCallback callback) { card_callback_ = std::move(callback); }
+    Result<bool> start_reading();
+
+private:
+    CardCallback card_callback_;
+};
+
+class CorvusNfcReader : public EventLoop
+{
+public:
+    using UidCallback = std::function<void(const std::string& uid)>;
+
+    static constexpr int DEFAULT_TIMEOUT_SEC = 20;
+
+    explicit CorvusNfcReader(DaemonClient& client) : EventLoop(client) {}
+
+    Result<std::string> read_nfc_uid(int timeout_sec = DEFAULT_TIMEOUT_SEC);
+
+    void start_reading(UidCallback callback);
+    void stop_reading() { stop(); }
+};
+
+} // namespace remote
+} // namespace obu
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "devices/corvus_protocol.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace obu {
+namespace corvus {
+
+// ISO-style framing used by terminals reached without ECRProxy:
+// STX + payload + ETX + LRC, where LRC is the XOR of the payload bytes.
+// Payload: type(4) + processing code(6) + seq(4) [+ FS-separated fields].
+
+// Per-connection frame extractor. Bytes before STX are discarded; a frame
+// whose LRC does not match is dropped and reported as CRC_MISSMATCH.
+class IsoFrameBuffer
+{
+public:
+    void feed(const uint8_t* data, size_t len) { buffer_.insert(buffer_.end(), data, data + len); }
+    Result<bool> next(std::vector<uint8_t>& msg);
+    void clear() { buffer_.clear(); }
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+constexpr uint8_t ISO_STX = 0x02;
+constexpr uint8_t ISO_ETX = 0x03;
+constexpr char ISO_FS = 0x1C;
+
+constexpr std::string_view ISO_TYPE_LOGON = "0100";
+constexpr std::string_view ISO_TYPE_ADMIN = "0200";
+
+constexpr std::string_view ISO_PROC_LOGON = "900000";
+constexpr std::string_view ISO_PROC_READ_UID = "900100";
+constexpr std::string_view ISO_PROC_READ_CARD = "900200";
+constexpr std::string_view ISO_PROC_OPERATIONAL = "900300";
+
+inline uint8_t iso_lrc(const uint8_t* data, size_t len)
+{
+    uint8_t lrc = 0;
+    for (size_t i = 0; i < len; ++i) {
+        lrc ^= data[i];
+    }
+    return lrc;
+}
+
+inline void begin_iso(SendBuffer& out, std::string_view type, std::string_view proc, uint16_t counter)
+{
+    out.clear();
+    out.put(static_cast<char>(ISO_STX));
+    out.put(type);
+    out.put(proc);
+    out.put_seq(counter);
+}
+
+// Closes the frame with ETX and the LRC of everything after STX.
+inline bool finish_iso(SendBuffer& out)
+{
+    if (out.overflowed() || out.size() - 1 > MAX_MESSAGE_LEN) {
+        return false;
+    }
+    uint8_t lrc = iso_lrc(out.data() + 1, out.size() - 1);
+    out.put(static_cast<char>(ISO_ETX));
+    out.put(static_cast<char>(lrc));
+    return !out.overflowed();
+}
+
+inline bool build_iso_operational_msg(SendBuffer& out, uint16_t counter)
+{
+    begin_iso(out, ISO_TYPE_ADMIN, ISO_PROC_OPERATIONAL, counter);
+    return finish_iso(out);
+}
+
+inline bool build_iso_logon_msg(SendBuffer& out, uint16_t counter, std::string_view op_id, std::string_view pwd)
+{
+    begin_iso(out, ISO_TYPE_LOGON, ISO_PROC_LOGON, counter);
+    out.put(ISO_FS);
+    out.put("01");
+    out.put(op_id);
+    out.put(ISO_FS);
+    out.put("02");
+    out.put(pwd);
+    return finish_iso(out);
+}
+
+inline bool build_iso_read_uid_msg(SendBuffer& out, uint16_t counter)
+{
+    begin_iso(out, ISO_TYPE_ADMIN, ISO_PROC_READ_UID, counter);
+    return finish_iso(out);
+}
+
+inline bool build_iso_read_card_msg(SendBuffer& out, uint16_t counter)
+{
+    begin_iso(out, ISO_TYPE_ADMIN, ISO_PROC_READ_CARD, counter);
+    return finish_iso(out);
+}
+
+// STAN echoed after type and processing code, or -1 if the reply has none
+int iso_message_sequence(std::string_view msg);
+
+// Framing/codec policy for BasicCorvusReader: STX/ETX/LRC framing.
+struct IsoCodec
+{
+    using Decoder = IsoFrameBuffer;
+
+    static constexpr bool HAS_KEEPALIVE = false;
+
+    // The ISO logon carries the password itself, not a hash.
+    static std::string credential(const std::string& password) { return password; }
+
+    static bool operational(SendBuffer& out, uint16_t seq) { return build_iso_operational_msg(out, seq); }
+    static bool logon(SendBuffer& out, uint16_t seq, std::string_view op_id, std::string_view credential)
+    {
+        return build_iso_logon_msg(out, seq, op_id, credential);
+    }
+    static bool read_uid(SendBuffer& out, uint16_t seq) { return build_iso_read_uid_msg(out, seq); }
+    static bool read_card(SendBuffer& out, uint16_t seq) { return build_iso_read_card_msg(out, seq); }
+
+    // Replies without a STAN cannot be matched and are taken as the answer.
+    static bool matches(std::string_view msg, uint16_t seq)
+    {
+        int stan = iso_message_sequence(msg);
+        return stan < 0 || stan == seq;
+    }
+    static Result<Reply> decode(std::string_view msg, Command command);
+};
+
+} // namespace corvus
+} // namespace obu
@@ -1,28 +1,48 @@
 #pragma once
 
 #include "common/types.hpp"
+#include "common/cancellation.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
+#include "devices/corvus_protocol.hpp"
+#include "devices/corvus_iso_codec.hpp"
 #include <string>
 #include <functional>
 #include <atomic>
 #include <cstdint>
 #include <vector>
+#include <chrono>
 
 namespace obu {
 
-class CorvusNfcReader
+// Ingenico reader session over TCP, parameterised on the framing/codec policy
+// (corvus::LengthPrefixedCodec or corvus::IsoCodec). The codec is bound at
+// compile time, so each deployment gets its own specialization with no
+// virtual calls on the message path.
+template <typename Codec>
+class BasicCorvusReader
 {
 public:
     static constexpr const char* DEFAULT_HOST = "127.0.0.1";
     static constexpr int DEFAULT_PORT = 4543;
     static constexpr int DEFAULT_TIMEOUT_SEC = 20;
+    static constexpr int DEFAULT_REVALIDATE_SEC = 300;
+    static constexpr int KEEPALIVE_INTERVAL_MS = 200;
+    static constexpr int RETRY_DELAY_MS = 1000;     // start_reading() after a failed read
+    
+    enum class SessionState {
+        DISCONNECTED,
+        CONNECTED,      // socket up, not logged on (or needs revalidation)
+        LOGGED_ON
+    };
     
     using UidCallback = std::function<void(const std::string& uid)>;
     
-    explicit CorvusNfcReader(const char* host = DEFAULT_HOST, int port = DEFAULT_PORT);
-    ~CorvusNfcReader();
+    explicit BasicCorvusReader(const char* host = DEFAULT_HOST, int port = DEFAULT_PORT);
+    ~BasicCorvusReader();
     
-    CorvusNfcReader(const CorvusNfcReader&) = delete;
-    CorvusNfcReader& operator=(const CorvusNfcReader&) = delete;
+    BasicCorvusReader(const BasicCorvusReader&) = delete;
+    BasicCorvusReader& operator=(const BasicCorvusReader&) = delete;
     
     Result<bool> connect();
     void disconnect();
@@ -31,38 +51,69 @@ public:
     Result<bool> logon(const std::string& operator_id = "1", const std::string& password = "23646");
     Result<bool> is_terminal_operational();
     
+    // Credentials used when the session (re)logs on. The codec credential
+    // (SHA1 hash for ECRProxy) is computed here once.
+    void set_credentials(const std::string& operator_id, const std::string& password);
+    // A logged-on session is re-checked (operational + logon) after this long.
+    void set_revalidate_interval(std::chrono::seconds interval) { revalidate_interval_ = interval; }
+    SessionState session_state() const { return session_state_; }
+    void invalidate_session();
+    
     Result<std::string> read_nfc_uid(int timeout_sec = DEFAULT_TIMEOUT_SEC);
     Result<std::string> read_card_data(int timeout_sec = DEFAULT_TIMEOUT_SEC);
     
     void start_reading(UidCallback callback);
-    void stop_reading() { running_.store(false); }
+    // Wakes any blocked wait immediately via the cancellation token.
+    void stop_reading();
+    // Shared shutdown token, polled by every wait next to the socket. Must outlive the reader.
+    void set_cancel_token(const CancellationToken* token) { shutdown_ = token; }
     bool is_running() const { return running_.load(); }
     
     std::string get_last_error() const { return last_error_; }
+    // Responses discarded because their sequence number matched no pending request
+    uint64_t stale_responses() const { return stale_responses_.load(std::memory_order_relaxed); }
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+    // Publishes each UID read to the shared status segment. Must outlive the reader.
+    void set_status_publisher(StatusPublisher* status) { status_ = status; }
 
 private:
     std::string host_;
     int port_;
     int socket_fd_{-1};
+    int timer_fd_{-1};      // keepalive timer, armed only while waiting
+    CancellationToken cancel_;                      // signalled by stop_reading()
+    const CancellationToken* shutdown_{nullptr};
     uint16_t counter_{0};
+    corvus::SendBuffer tx_;
+    typename Codec::Decoder rx_;        // persists across waits on one connection
+    std::atomic<uint64_t> stale_responses_{0};
+    StatusPublisher* status_{nullptr};
     std::atomic<bool> running_{false};
     std::string last_error_;
     
+    std::string operator_id_{"1"};
+    std::string credential_;
+    SessionState session_state_{SessionState::DISCONNECTED};
+    std::chrono::steady_clock::time_point validated_at_;
+    std::chrono::seconds revalidate_interval_{DEFAULT_REVALIDATE_SEC};
+    
     uint16_t next_counter();
+    Result<bool> ensure_session();
+    void note_failure(Error error);
     
-    Result<bool> send_message(const std::vector<uint8_t>& msg);
+    Result<bool> send_message(bool built);
+    Result<bool> fill_rx_buffer();
     Result<std::vector<uint8_t>> receive_message(int timeout_sec);
-    Result<std::vector<uint8_t>> wait_for_response_with_keepalive(int timeout_sec);
+    Result<std::vector<uint8_t>> wait_for_response_with_keepalive(int timeout_sec, uint16_t seq);
     bool send_keepalive();
-    bool is_success_response(const std::vector<uint8_t>& response);
-    
-    std::vector<uint8_t> build_logon_msg(uint16_t counter, const std::string& op_id, const std::string& pwd);
-    std::vector<uint8_t> build_read_uid_msg(uint16_t counter);
-    std::vector<uint8_t> build_read_card_msg(uint16_t counter);
-    std::vector<uint8_t> build_operational_msg(uint16_t counter);
-    
-    std::string parse_uid_response(const std::vector<uint8_t>& response);
-    std::string parse_card_response(const std::vector<uint8_t>& response);
 };
 
+extern template class BasicCorvusReader<corvus::LengthPrefixedCodec>;
+extern template class BasicCorvusReader<corvus::IsoCodec>;
+
+// ECRProxy (length-prefixed LIIngenicoECR)
+using CorvusNfcReader = BasicCorvusReader<corvus::LengthPrefixedCodec>;
+// Direct STX/ETX/LRC link
+using CorvusIsoReader = BasicCorvusReader<corvus::IsoCodec>;
+
 } // namespace obu
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "common/types.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+
+namespace obu {
+namespace corvus {
+
+// LIIngenicoECR message layer shared by BasicCorvusReader and
+// CorvusReaderManager. Messages travel as [len:2 BE][payload]; a
+// zero-length frame is a keepalive.
+
+constexpr uint16_t MAX_MESSAGE_LEN = 4096;
+
+// Requests the reader issues; each codec maps them onto its own wire format.
+enum class Command {
+    OPERATIONAL,
+    LOGON,
+    READ_UID,
+    READ_CARD
+};
+
+// SHA1 of the password zero-padded to 9 bytes, as uppercase hex
+std::string password_hash(const std::string& password);
+
+// Reusable transmit buffer holding one framed request. Builders write the
+// framing, header, sequence and fields in place, so data()/size() can go to
+// the socket with a single send() and no intermediate copies.
+class SendBuffer
+{
+public:
+    void clear() { len_ = 0; overflow_ = false; }
+
+    void put(char c)
+    {
+        if (len_ >= buf_.size()) {
+            overflow_ = true;
+            return;
+        }
+        buf_[len_++] = c;
+    }
+
+    void put(std::string_view s)
+    {
+        if (s.size() > buf_.size() - len_) {
+            overflow_ = true;
+            return;
+        }
+        memcpy(buf_.data() + len_, s.data(), s.size());
+        len_ += s.size();
+    }
+
+    // 4 digits, zero padded
+    void put_seq(uint16_t counter)
+    {
+        char digits[5];
+        auto res = std::to_chars(digits, digits + sizeof(digits), counter % 10000);
+        size_t n = res.ptr - digits;
+        for (size_t i = n; i < 4; ++i) put('0');
+        put(std::string_view(digits, n));
+    }
+
+    void set(size_t pos, uint8_t value) { buf_[pos] = value; }
+    bool overflowed() const { return overflow_; }
+
+    const uint8_t* data() const { return buf_.data(); }
+    size_t size() const { return len_; }
+
+private:
+    std::array<uint8_t, MAX_MESSAGE_LEN + 8> buf_;
+    size_t len_ = 0;
+    bool overflow_ = false;
+};
+
+// Fixed part of every request: type(2) + "0000" + seq(4) + command(2).
+// The header bytes are assembled at compile time per message type. The
+// answer carries the request type plus ten ("01" -> "11").
+template <char Type0, char Type1, char Cmd0, char Cmd1>
+struct RequestFormat
+{
+    static_assert(Type0 >= '0' && Type0 < '9', "request type has no response type");
+
+    static constexpr char header[6] = {Type0, Type1, '0', '0', '0', '0'};
+    static constexpr char command[2] = {Cmd0, Cmd1};
+    static constexpr char reply_type[2] = {static_cast<char>(Type0 + 1), Type1};
+
+    static constexpr std::string_view code() { return std::string_view(command, sizeof(command)); }
+    static constexpr std::string_view response_type() { return std::string_view(reply_type, sizeof(reply_type)); }
+
+    static void begin(SendBuffer& out, uint16_t counter)
+    {
+        out.clear();
+        out.put('\0');     // length prefix, filled in by finish_frame()
+        out.put('\0');
+        out.put(std::string_view(header, sizeof(header)));
+        out.put_seq(counter);
+        out.put(std::string_view(command, sizeof(command)));
+    }
+};
+
+using OperationalFormat = RequestFormat<'3', '0', '0', '1'>;
+using LogonFormat       = RequestFormat<'0', '1', '0', '1'>;
+using ReadUidFormat     = RequestFormat<'0', '1', '9', '5'>;
+using ReadCardFormat    = RequestFormat<'0', '1', '9', '0'>;
+
+// Writes the length prefix; false if the message overflowed the buffer.
+inline bool finish_frame(SendBuffer& out)
+{
+    size_t len = out.size() - 2;
+    if (out.overflowed() || len > MAX_MESSAGE_LEN) {
+        return false;
+    }
+    out.set(0, (len >> 8) & 0xFF);
+    out.set(1, len & 0xFF);
+    return true;
+}
+
+// Request builders, inline so each codec's encode compiles down to the
+// stores for its own format.
+
+inline bool build_operational_msg(SendBuffer& out, uint16_t counter)
+{
+    // Format: "300000" + seq(4) + "01"
+    OperationalFormat::begin(out, counter);
+    return finish_frame(out);
+}
+
+inline bool build_logon_msg(SendBuffer& out, uint16_t counter, std::string_view op_id, std::string_view pwd_hash)
+{
+    // Format: "010000" + seq(4) + "01" + "L" + operatorId + ";P" + SHA1(password)
+    LogonFormat::begin(out, counter);
+    out.put('L');
+    out.put(op_id);
+    out.put(";P");
+    out.put(pwd_hash);
+    return finish_frame(out);
+}
+
+inline bool build_read_uid_msg(SendBuffer& out, uint16_t counter)
+{
+    // Format: "010000" + seq(4) + "95"
+    ReadUidFormat::begin(out, counter);
+    return finish_frame(out);
+}
+
+inline bool build_read_card_msg(SendBuffer& out, uint16_t counter)
+{
+    // Format: "010000" + seq(4) + "90"
+    ReadCardFormat::begin(out, counter);
+    return finish_frame(out);
+}
+
+// Three-digit result code of a response. Only SUCCESS is interpreted; any
+// other value is carried through as its number.
+enum class ResultCode : uint16_t {
+    SUCCESS = 0
+};
+
+// Response layout: type(2) + "0000" + seq(4) + command(2) + result(3) + data.
+// All views point into the buffer passed to decode_response().
+struct Response
+{
+    std::string_view type;
+    uint16_t sequence = 0;
+    std::string_view command;
+    ResultCode result = ResultCode::SUCCESS;
+    std::string_view data;
+
+    bool success() const { return result == ResultCode::SUCCESS; }
+    // Response type and command code both match Format's request.
+    template <typename Format>
+    bool answers() const { return type == Format::response_type() && command == Format::code(); }
+};
+
+// Codec-independent view of a reply to one Command.
+struct Reply
+{
+    ResultCode result = ResultCode::SUCCESS;
+    std::string_view data;
+
+    bool success() const { return result == ResultCode::SUCCESS; }
+};
+
+// Track-2 equivalent data: PAN '=' YYMM ...
+struct Track2
+{
+    std::string_view pan;
+    std::string_view expiry;    // YYMM, empty if absent
+};
+
+inline std::string_view as_view(const std::vector<uint8_t>& msg)
+{
+    return std::string_view(reinterpret_cast<const char*>(msg.data()), msg.size());
+}
+
+// Checks every fixed field for digits; PARSE_ERROR if the header is malformed.
+// Whether it answers a given request (type and command) is answers<Format>().
+Result<Response> decode_response(std::string_view msg);
+Track2 split_track2(std::string_view data);
+
+// Sequence counter echoed at bytes 6..9, or -1
+int message_sequence(std::string_view msg);
+
+// Per-connection reassembly buffer. Length headers may arrive split across
+// reads and several messages may arrive in one; keepalive frames are skipped.
+class StreamBuffer
+{
+public:
+    void feed(const uint8_t* data, size_t len) { buffer_.insert(buffer_.end(), data, data + len); }
+    Result<bool> next(std::vector<uint8_t>& msg);
+    void clear() { buffer_.clear(); }
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+// Framing/codec policy for BasicCorvusReader: ECRProxy's length-prefixed
+// LIIngenicoECR messages.
+struct LengthPrefixedCodec
+{
+    using Decoder = StreamBuffer;
+
+    static constexpr bool HAS_KEEPALIVE = true;
+    static constexpr uint8_t KEEPALIVE[2] = {0, 0};
+
+    static std::string credential(const std::string& password) { return password_hash(password); }
+
+    static bool operational(SendBuffer& out, uint16_t seq) { return build_operational_msg(out, seq); }
+    static bool logon(SendBuffer& out, uint16_t seq, std::string_view op_id, std::string_view credential)
+    {
+        return build_logon_msg(out, seq, op_id, credential);
+    }
+    static bool read_uid(SendBuffer& out, uint16_t seq) { return build_read_uid_msg(out, seq); }
+    static bool read_card(SendBuffer& out, uint16_t seq) { return build_read_card_msg(out, seq); }
+
+    static bool matches(std::string_view msg, uint16_t seq) { return message_sequence(msg) == seq; }
+    static Result<Reply> decode(std::string_view msg, Command command);
+};
+
+} // namespace corvus
+} // namespace obu
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "devices/corvus_nfc_reader.hpp"
+#include "devices/corvus_protocol.hpp"
+#include "common/timer_wheel.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <random>
+#include <chrono>
+#include <cstdint>
+
+namespace obu {
+
+// Owns connections to several ECRProxy endpoints (one per Ingenico terminal)
+// and drives them all from a single event-loop thread. Each link connects
+// non-blocking, logs on ahead of time and reconnects with jittered
+// exponential backoff, so a read can always go to a terminal that is already
+// operational instead of paying connect + logon on the passenger's tap.
+class CorvusReaderManager
+{
+public:
+    struct Endpoint
+    {
+        std::string host = CorvusNfcReader::DEFAULT_HOST;
+        int port = CorvusNfcReader::DEFAULT_PORT;
+    };
+
+    struct Options
+    {
+        std::string operator_id = "1";
+        std::string password = "23646";
+        int connect_timeout_ms = 2000;
+        int backoff_min_ms = 250;
+        int backoff_max_ms = 30000;
+        int revalidate_sec = CorvusNfcReader::DEFAULT_REVALIDATE_SEC;
+        int read_timeout_sec = CorvusNfcReader::DEFAULT_TIMEOUT_SEC;
+    };
+
+    enum class LinkState {
+        DISCONNECTED,   // waiting for the backoff to expire
+        CONNECTING,
+        CHECKING,       // operational check sent
+        LOGGING_ON,
+        READY,          // logged on, idle
+        READING         // 95 read outstanding
+    };
+
+    using UidCallback = std::function<void(size_t endpoint, const std::string& uid)>;
+
+    explicit CorvusReaderManager(std::vector<Endpoint> endpoints);
+    CorvusReaderManager(std::vector<Endpoint> endpoints, Options options);
+    ~CorvusReaderManager();
+
+    CorvusReaderManager(const CorvusReaderManager&) = delete;
+    CorvusReaderManager& operator=(const CorvusReaderManager&) = delete;
+
+    Result<bool> start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    // Routes one read to an operational terminal. If none is ready the request
+    // waits for the first one that becomes ready, up to timeout_sec.
+    Result<std::string> read_nfc_uid(int timeout_sec = CorvusNfcReader::DEFAULT_TIMEOUT_SEC);
+
+    // Keeps a read armed on every operational terminal. The callback runs on
+    // the event-loop thread with the index of the terminal that was tapped.
+    void start_reading(UidCallback callback);
+    void stop_reading();
+
+    size_t endpoint_count() const { return links_.size(); }
+    LinkState state(size_t index) const { return links_[index]->state.load(); }
+    size_t operational_count() const;
+    // Routed reads waiting for a terminal, as of the last loop iteration.
+    size_t pending_reads() const { return pending_reads_.load(std::memory_order_relaxed); }
+
+    // Loop liveness, operational links, per-link state and pending reads, labelled <name>.
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+    // Publishes every UID, from any terminal, to the shared status segment.
+    // Set before start(); must outlive the manager.
+    void set_status_publisher(StatusPublisher* status) { status_ = status; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request
+    {
+        std::promise<Result<std::string>> promise;
+        Clock::time_point deadline;
+    };
+
+    struct Link
+    {
+        Endpoint endpoint;
+        size_t index = 0;
+        int fd = -1;
+        std::atomic<LinkState> state{LinkState::DISCONNECTED};
+        corvus::StreamBuffer rx;
+        uint16_t counter = 0;
+        int pending_seq = -1;
+        int failures = 0;
+        Clock::time_point retry_at;
+        Clock::time_point deadline;
+        Clock::time_point validated_at;
+        std::shared_ptr<Request> request;   // routed read bound to this link
+        TimerWheel::TimerId keepalive = TimerWheel::INVALID_TIMER;
+    };
+
+    std::vector<std::unique_ptr<Link>> links_;
+    Options options_;
+    std::string password_hash_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    int wake_fd_{-1};
+    std::mt19937 rng_;
+    corvus::SendBuffer tx_;     // loop thread only
+    TimerWheel timers_;         // loop thread only
+
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<Request>> incoming_;
+    UidCallback callback_;
+    bool continuous_{false};
+
+    std::deque<std::shared_ptr<Request>> queued_;   // loop thread only
+    std::atomic<size_t> pending_reads_{0};
+    StatusPublisher* status_{nullptr};
+
+    void run();
+    void wake();
+    int next_timeout_ms(Clock::time_point now) const;
+    void service(Link& link, Clock::time_point now);
+    void dispatch(Clock::time_point now);
+    void on_readable(Link& link, Clock::time_point now);
+    void on_message(Link& link, const std::vector<uint8_t>& msg, Clock::time_point now);
+
+    void begin_connect(Link& link, Clock::time_point now);
+    void finish_connect(Link& link, Clock::time_point now);
+    bool send_request(Link& link, uint16_t seq, bool built, LinkState next,
+                      Clock::time_point now, Clock::time_point deadline);
+    void begin_check(Link& link, Clock::time_point now);
+    void arm_read(Link& link, Clock::time_point now, Clock::time_point deadline);
+    void fail_link(Link& link, Clock::time_point now);
+    void set_ready(Link& link);
+    void send_keepalive(Link& link);
+
+    uint16_t next_counter(Link& link);
+};
+
+} // namespace obu
@@ -3,6 +3,9 @@
 #include "transport/serial.hpp"
 #include "common/types.hpp"
 #include "common/response.hpp"
+#include "common/rtt_estimator.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
 #include <vector>
 #include <stdint.h>
 
@@ -13,13 +16,34 @@ public:
     Mboard(SerialPort& serial);
 
     Result<AliveResponse> alive();    
-    //Result<GpsData> gps();
+    Result<GpsData> gps();
     Result<std::vector<uint8_t>> read_registers(uint8_t start, uint8_t count);
+    // One WRITE_REGISTERS frame: values go to start, start + 1, ...
+    Result<bool> write_registers(uint8_t start, const std::vector<uint8_t>& values);
+
+    // Request counter, saved and restored across process restarts so the
+    // board keeps seeing increasing sequence numbers.
+    uint16_t counter() const { return counter_; }
+    void set_counter(uint16_t counter) { counter_ = counter; }
+
+    // Response timeout follows the measured round trip; a lost reply is
+    // resent with the same counter per the retry policy.
+    const obu::RttEstimator& rtt() const { return rtt_; }
+    void set_retry_policy(const obu::RetryPolicy& policy) { retry_ = policy; }
+
+    // Per-service latency as obu_command_duration_seconds{device="<name>"}.
+    void register_metrics(obu::MetricsRegistry& registry, const std::string& name) const;
+    // Publishes results to the shared status segment; nullptr stops. Must outlive the device.
+    void set_status_publisher(obu::StatusPublisher* status) { status_ = status; }
 
 private:
 
     SerialPort& serial_;
     uint16_t counter_ = 0;
+    obu::RttEstimator rtt_;
+    obu::RetryPolicy retry_;
+    obu::CommandLatency latency_;
+    obu::StatusPublisher* status_ = nullptr;
 
     Result<std::vector<uint8_t>> send_command(uint8_t service, const uint8_t* data = nullptr, size_t len = 0);
 
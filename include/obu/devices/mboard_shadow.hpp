@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/command_scheduler.hpp"
+#include "common/messages.hpp"
+#include <array>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+class Mboard;
+
+namespace obu {
+
+struct RegisterChange
+{
+    uint8_t reg = 0;
+    uint8_t old_value = 0;
+    uint8_t value = 0;
+};
+
+// Local copy of the Mboard register space. refresh() reads every watched
+// register on the bus in as few READ_REGISTERS as possible, compares the
+// result with the copy and tells subscribers only what changed; read()
+// answers from the copy without touching the port.
+//
+// All Mboard I/O runs on the bus thread, so the shadow can share the board
+// with other commands; stop the bus before destroying the shadow, queued
+// jobs point at it. A register that has never been read is not "changed" by
+// its first value; subscribers take their baseline from read().
+class MboardShadow
+{
+public:
+    static constexpr size_t REGISTERS = 256;
+
+    using Listener = std::function<void(const std::vector<RegisterChange>& changes)>;
+
+    struct Options
+    {
+        // Unwatched registers worth reading to join two spans: one longer
+        // reply is cheaper than another round trip.
+        size_t max_gap = 8;
+        size_t max_span = 64;   // registers per transaction
+    };
+
+    MboardShadow(Mboard& mboard, CommandScheduler& bus);
+    MboardShadow(Mboard& mboard, CommandScheduler& bus, Options options);
+
+    MboardShadow(const MboardShadow&) = delete;
+    MboardShadow& operator=(const MboardShadow&) = delete;
+
+    // Adds [start, start + count) to what refresh() reads.
+    void watch(uint8_t start, size_t count);
+    std::vector<RegisterSpan> plan() const;
+
+    // listener gets the changes within [start, start + count), on the bus
+    // thread; keep it short or hand it to a CallbackExecutor.
+    int subscribe(uint8_t start, size_t count, Listener listener);
+    void unsubscribe(int id);
+
+    // Queues a refresh of the watched registers as a TELEMETRY job. One
+    // still queued absorbs this one, so a slow board never builds a backlog.
+    bool refresh();
+
+    // From the copy, unless fresh or a register in range was never read;
+    // then a VALIDATION read on the bus. Must not be called from the bus thread.
+    Result<std::vector<uint8_t>> read(uint8_t start, uint8_t count, bool fresh = false);
+    // Copy only, never blocks: false if a register in range was never read.
+    bool cached(uint8_t start, uint8_t count, std::vector<uint8_t>& out);
+    // Reads the board now and updates the copy. Bus thread only: call it
+    // from a job on the bus.
+    Result<std::vector<uint8_t>> fetch(uint8_t start, uint8_t count);
+    // Values just written to the board: the copy takes them and subscribers
+    // see them as changes. Bus thread only, like fetch().
+    void written(uint8_t start, const std::vector<uint8_t>& values);
+    // Forgets [start, start + count), e.g. after a write that may or may not
+    // have landed; the next read() of it goes to the board.
+    void invalidate(uint8_t start, size_t count);
+
+    // Hits, misses, transactions, refreshes and changes, labelled device=<name>.
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+
+private:
+    using Bitmap = std::array<uint64_t, REGISTERS / 64>;
+
+    struct Subscriber
+    {
+        int id;
+        uint8_t start;
+        size_t count;
+        Listener listener;
+    };
+
+    Mboard& mboard_;
+    CommandScheduler& bus_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    alignas(64) std::array<uint8_t, REGISTERS> values_{};
+    Bitmap valid_{};
+    Bitmap watched_{};
+    std::vector<RegisterSpan> plan_;
+    std::vector<Subscriber> subscribers_;
+    int next_id_ = 1;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> transactions_{0};
+    std::atomic<uint64_t> refreshes_{0};
+    std::atomic<uint64_t> changes_{0};
+    std::atomic<uint64_t> errors_{0};
+
+    // Caller holds mutex_.
+    void replan();
+    bool all_valid(uint8_t start, size_t count) const;
+    void apply(uint8_t start, const std::vector<uint8_t>& values, std::vector<RegisterChange>& changes);
+    // Caller does not hold mutex_; listeners may call back in.
+    void notify(const std::vector<RegisterChange>& changes);
+};
+
+} // namespace obu
@@ -2,6 +2,9 @@
 
 #include "transport/serial.hpp"
 #include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
+#include "common/callback_executor.hpp"
 #include <string>
 #include <functional>
 #include <atomic>
@@ -18,6 +21,8 @@ public:
 
     Result<bool> initialize();
     bool is_initialized() const { return initialized_; }
+    // Warm start: the scanner kept its settings across our restart, skip the trigger-off round trip.
+    void resume();
 
     Result<bool> trigger_on();
     Result<bool> trigger_off();
@@ -25,16 +30,27 @@ public:
     Result<std::string> scan_once();
 
     void set_scan_callback(ScanCallback callback) { scan_callback_ = std::move(callback); }
+    // Runs the scan callback on executor instead of the read thread; nullptr
+    // runs it inline. Must outlive start_continuous().
+    void set_callback_executor(obu::CallbackExecutor* executor) { executor_ = executor; }
     Result<bool> start_continuous();
-    void stop() { running_.store(false); }
+    void stop() { running_.store(false); serial_.cancel(); }
     bool is_running() const { return running_.load(); }
+    // obu_reader_running{reader="<name>"}; the shared port registers its own counters.
+    void register_metrics(obu::MetricsRegistry& registry, const std::string& name) const;
+    // Publishes results to the shared status segment; nullptr stops. Must outlive the device.
+    void set_status_publisher(obu::StatusPublisher* status) { status_ = status; }
 
 private:
     SerialPort& serial_;
     ScanCallback scan_callback_;
     std::atomic<bool> running_{false};
     bool initialized_{false};
+    obu::StatusPublisher* status_ = nullptr;
+    obu::CallbackExecutor* executor_ = nullptr;
     
     std::string parse_scan_data(const std::vector<unsigned char>& data);
+    // Scan timeout on the port, then initialized; shared by initialize() and resume().
+    void ready();
     Result<bool> send_command(uint8_t cmd);
 };
\ No newline at end of file
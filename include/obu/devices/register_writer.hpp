@@ -0,0 +1,125 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/command_scheduler.hpp"
+#include "common/device_thread.hpp"
+#include "devices/mboard_shadow.hpp"
+#include <array>
+#include <vector>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+class Mboard;
+
+namespace obu {
+
+// Stages Mboard register writes and sends each burst in as few
+// WRITE_REGISTERS frames as possible:
+//
+//   - the first write of a burst opens a flush window; writes that arrive
+//     before the batch goes out join it, and the last value written to a
+//     register wins;
+//   - staged registers are sent as contiguous runs, one frame per run
+//     (max_span registers at most);
+//   - the batch is taken when its job reaches the bus, so writes keep
+//     coalescing while it waits behind other commands.
+//
+// Each write completes when every frame carrying its registers has been
+// answered. A write overwritten inside the window completes with the frame
+// that carried the newer value. Stop the bus before destroying the writer,
+// queued jobs point at it.
+class RegisterWriter
+{
+public:
+    using Done = std::function<void(const Result<bool>& result)>;
+
+    struct Options
+    {
+        std::chrono::milliseconds window{5};
+        size_t max_span = 64;
+        CommandClass command_class = CommandClass::FEEDBACK;   // outputs are passenger-facing
+        ThreadOptions thread;
+    };
+
+    RegisterWriter(Mboard& mboard, CommandScheduler& bus);
+    RegisterWriter(Mboard& mboard, CommandScheduler& bus, Options options);
+    ~RegisterWriter();
+
+    RegisterWriter(const RegisterWriter&) = delete;
+    RegisterWriter& operator=(const RegisterWriter&) = delete;
+
+    Result<bool> start();
+    // Hands what is still staged to the bus, then stops the flush thread.
+    void stop();
+
+    std::future<Result<bool>> write(uint8_t reg, uint8_t value);
+    std::future<Result<bool>> write(uint8_t start, std::vector<uint8_t> values);
+    // done runs on the bus thread, or on the caller's if the write is refused.
+    void write(uint8_t start, std::vector<uint8_t> values, Done done);
+
+    // Sends the current batch without waiting out the window.
+    void flush();
+
+    // Keeps shadow in step: a frame the board acknowledged updates it, a
+    // failed one invalidates its registers. Set before start(); must outlive
+    // the writer's bus jobs.
+    void set_shadow(MboardShadow* shadow) { shadow_ = shadow; }
+
+    // Writes, frames, coalesced values and send delay, labelled device=<name>.
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Bitmap = std::array<uint64_t, MboardShadow::REGISTERS / 64>;
+
+    struct Pending
+    {
+        uint8_t start;
+        size_t count;
+        Done done;
+    };
+
+    struct Batch
+    {
+        Bitmap staged{};
+        std::array<uint8_t, MboardShadow::REGISTERS> values{};
+        std::vector<Pending> pending;
+        Clock::time_point opened;
+
+        bool empty() const { return pending.empty(); }
+    };
+
+    Mboard& mboard_;
+    CommandScheduler& bus_;
+    Options options_;
+    MboardShadow* shadow_{nullptr};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    Batch batch_;
+    bool running_ = false;
+    bool flush_now_ = false;
+    bool job_queued_ = false;
+    DeviceThread thread_;
+
+    LatencyHistogram send_delay_;
+    std::atomic<uint64_t> writes_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> errors_{0};
+
+    void run();
+    // Under mutex_: hands the batch to the bus unless a job is already queued.
+    void submit(std::unique_lock<std::mutex>& lock);
+    void send(Batch batch);
+    void fail(Batch batch, Error error);
+};
+
+} // namespace obu
@@ -3,6 +3,10 @@
 #include "transport/serial.hpp"
 #include "common/types.hpp"
 #include "common/response.hpp"
+#include "common/protocol.hpp"
+#include "common/rtt_estimator.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
 
 #include <stdint.h>
 
@@ -11,13 +15,25 @@
 class Terminal
 {
 public:
-    Terminal(SerialPort& serial) : serial_(serial) {}
+    Terminal(SerialPort& serial)
+        : serial_(serial),
+          rtt_(Protocol::TERMINAL_TIMEOUT_MS, Protocol::MIN_RESPONSE_TIMEOUT_MS, Protocol::MAX_RESPONSE_TIMEOUT_MS) {}
     
     Result<TerminalAliveResponse> alive(TerminalAddress addr = TerminalAddress::TERMINAL_A);
     Result<bool> beep(TerminalAddress addr = TerminalAddress::TERMINAL_A);
 
+    const obu::RttEstimator& rtt() const { return rtt_; }
+    void set_retry_policy(const obu::RetryPolicy& policy) { retry_ = policy; }
+    void register_metrics(obu::MetricsRegistry& registry, const std::string& name) const;
+    // Publishes results to the shared status segment; nullptr stops. Must outlive the device.
+    void set_status_publisher(obu::StatusPublisher* status) { status_ = status; }
+
 private:
     SerialPort& serial_;
+    obu::RttEstimator rtt_;
+    obu::RetryPolicy retry_;
+    obu::CommandLatency latency_;
+    obu::StatusPublisher* status_ = nullptr;
     
     Result<std::vector<uint8_t>> send_command(TerminalAddress addr, uint8_t service, const uint8_t* data = nullptr, size_t len = 0);
     
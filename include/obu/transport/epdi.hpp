@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <stdint.h>
+#include <stddef.h>
 
 #include "common/types.hpp"
 
@@ -9,5 +10,10 @@ class EpdiFrame{
 public:
     static std::vector<uint8_t> encode(const uint8_t* data, size_t len);
     static Result<std::vector<uint8_t>> decode(const uint8_t* frame, size_t len);
+    // Length of the complete frame starting at data[0] (DLE SYNC ... DLE ETX CRC16), 0 if not yet complete.
+    static size_t complete_length(const uint8_t* data, size_t len);
+    // Offset of the first DLE SYNC at or after `from`, len if there is none. Bytes in
+    // front of it are the tail of a frame an earlier read cut off.
+    static size_t sync(const uint8_t* data, size_t len, size_t from = 0);
 };
 
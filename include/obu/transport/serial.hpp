@@ -4,6 +4,10 @@
 #include <string>
 #include <cstring>
 #include <vector>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <fcntl.h>
 #include <unistd.h>
 #include <termios.h>
@@ -13,34 +17,137 @@
 
 
 #include "common/types.hpp"
+#include "common/cancellation.hpp"
+#include "common/rtt_estimator.hpp"
+#include "common/metrics.hpp"
+
+// How a port is driven. The defaults are the settings every device used
+// before profiles existed (115200 8N1, VMIN=0/VTIME=5, 100 ms frame gap).
+struct SerialProfile
+{
+    int baud = 115200;
+    int data_bits = 8;              // 5..8
+    char parity = 'N';              // 'N', 'E' or 'O'
+    int stop_bits = 1;              // 1 or 2
+    bool rts_cts = false;
+    // termios read policy once poll() reports data: with VMIN > 0 the kernel
+    // holds read() until VMIN bytes or a VTIME (1/10 s) inter-byte gap, so a
+    // fixed-size frame arrives in one syscall.
+    int vmin = 0;
+    int vtime = 5;
+    // Idle time after data that ends read(). Lower it on fast links.
+    int frame_gap_ms = 100;
+    // ASYNC_LOW_LATENCY via TIOCSSERIAL (8250/16550 and some USB drivers), and
+    // latency_timer = 1 ms on FTDI adapters.
+    bool low_latency = false;
+    // UART receive FIFO trigger level in bytes (sysfs rx_trig_bytes), -1 = driver default.
+    int rx_trigger_bytes = -1;
+};
+
+// Traffic counters kept by every port, relaxed atomics read by the metrics exporter.
+struct SerialCounters
+{
+    std::atomic<uint64_t> rx_bytes{0};
+    std::atomic<uint64_t> tx_bytes{0};
+    std::atomic<uint64_t> frames{0};            // reads that returned data
+    std::atomic<uint64_t> read_timeouts{0};
+    std::atomic<uint64_t> crc_errors{0};        // reported by the protocol layer
+    std::atomic<uint64_t> retransmits{0};
+    std::atomic<uint64_t> stale_replies{0};     // complete frames transact() did not match
+    std::atomic<int64_t> last_rx_ns{0};         // steady_clock, 0 = nothing received yet
+};
 
 class SerialPort
 {
 public:
+    // set_timeout_ms() value that makes read() block until data or cancel()
+    static constexpr int WAIT_FOREVER = -1;
+    // Default for SerialProfile::frame_gap_ms
+    static constexpr int FRAME_GAP_MS = 100;
+
+    // Tells read_frame() whether the bytes collected so far hold a whole reply.
+    using FrameCheck = std::function<bool(const std::vector<unsigned char>&)>;
 
-    SerialPort() : fd_(-1), baud_(115200), open_(false), timeout_ms_(1000) {}
+    SerialPort() : fd_(-1), shutdown_(nullptr), baud_(115200), open_(false), timeout_ms_(1000),
+                   saved_serial_flags_(-1), saved_latency_timer_(-1), low_latency_(false) {}
     ~SerialPort()
     {
         close();
     }
 
     Result<bool> open(const std::string& port);
+    Result<bool> open(const std::string& port, const SerialProfile& profile);
+    // Re-applies line settings on an open port.
+    Result<bool> apply(const SerialProfile& profile);
     Result<bool> close();
     Result<size_t> write(const unsigned char* data, size_t len);
+    Result<std::vector<unsigned char>> read();
+    // g_running is only checked between wakeups; stop a blocked read with
+    // cancel() or the token from set_cancel_token().
     Result<std::vector<unsigned char>> read(volatile bool& g_running);
+    // Like read(), but returns as soon as `complete` accepts the buffer instead
+    // of waiting out FRAME_GAP_MS. Falls back to the gap if it never does.
+    Result<std::vector<unsigned char>> read_frame(const FrameCheck& complete);
+    // One request/response exchange. Flushes stale input, then waits
+    // rtt.timeout_ms() for the first byte of the reply and reads on until
+    // `matches` accepts the buffer (`complete`, if empty) or the line goes
+    // idle for the frame gap; frames that do not match are skipped. On
+    // timeout resends the identical request (same counter) up to
+    // policy.retries times without flushing, so a late reply to an earlier
+    // attempt still counts. Feeds the time to the first reply byte back into rtt.
+    Result<std::vector<unsigned char>> transact(const unsigned char* request, size_t len, const FrameCheck& complete,
+                                                obu::RttEstimator& rtt, const obu::RetryPolicy& policy,
+                                                const FrameCheck& matches = FrameCheck());
+
+    // Wakes a blocked read(), which returns TIMEOUT, and fails reads at once
+    // until clear_cancel(). Safe from any thread.
+    void cancel();
+    void clear_cancel();
+    // Also abandons reads when `token` (e.g. an application-wide shutdown) is
+    // cancelled. The token must outlive the port; nullptr detaches it.
+    void set_cancel_token(const obu::CancellationToken* token) { shutdown_ = token; }
+    // True while either cancellation is pending; read loops stop retrying on it.
+    bool is_cancelled() const { return cancel_.is_cancelled() || (shutdown_ && shutdown_->is_cancelled()); }
+
+    const SerialCounters& counters() const { return counters_; }
+    // Frames are checked above the port; callers report the failures here.
+    void count_crc_error() { counters_.crc_errors.fetch_add(1, std::memory_order_relaxed); }
+    // Exports the counters as obu_serial_*{port="<name>"}.
+    void register_metrics(obu::MetricsRegistry& registry, const std::string& name) const;
 
     bool is_open();
     std::string get_port() const;
     int get_baud() const;
+    const SerialProfile& get_profile() const { return profile_; }
+    // Whether the driver accepted ASYNC_LOW_LATENCY / the FTDI latency timer.
+    bool is_low_latency() const { return low_latency_; }
     void set_timeout_ms(int timeout_ms);
     void set_8N1(termios &tty);
 private:
 
     int fd_;
+    obu::CancellationToken cancel_;
+    const obu::CancellationToken* shutdown_;
     std::string port_;
     int baud_;
     struct termios original_tty_;
     bool open_;
     int timeout_ms_;
+    SerialProfile profile_;
+    int saved_serial_flags_;
+    int saved_latency_timer_;
+    bool low_latency_;
+    SerialCounters counters_;
+
+    void apply_low_latency(bool enable);
+
+    // Upper bound on one read once the timeout only covers the first byte,
+    // so a line that never goes idle cannot hold the caller.
+    static constexpr size_t MAX_REPLY_BYTES = 4096;
 
+    // With first_byte set the timeout only covers the wait for the first byte,
+    // whose arrival is stored there; after that only `complete`, the frame
+    // gap or MAX_REPLY_BYTES end the read.
+    Result<std::vector<unsigned char>> read_until(volatile bool& g_running, const FrameCheck* complete,
+                                                  std::chrono::steady_clock::time_point* first_byte = nullptr);
 };
\ No newline at end of file
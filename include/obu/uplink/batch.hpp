@@ -0,0 +1,75 @@
+#pragma once
+
+#include "common/types.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace obu {
+namespace uplink {
+
+// Wire format shared by Uploader and StandInServer.
+//
+//   frame := [type:1][body_len:4 BE][body]
+//   HELLO (client -> server)  body = vehicle id
+//   ACK   (server -> client)  body = [next_offset:8 BE]
+//   BATCH (client -> server)  body = [first_offset:8][next_offset:8][count:2]
+//                                    [flags:1][raw_len:4][payload]
+//
+// The raw payload is each event as [varint len][bytes]. With FLAG_LZ set the
+// payload is LzCodec-compressed. Offsets are journal offsets, so an ACK both
+// confirms delivery and tells a reconnecting client where to resume.
+constexpr uint8_t MSG_HELLO = 'H';
+constexpr uint8_t MSG_BATCH = 'B';
+constexpr uint8_t MSG_ACK = 'A';
+
+constexpr uint8_t FLAG_LZ = 0x01;
+
+constexpr size_t FRAME_HEADER = 5;
+constexpr size_t BATCH_HEADER = 23;
+constexpr size_t MAX_FRAME_BODY = 1024 * 1024;
+
+struct Batch
+{
+    uint64_t first_offset = 0;
+    uint64_t next_offset = 0;
+    uint16_t count = 0;
+    std::vector<uint8_t> raw;   // varint-framed events
+};
+
+struct Frame
+{
+    uint8_t type = 0;
+    std::vector<uint8_t> body;
+};
+
+void append_event(std::vector<uint8_t>& raw, const uint8_t* data, size_t len);
+
+// Encodes a BATCH frame, compressing only when it actually saves bytes.
+std::vector<uint8_t> encode_batch(const Batch& batch, bool compress);
+Result<Batch> decode_batch(const std::vector<uint8_t>& body);
+
+// Splits a decoded batch back into individual events.
+Result<std::vector<std::string>> split_events(const Batch& batch);
+
+std::vector<uint8_t> encode_frame(uint8_t type, const uint8_t* body, size_t len);
+std::vector<uint8_t> encode_ack(uint64_t next_offset);
+Result<uint64_t> decode_ack(const std::vector<uint8_t>& body);
+
+// Reassembles frames from a byte stream that may split or coalesce them.
+class FrameReader
+{
+public:
+    void feed(const uint8_t* data, size_t len) { buffer_.insert(buffer_.end(), data, data + len); }
+
+    // Returns true and fills frame when a complete frame is buffered.
+    Result<bool> next(Frame& frame);
+
+    void clear() { buffer_.clear(); }
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+} // namespace uplink
+} // namespace obu
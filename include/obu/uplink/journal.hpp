@@ -0,0 +1,74 @@
+#pragma once
+
+#include "common/types.hpp"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+namespace obu {
+
+// Append-only event journal. Each record is stored as
+// [len:4 BE][crc16:2 BE][payload] and is addressed by its byte offset,
+// so a reader position is just the offset of the next record.
+class EventJournal
+{
+public:
+    static constexpr size_t RECORD_HEADER = 6;
+    static constexpr size_t MAX_RECORD = 64 * 1024;
+
+    using RecordFn = std::function<void(uint64_t offset, const uint8_t* data, size_t len)>;
+
+    explicit EventJournal(std::string path, bool sync_on_append = false);
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    Result<bool> open();
+    void close();
+    bool is_open() const { return fd_ >= 0; }
+
+    Result<uint64_t> append(const uint8_t* data, size_t len);
+    Result<uint64_t> append(const std::string& event);
+
+    // Visits whole records from offset until max_bytes of payload or
+    // max_events are reached. Returns the offset after the last record visited.
+    Result<uint64_t> read(uint64_t offset, size_t max_bytes, size_t max_events, const RecordFn& fn) const;
+
+    uint64_t end_offset() const;
+
+    // Blocks until the journal grows past offset, timeout_ms elapses
+    // (negative = forever) or *running is cleared and wake() is called.
+    bool wait_for_data(uint64_t offset, int timeout_ms, const std::atomic<bool>* running = nullptr);
+    void wake();
+
+private:
+    std::string path_;
+    bool sync_on_append_;
+    int fd_{-1};
+    uint64_t end_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    uint64_t recover_end();
+};
+
+// Upload position persisted next to the journal. Stored via write-to-temp
+// and rename so a crash leaves either the old or the new cursor.
+class JournalCursor
+{
+public:
+    explicit JournalCursor(std::string path) : path_(std::move(path)) {}
+
+    Result<uint64_t> load();
+    Result<bool> store(uint64_t offset);
+
+private:
+    std::string path_;
+};
+
+} // namespace obu
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "uplink/batch.hpp"
+#include <string>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+namespace obu {
+
+// Minimal local back-office stand-in for exercising the Uploader without a
+// real server. Accepts one client at a time, decodes batches, hands each
+// event to the callback and acks cumulatively by journal offset.
+class StandInServer
+{
+public:
+    using EventCallback = std::function<void(const std::string& event)>;
+
+    explicit StandInServer(int port = 0);
+    ~StandInServer();
+
+    StandInServer(const StandInServer&) = delete;
+    StandInServer& operator=(const StandInServer&) = delete;
+
+    Result<bool> start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    // Port actually bound (useful when constructed with port 0).
+    int port() const { return port_; }
+
+    void set_event_callback(EventCallback callback) { event_callback_ = std::move(callback); }
+
+    // Closes the current client connection to simulate link loss.
+    void drop_connection();
+
+    uint64_t committed_offset() const { return committed_.load(); }
+    uint64_t events_received() const { return events_.load(); }
+    uint64_t bytes_received() const { return bytes_.load(); }
+
+private:
+    int port_;
+    int listen_fd_{-1};
+    int client_fd_{-1};
+    int wake_fd_{-1};
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> drop_requested_{false};
+    std::atomic<uint64_t> committed_{0};
+    std::atomic<uint64_t> events_{0};
+    std::atomic<uint64_t> bytes_{0};
+    uplink::FrameReader reader_;
+    EventCallback event_callback_;
+
+    void run();
+    void close_client();
+    bool handle_frame(const uplink::Frame& frame);
+};
+
+} // namespace obu
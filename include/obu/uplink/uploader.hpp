@@ -0,0 +1,104 @@
+#pragma once
+
+#include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "uplink/journal.hpp"
+#include "uplink/batch.hpp"
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace obu {
+
+struct UplinkConfig
+{
+    std::string host = "127.0.0.1";
+    int port = 7400;
+    std::string vehicle_id = "obu";
+    std::string cursor_path = "uplink.cursor";
+
+    size_t max_batch_bytes = 16 * 1024;   // raw event bytes per batch
+    size_t max_batch_events = 1024;
+    size_t window = 4;                    // unacknowledged batches in flight
+    bool compress = true;
+
+    int connect_timeout_ms = 3000;
+    int ack_timeout_ms = 5000;
+    int retry_min_ms = 500;
+    int retry_max_ms = 30000;
+};
+
+struct UplinkStats
+{
+    uint64_t events_acked = 0;
+    uint64_t batches_sent = 0;
+    uint64_t raw_bytes = 0;       // event payload bytes uploaded
+    uint64_t wire_bytes = 0;      // bytes written to the socket
+    uint64_t reconnects = 0;
+};
+
+// Store-and-forward uploader. Reads the journal from a persisted cursor,
+// packs events into compressed size-bounded batches, keeps up to `window`
+// batches in flight and advances the cursor only when the server acks.
+class Uploader
+{
+public:
+    Uploader(EventJournal& journal, UplinkConfig config);
+    ~Uploader();
+
+    Uploader(const Uploader&) = delete;
+    Uploader& operator=(const Uploader&) = delete;
+
+    // Uploads everything currently in the journal and waits for the acks.
+    Result<size_t> flush();
+
+    // Runs flush() whenever the journal grows, reconnecting with backoff,
+    // until stop() is called.
+    Result<bool> start();
+    void stop();
+    bool is_running() const { return running_.load(); }
+
+    uint64_t cursor() const { return cursor_.load(); }
+    UplinkStats stats() const;
+    std::string get_last_error() const { return last_error_; }
+
+    // Journal backlog (bytes not yet acked), cursor and upload totals, labelled <name>.
+    void register_metrics(MetricsRegistry& registry, const std::string& name) const;
+
+private:
+    EventJournal& journal_;
+    UplinkConfig config_;
+    JournalCursor cursor_file_;
+    std::atomic<uint64_t> cursor_{0};
+    bool cursor_loaded_{false};
+
+    int socket_fd_{-1};
+    bool connected_before_{false};
+    uplink::FrameReader reader_;
+    std::atomic<bool> running_{false};
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    // Written by the upload loop, read by stats() and metric scrapes.
+    struct Counters
+    {
+        std::atomic<uint64_t> events_acked{0};
+        std::atomic<uint64_t> batches_sent{0};
+        std::atomic<uint64_t> raw_bytes{0};
+        std::atomic<uint64_t> wire_bytes{0};
+        std::atomic<uint64_t> reconnects{0};
+    };
+    Counters counters_;
+    std::string last_error_;
+
+    Result<bool> connect();
+    void disconnect();
+    Result<bool> handshake();
+    Result<bool> send_all(const std::vector<uint8_t>& data);
+    Result<uplink::Frame> read_frame(int timeout_ms);
+    Result<bool> commit(uint64_t offset);
+};
+
+} // namespace obu
@@ -2,8 +2,12 @@
 
 #include "transport/serial.hpp"
 #include "common/types.hpp"
+#include "common/metrics.hpp"
+#include "common/status_segment.hpp"
+#include "common/callback_executor.hpp"
 #include <string>
 #include <vector>
+#include <optional>
 #include <functional>
 #include <atomic>
 #include <cstdint>
@@ -24,6 +28,7 @@ class NfcReader
 {
 public:
     static constexpr uint8_t ADDR_REQ = 0xF2;
+    static constexpr uint8_t ADDR_RESP = 0x72;
     static constexpr uint8_t CMD_AUTH_A = 0x02;
     static constexpr uint8_t CMD_AUTH_B = 0x03;
     static constexpr uint8_t CMD_ENABLE = 0x63;
@@ -31,8 +36,15 @@ public:
     
     static constexpr const char* DEFAULT_PORT = "/dev/ttymxc1";
     static constexpr int DEFAULT_BAUD = 921600;
+    static constexpr int FRAME_GAP_MS = 5;
     
     using CardCallback = std::function<void(const NfcCardInfo&)>;
+
+    // Negotiated session, enough to resume after a process restart.
+    struct Session {
+        uint8_t counter{0};
+        std::vector<uint8_t> key;
+    };
     
     explicit NfcReader(const char* port = DEFAULT_PORT);
     ~NfcReader();
@@ -41,25 +53,46 @@ public:
     NfcReader& operator=(const NfcReader&) = delete;
     
     Result<bool> initialize();
+    // Warm start: re-presents the cached key with AUTH_B alone. Unless the
+    // reader acknowledges it, runs the full initialize(). Value is true when
+    // the cached session was accepted.
+    Result<bool> resume(const Session& session);
+    Session session() const { return Session{counter_, key_}; }
     bool is_initialized() const { return initialized_.load(); }
     bool is_running() const { return running_.load(); }
     
     void set_card_callback(CardCallback callback) { card_callback_ = std::move(callback); }
+    // Runs the card callback on executor instead of the read thread; nullptr
+    // runs it inline. Must outlive start_reading().
+    void set_callback_executor(obu::CallbackExecutor* executor) { executor_ = executor; }
     
     Result<bool> start_reading();
-    void stop() { running_.store(false); }
+    void stop() { running_.store(false); serial_.cancel(); }
+    // Shared shutdown token, polled by every read next to the port.
+    void set_cancel_token(const obu::CancellationToken* token) { serial_.set_cancel_token(token); }
     Result<NfcCardInfo> read_single_card(int timeout_ms = 5000);
     
     std::string get_last_error() const { return last_error_; }
+    bool is_low_latency() const { return serial_.is_low_latency(); }
+    // Reader liveness plus the counters of the port it owns, both labelled <name>.
+    void register_metrics(obu::MetricsRegistry& registry, const std::string& name) const;
+    // Publishes results to the shared status segment; nullptr stops. Must outlive the device.
+    void set_status_publisher(obu::StatusPublisher* status) { status_ = status; }
+
+    // Line settings used for the reader: DEFAULT_BAUD, low latency, FRAME_GAP_MS.
+    static SerialProfile link_profile();
 
 private:
     SerialPort serial_;
     std::string port_;
     uint8_t counter_{0};
+    std::vector<uint8_t> key_;
     std::atomic<bool> initialized_{false};
     std::atomic<bool> running_{false};
     std::string last_error_;
     CardCallback card_callback_;
+    obu::StatusPublisher* status_{nullptr};
+    obu::CallbackExecutor* executor_{nullptr};
     
     Result<bool> configure_serial();
     Result<bool> send_command(uint8_t cmd, const std::vector<uint8_t>& data = {});
@@ -68,6 +101,10 @@ private:
     Result<bool> enable_reading();
     
     static std::optional<NfcCardInfo> parse_card_info(const std::vector<uint8_t>& frame);
+    // reply is [ADDR_RESP][cmd][counter][source] with a zero status byte, if any.
+    // Only picks resume()'s fast path; a reader that answers otherwise just
+    // gets the full key exchange.
+    static bool acknowledges(const Result<std::vector<uint8_t>>& reply, uint8_t cmd);
     static std::string bytes_to_hex(const std::vector<uint8_t>& data);
 };
 
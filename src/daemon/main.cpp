@@ -0,0 +1,129 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <poll.h>
+#include "daemon/daemon.hpp"
+#include "common/cancellation.hpp"
+#include "common/metrics.hpp"
+#include "common/metrics_server.hpp"
+
+// obu-daemon: owns every device port and serves clients over a Unix socket.
+//
+//   obu-daemon [--socket path] [--mboard tty] [--terminal tty] [--qr tty]
+//              [--validator tty] [--corvus host:port]... [--gps-ms n]
+//              [--registers start:count[,start:count...]] [--registers-ms n]
+//              [--write-window-ms n]
+//              [--status name] [--metrics path]
+
+namespace {
+
+obu::CancellationToken* g_stop = nullptr;
+
+void on_signal(int)
+{
+    if (g_stop) g_stop->cancel();
+}
+
+void usage()
+{
+    std::cerr << "Usage: obu-daemon [--socket path] [--mboard tty] [--terminal tty] [--qr tty]\n"
+              << "                  [--validator tty] [--corvus host:port]... [--gps-ms n]\n"
+              << "                  [--registers start:count[,start:count...]] [--registers-ms n]\n"
+              << "                  [--write-window-ms n]\n"
+              << "                  [--status name] [--metrics path]\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    obu::DaemonConfig config;
+    std::string metrics_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") {
+            config.socket_path = value;
+        } else if (arg == "--mboard") {
+            config.mboard_port = value;
+        } else if (arg == "--terminal") {
+            config.terminal_port = value;
+        } else if (arg == "--qr") {
+            config.qr_port = value;
+        } else if (arg == "--validator") {
+            config.validator_port = value;
+        } else if (arg == "--corvus") {
+            obu::CorvusReaderManager::Endpoint endpoint;
+            auto colon = value.rfind(':');
+            endpoint.host = value.substr(0, colon);
+            if (colon != std::string::npos) endpoint.port = std::atoi(value.c_str() + colon + 1);
+            config.corvus.push_back(endpoint);
+        } else if (arg == "--gps-ms") {
+            config.gps_interval_ms = std::atoi(value.c_str());
+        } else if (arg == "--registers") {
+            size_t pos = 0;
+            while (pos < value.size()) {
+                size_t comma = value.find(',', pos);
+                std::string item = value.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+                auto colon = item.find(':');
+                obu::RegisterSpan span;
+                span.start = static_cast<uint8_t>(std::strtoul(item.c_str(), nullptr, 0));
+                span.count = colon == std::string::npos ? 1 :
+                             static_cast<uint8_t>(std::strtoul(item.c_str() + colon + 1, nullptr, 0));
+                config.watch_registers.push_back(span);
+                if (comma == std::string::npos) break;
+                pos = comma + 1;
+            }
+        } else if (arg == "--registers-ms") {
+            config.register_interval_ms = std::atoi(value.c_str());
+        } else if (arg == "--write-window-ms") {
+            config.register_write_window_ms = std::atoi(value.c_str());
+        } else if (arg == "--status") {
+            config.status_segment = value;
+        } else if (arg == "--metrics") {
+            metrics_path = value;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    obu::CancellationToken stop;
+    g_stop = &stop;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    obu::Daemon daemon(config);
+    auto started = daemon.start();
+    if (!started.ok()) {
+        std::cerr << "obu-daemon: failed to start (error " << static_cast<int>(started.error()) << ")\n";
+        return 1;
+    }
+    std::cout << "obu-daemon: listening on " << config.socket_path << std::endl;
+
+    obu::MetricsRegistry registry;
+    obu::MetricsServer metrics(registry, metrics_path.empty() ? obu::MetricsServer::DEFAULT_PATH : metrics_path);
+    if (!metrics_path.empty()) {
+        daemon.register_metrics(registry);
+        if (!metrics.start().ok()) {
+            std::cerr << "obu-daemon: metrics disabled, cannot listen on " << metrics_path << "\n";
+        }
+    }
+
+    struct pollfd pfd = {stop.fd(), POLLIN, 0};
+    while (!stop.is_cancelled()) {
+        poll(&pfd, 1, -1);
+    }
+
+    metrics.stop();
+    daemon.stop();
+    std::cout << "obu-daemon: stopped" << std::endl;
+    return 0;
+}
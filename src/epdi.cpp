@@ -63,3 +63,34 @@ Result<std::vector<uint8_t>>EpdiFrame::decode(const uint8_t* frame, size_t len)
     
     return Result<std::vector<uint8_t>>::success(std::move(data));
 }
+
+size_t EpdiFrame::complete_length(const uint8_t* data, size_t len)
+{
+    if (len < 6 || data[0] != 0x10 || data[1] != 0x16) {
+        return 0;
+    }
+    for (size_t i = 2; i + 1 < len; i++) {
+        if (data[i] != 0x10) {
+            continue;
+        }
+        if (data[i + 1] == 0x03) {
+            return i + 4 <= len ? i + 4 : 0;
+        }
+        i++;  // DLE DLE
+    }
+    return 0;
+}
+
+size_t EpdiFrame::sync(const uint8_t* data, size_t len, size_t from)
+{
+    for (size_t i = from; i + 1 < len; i++) {
+        if (data[i] != 0x10) {
+            continue;
+        }
+        if (data[i + 1] == 0x16) {
+            return i;
+        }
+        i++;  // DLE DLE or DLE ETX: the second byte is not a frame start
+    }
+    return len;
+}
@@ -1,4 +1,5 @@
 #include "common/helpers.hpp"
+#include "common/messages.hpp"
 #include <iomanip>
 #include <sstream>
 
@@ -62,36 +63,29 @@ std::optional<CardInfo> parseCardInfo(const std::vector<uint8_t>& frame)
         payload.push_back(byte);
     }
 
-    if (payload.size() < 6) {
+    auto reply = obu::CardReplySchema::decode(payload);
+    if (!reply.ok()) {
         return std::nullopt;
     }
+    const auto& card = reply.value();
 
     CardInfo info;
-    size_t pos = 0;
-    info.destAddr = payload[pos++];
-    info.service = payload[pos++];
-    info.counter = payload[pos++];
-    info.sourceAddr = payload[pos++];
-    info.ack = payload[pos++];
-
-    if (payload.size() - pos < 13) {
-        return std::nullopt;
-    }
-
-    info.atqa = static_cast<uint16_t>((static_cast<uint16_t>(payload[pos]) << 8) | payload[pos + 1]);
-    pos += 2;
-    info.ct = payload[pos++];
-
-    std::vector<uint8_t> uid;
-    uid.insert(uid.end(), payload.begin() + pos, payload.begin() + pos + 3);
-    pos += 3;
-    info.bcc1 = payload[pos++];
-    uid.insert(uid.end(), payload.begin() + pos, payload.begin() + pos + 4);
-    pos += 4;
-    info.bcc2 = payload[pos++];
-    info.sak = payload[pos++];
+    info.destAddr = card.dest;
+    info.service = card.service;
+    info.counter = card.counter;
+    info.sourceAddr = card.source;
+    info.ack = card.ack;
+    info.atqa = card.atqa;
+    info.ct = card.ct;
+    info.bcc1 = card.bcc1;
+    info.bcc2 = card.bcc2;
+    info.sak = card.sak;
+
+    std::vector<uint8_t> uid(card.uid_cl1.begin(), card.uid_cl1.end());
+    uid.insert(uid.end(), card.uid_cl2.begin(), card.uid_cl2.end());
     info.uidHex = bytesToHex(uid);
 
+    size_t pos = obu::CardReplySchema::size;
     if (payload.size() > pos) {
         info.extraBytes.assign(payload.begin() + pos, payload.end());
     }
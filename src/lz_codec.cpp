@@ -0,0 +1,145 @@
+#include "common/lz_codec.hpp"
+#include <cstring>
+
+namespace {
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t LAST_LITERALS = 5;
+    constexpr size_t MAX_OFFSET = 0xFFFF;
+    constexpr int HASH_BITS = 12;
+
+    uint32_t read32(const uint8_t* p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t hash4(const uint8_t* p)
+    {
+        return (read32(p) * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    void put_length(std::vector<uint8_t>& out, size_t len)
+    {
+        while (len >= 255) {
+            out.push_back(255);
+            len -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(len));
+    }
+
+    void put_sequence(std::vector<uint8_t>& out, const uint8_t* lit, size_t lit_len,
+                      size_t match_len, size_t offset)
+    {
+        uint8_t token = static_cast<uint8_t>((lit_len < 15 ? lit_len : 15) << 4);
+        if (match_len) {
+            size_t m = match_len - MIN_MATCH;
+            token |= static_cast<uint8_t>(m < 15 ? m : 15);
+        }
+        out.push_back(token);
+        if (lit_len >= 15) put_length(out, lit_len - 15);
+        out.insert(out.end(), lit, lit + lit_len);
+
+        if (!match_len) return;
+        out.push_back(static_cast<uint8_t>(offset & 0xFF));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match_len - MIN_MATCH >= 15) put_length(out, match_len - MIN_MATCH - 15);
+    }
+
+    bool get_length(const uint8_t*& ip, const uint8_t* end, size_t& len)
+    {
+        uint8_t b;
+        do {
+            if (ip >= end) return false;
+            b = *ip++;
+            len += b;
+        } while (b == 255);
+        return true;
+    }
+}
+
+void LzCodec::compress(const uint8_t* data, size_t len, std::vector<uint8_t>& out)
+{
+    out.reserve(out.size() + len + len / 255 + 16);
+
+    size_t anchor = 0;
+    if (len > MIN_MATCH + LAST_LITERALS) {
+        uint32_t table[1 << HASH_BITS];
+        std::memset(table, 0, sizeof(table));
+
+        const size_t match_limit = len - LAST_LITERALS;
+        size_t ip = 1;
+        while (ip + MIN_MATCH <= match_limit) {
+            uint32_t h = hash4(data + ip);
+            size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+
+            if (ref >= ip || ip - ref > MAX_OFFSET || read32(data + ref) != read32(data + ip)) {
+                ip++;
+                continue;
+            }
+
+            size_t match_len = MIN_MATCH;
+            while (ip + match_len < match_limit && data[ref + match_len] == data[ip + match_len]) {
+                match_len++;
+            }
+
+            put_sequence(out, data + anchor, ip - anchor, match_len, ip - ref);
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    put_sequence(out, data + anchor, len - anchor, 0, 0);
+}
+
+Result<std::vector<uint8_t>> LzCodec::decompress(const uint8_t* data, size_t len, size_t raw_len)
+{
+    std::vector<uint8_t> out;
+    out.reserve(raw_len);
+
+    const uint8_t* ip = data;
+    const uint8_t* end = data + len;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !get_length(ip, end, lit_len)) {
+            return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+        }
+        if (static_cast<size_t>(end - ip) < lit_len || out.size() + lit_len > raw_len) {
+            return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+        }
+        out.insert(out.end(), ip, ip + lit_len);
+        ip += lit_len;
+
+        if (ip == end) break;  // last sequence carries literals only
+
+        if (end - ip < 2) {
+            return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        size_t match_len = token & 0x0F;
+        if (match_len == 15 && !get_length(ip, end, match_len)) {
+            return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+        }
+        match_len += MIN_MATCH;
+
+        if (offset == 0 || offset > out.size() || out.size() + match_len > raw_len) {
+            return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+        }
+        // Byte-wise copy: matches may overlap their own output.
+        size_t from = out.size() - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            out.push_back(out[from + i]);
+        }
+    }
+
+    if (out.size() != raw_len) {
+        return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+    }
+    return Result<std::vector<uint8_t>>::success(std::move(out));
+}
@@ -1,10 +1,16 @@
 #include "devices/mboard.hpp"
 #include "transport/epdi.hpp"
 #include "common/protocol.hpp"
+#include "common/messages.hpp"
+#include <algorithm>
 
 
 
-Mboard::Mboard(SerialPort& serial) : serial_(serial) {}
+Mboard::Mboard(SerialPort& serial)
+    : serial_(serial),
+      rtt_(Protocol::MBOARD_TIMEOUT_MS, Protocol::MIN_RESPONSE_TIMEOUT_MS, Protocol::MAX_RESPONSE_TIMEOUT_MS)
+{
+}
 
 Result<AliveResponse>Mboard::alive()
 {
@@ -13,19 +19,12 @@ Result<AliveResponse>Mboard::alive()
         return Result<AliveResponse>::failure(result.error());
     }
     
-    auto& payload = result.value();
-    if (payload.size() < 17) {
-        return Result<AliveResponse>::failure(Error::INVALID_RESPONSE);
+    auto response = obu::AliveSchema::decode(result.value(), obu::MBOARD_REPLY_HEADER);
+    if (response.ok() && status_) {
+        status_->publish_mboard(response.value());
     }
     
-    AliveResponse response;
-    response.status = (payload[5] << 8) | payload[6];
-    response.hw_version = (payload[7] << 8) | payload[8];
-    response.sw_version = (payload[9] << 8) | payload[10];
-    response.bootloader_version = (payload[11] << 8) | payload[12];
-    response.uptime_seconds = (payload[13] << 24) | (payload[14] << 16) | (payload[15] << 8) | payload[16];
-    
-    return Result<AliveResponse>::success(response);
+    return response;
 
 }
 
@@ -44,23 +43,75 @@ Result<std::vector<uint8_t>> Mboard::send_command(uint8_t service, const uint8_t
     
     std::vector<uint8_t> frame = EpdiFrame::encode(cmd.data(), cmd.size());
     
-    auto write_result = serial_.write(frame.data(), frame.size());
-    if (!write_result.ok()) {
-        return Result<std::vector<uint8_t>>::failure(write_result.error());
-    }
+    // Only a reply echoing [0x72][service][counter] is ours; a late answer to
+    // an earlier command or retransmit is skipped and the read goes on. The
+    // buffer may start with the tail of a frame cut off earlier, so frames
+    // are found by their DLE SYNC. transact() calls this as bytes arrive; a
+    // bad CRC is counted once, when the frame's last byte is the newest.
+    const uint8_t expect[4] = {Protocol::Mboard::RESPONSE, service, cmd[2], cmd[3]};
+    std::vector<uint8_t> reply;
+    auto matches = [&](const std::vector<unsigned char>& rx) {
+        size_t at = EpdiFrame::sync(rx.data(), rx.size());
+        while (size_t n = EpdiFrame::complete_length(rx.data() + at, rx.size() - at)) {
+            auto payload = EpdiFrame::decode(rx.data() + at, n);
+            bool newest = at + n == rx.size();
+            at = EpdiFrame::sync(rx.data(), rx.size(), at + n);
+            if (!payload.ok()) {
+                if (payload.error() == Error::CRC_MISSMATCH && newest) {
+                    serial_.count_crc_error();
+                }
+                continue;
+            }
+            if (payload.value().size() >= sizeof(expect) &&
+                std::equal(expect, expect + sizeof(expect), payload.value().begin())) {
+                reply = payload.value();
+                return true;
+            }
+        }
+        return false;
+    };
     
-    bool running = true;
-    auto read_result = serial_.read(running);
+    auto start = std::chrono::steady_clock::now();
+    auto read_result = serial_.transact(frame.data(), frame.size(), [](const std::vector<unsigned char>& rx) {
+        size_t at = EpdiFrame::sync(rx.data(), rx.size());
+        return EpdiFrame::complete_length(rx.data() + at, rx.size() - at) > 0;
+    }, rtt_, retry_, matches);
+    latency_.observe(service, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
     if (!read_result.ok()) {
         return Result<std::vector<uint8_t>>::failure(read_result.error());
     }
-    
-    return EpdiFrame::decode(read_result.value().data(), read_result.value().size());
+    return Result<std::vector<uint8_t>>::success(std::move(reply));
+}
+
+void Mboard::register_metrics(obu::MetricsRegistry& registry, const std::string& name) const
+{
+    registry.histogram("obu_command_duration_seconds", "Request to reply time per command, retries included.",
+                       {{"device", name}}, latency_);
+}
+
+// The board answers with the last NMEA sentence after the reply header.
+Result<GpsData> Mboard::gps()
+{
+    auto result = send_command(Protocol::Service::GPS);
+    if (!result.ok()) {
+        return Result<GpsData>::failure(result.error());
+    }
+
+    auto& payload = result.value();
+    if (payload.size() < obu::MBOARD_REPLY_HEADER) {
+        return Result<GpsData>::failure(Error::INVALID_RESPONSE);
+    }
+
+    GpsData gps;
+    gps.nmea.assign(payload.begin() + obu::MBOARD_REPLY_HEADER, payload.end());
+    return Result<GpsData>::success(std::move(gps));
 }
 
 Result<std::vector<uint8_t>> Mboard::read_registers(uint8_t start_reg, uint8_t count)
 {
-    uint8_t data[] = { start_reg, count };
+    uint8_t data[obu::RegisterSpanSchema::size];
+    obu::RegisterSpanSchema::encode_into(obu::RegisterSpan{start_reg, count}, data);
     
     auto result = send_command(Protocol::Service::READ_REGISTERS, data, sizeof(data));
     if (!result.ok()) {
@@ -68,10 +119,31 @@ Result<std::vector<uint8_t>> Mboard::read_registers(uint8_t start_reg, uint8_t c
     }
     
     auto& payload = result.value();
-    if (payload.size() < 5) {
+    if (payload.size() < obu::MBOARD_REPLY_HEADER) {
         return Result<std::vector<uint8_t>>::failure(Error::INVALID_RESPONSE);
     }
     
-    std::vector<uint8_t> registers(payload.begin() + 5, payload.end());
+    std::vector<uint8_t> registers(payload.begin() + obu::MBOARD_REPLY_HEADER, payload.end());
     return Result<std::vector<uint8_t>>::success(std::move(registers));
-}
\ No newline at end of file
+}
+
+Result<bool> Mboard::write_registers(uint8_t start_reg, const std::vector<uint8_t>& values)
+{
+    if (values.empty() || values.size() > 255) {
+        return Result<bool>::failure(Error::CMD_FAILURE);
+    }
+
+    std::vector<uint8_t> data;
+    data.reserve(obu::RegisterSpanSchema::size + values.size());
+    obu::RegisterSpanSchema::append(data, obu::RegisterSpan{start_reg, static_cast<uint8_t>(values.size())});
+    data.insert(data.end(), values.begin(), values.end());
+
+    auto result = send_command(Protocol::Service::WRITE_REGISTERS, data.data(), data.size());
+    if (!result.ok()) {
+        return Result<bool>::failure(result.error());
+    }
+    if (result.value().size() < obu::MBOARD_REPLY_HEADER) {
+        return Result<bool>::failure(Error::INVALID_RESPONSE);
+    }
+    return Result<bool>::success(true);
+}
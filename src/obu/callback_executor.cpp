@@ -0,0 +1,270 @@
+#include "obu/common/callback_executor.hpp"
+#include <algorithm>
+
+namespace obu {
+
+CallbackExecutor::CallbackExecutor() : CallbackExecutor(Options()) {}
+
+CallbackExecutor::CallbackExecutor(Options options) : options_(std::move(options))
+{
+    size_t capacity = 2;
+    while (capacity < options_.capacity) {
+        capacity <<= 1;
+    }
+    cells_.reset(new Cell[capacity]);
+    for (size_t i = 0; i < capacity; i++) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask_ = capacity - 1;
+}
+
+CallbackExecutor::~CallbackExecutor()
+{
+    stop();
+    delete parked_.exchange(nullptr);
+}
+
+Result<bool> CallbackExecutor::start()
+{
+    if (running_.exchange(true)) {
+        return Result<bool>::success(true);
+    }
+    accepting_.store(true);
+
+    for (int i = 0; i < std::max(1, options_.threads); i++) {
+        workers_.emplace_back(new DeviceThread());
+        auto started = workers_.back()->start(options_.thread, [this] { run(); });
+        if (!started.ok()) {
+            stop();
+            return started;
+        }
+    }
+    return Result<bool>::success(true);
+}
+
+void CallbackExecutor::stop()
+{
+    if (!running_.load()) {
+        return;
+    }
+    accepting_.store(false);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        running_.store(false);
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker->join();
+    }
+    workers_.clear();
+
+    // Posts that raced with stop().
+    Task task;
+    Clock::time_point posted;
+    while (take(task, posted)) {
+        dropped_stopped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Bounded MPMC ring after D. Vyukov: each cell's sequence says whether it is
+// free for the producer at `pos` (== pos) or holds data for the consumer at
+// `pos` (== pos + 1), so producers and consumers only contend on their own index.
+bool CallbackExecutor::try_push(Task& task, Clock::time_point posted)
+{
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // full
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    cell->task = std::move(task);
+    cell->posted = posted;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool CallbackExecutor::try_pop(Task& task, Clock::time_point& posted)
+{
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // empty
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    task = std::move(cell->task);
+    cell->task = nullptr;
+    posted = cell->posted;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+// Ring first, then the coalesced overflow task: post() parks every task
+// that arrives while one is parked, so it is always the newest.
+bool CallbackExecutor::take(Task& task, Clock::time_point& posted)
+{
+    if (try_pop(task, posted)) {
+        return true;
+    }
+    if (parked_.load(std::memory_order_relaxed)) {
+        std::unique_ptr<Parked> parked(parked_.exchange(nullptr, std::memory_order_acquire));
+        if (parked) {
+            task = std::move(parked->task);
+            posted = parked->posted;
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t CallbackExecutor::depth() const
+{
+    // Dequeue first: it never passes an enqueue position loaded after it, so
+    // a pop in between cannot wrap the difference.
+    size_t head = dequeue_pos_.load(std::memory_order_acquire);
+    size_t queued = enqueue_pos_.load(std::memory_order_acquire) - head;
+    return queued + (parked_.load(std::memory_order_relaxed) ? 1 : 0);
+}
+
+bool CallbackExecutor::post(Task task)
+{
+    if (!accepting_.load(std::memory_order_relaxed)) {
+        dropped_stopped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto now = Clock::now();
+    // While a task is parked every newer one replaces it rather than joining
+    // the ring, where it would run before the older parked task.
+    bool coalesce = options_.overflow == OverflowPolicy::COALESCE && parked_.load(std::memory_order_acquire);
+    if (coalesce || !try_push(task, now)) {
+        switch (options_.overflow) {
+            case OverflowPolicy::DROP_OLDEST: {
+                Task oldest;
+                Clock::time_point posted;
+                do {
+                    if (try_pop(oldest, posted)) {
+                        dropped_overflow_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                } while (!try_push(task, now));
+                break;
+            }
+
+            case OverflowPolicy::BLOCK: {
+                blocked_.fetch_add(1, std::memory_order_relaxed);
+                blocked_posters_.fetch_add(1);
+                bool queued;
+                {
+                    std::unique_lock<std::mutex> lock(sleep_mutex_);
+                    while (!(queued = try_push(task, now)) && accepting_.load()) {
+                        not_full_.wait(lock);
+                    }
+                }
+                blocked_posters_.fetch_sub(1);
+                if (!queued) {
+                    dropped_stopped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                break;
+            }
+
+            case OverflowPolicy::COALESCE: {
+                std::unique_ptr<Parked> previous(parked_.exchange(new Parked{std::move(task), now},
+                                                                  std::memory_order_acq_rel));
+                if (previous) {
+                    dropped_coalesced_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+        }
+    }
+
+    // Pairs with the increment in run(): either the worker sees the task
+    // before sleeping, or we see it idle and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idle_workers_.load(std::memory_order_relaxed) > 0) {
+        wake_worker();
+    }
+    return true;
+}
+
+void CallbackExecutor::wake_worker()
+{
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    not_empty_.notify_one();
+}
+
+void CallbackExecutor::run()
+{
+    Task task;
+    Clock::time_point posted;
+    for (;;) {
+        if (take(task, posted)) {
+            run_delay_.observe(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - posted));
+            task();
+            task = nullptr;
+            completed_.fetch_add(1, std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (blocked_posters_.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                not_full_.notify_all();
+            }
+            continue;
+        }
+        if (!running_.load()) {
+            break;
+        }
+
+        idle_workers_.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            not_empty_.wait(lock, [this] { return !running_.load() || depth() > 0; });
+        }
+        idle_workers_.fetch_sub(1);
+    }
+}
+
+void CallbackExecutor::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    registry.gauge("obu_callback_queue_depth", "Callbacks waiting to run.", {{"executor", name}},
+                   [this] { return static_cast<double>(depth()); });
+    registry.histogram("obu_callback_delay_seconds", "Time from post to the callback starting.",
+                       {{"executor", name}}, run_delay_);
+    registry.counter("obu_callback_runs_total", "Callbacks run.", {{"executor", name}},
+                     [this] { return static_cast<double>(completed_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_callback_blocked_total", "Posts that waited for space.", {{"executor", name}},
+                     [this] { return static_cast<double>(blocked_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_callback_dropped_total", "Callbacks not run, by reason.",
+                     {{"executor", name}, {"reason", "overflow"}},
+                     [this] { return static_cast<double>(dropped_overflow_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_callback_dropped_total", "Callbacks not run, by reason.",
+                     {{"executor", name}, {"reason", "coalesced"}},
+                     [this] { return static_cast<double>(dropped_coalesced_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_callback_dropped_total", "Callbacks not run, by reason.",
+                     {{"executor", name}, {"reason", "stopped"}},
+                     [this] { return static_cast<double>(dropped_stopped_.load(std::memory_order_relaxed)); });
+}
+
+} // namespace obu
@@ -0,0 +1,37 @@
+#include "obu/common/cancellation.hpp"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstdint>
+
+namespace obu {
+
+CancellationToken::CancellationToken()
+{
+    fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+CancellationToken::~CancellationToken()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void CancellationToken::cancel()
+{
+    // Only the first cancel() signals, so the counter never overflows.
+    if (!cancelled_.exchange(true, std::memory_order_acq_rel) && fd_ >= 0) {
+        uint64_t one = 1;
+        (void)::write(fd_, &one, sizeof(one));
+    }
+}
+
+void CancellationToken::reset()
+{
+    if (cancelled_.exchange(false, std::memory_order_acq_rel) && fd_ >= 0) {
+        uint64_t v;
+        (void)::read(fd_, &v, sizeof(v));
+    }
+}
+
+} // namespace obu
@@ -0,0 +1,196 @@
+#include "obu/common/command_scheduler.hpp"
+#include <vector>
+#include <algorithm>
+
+namespace obu {
+
+const char* command_class_name(CommandClass cls)
+{
+    switch (cls) {
+        case CommandClass::FEEDBACK: return "feedback";
+        case CommandClass::VALIDATION: return "validation";
+        case CommandClass::TELEMETRY: return "telemetry";
+    }
+    return "unknown";
+}
+
+CommandScheduler::CommandScheduler() : CommandScheduler(Options()) {}
+
+CommandScheduler::CommandScheduler(Options options) : options_(options) {}
+
+CommandScheduler::~CommandScheduler()
+{
+    stop();
+}
+
+Result<bool> CommandScheduler::start(const ThreadOptions& thread)
+{
+    if (running_.exchange(true)) {
+        return Result<bool>::success(true);
+    }
+    auto started = thread_.start(thread, [this] { run(); });
+    if (!started.ok()) {
+        running_.store(false);
+    }
+    return started;
+}
+
+void CommandScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.exchange(false)) {
+            return;
+        }
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    std::vector<Entry> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t c = 0; c < COMMAND_CLASSES; c++) {
+            for (auto& entry : queues_[c]) dropped.push_back(std::move(entry));
+            queues_[c].clear();
+            stats_[c].depth.store(0, std::memory_order_relaxed);
+        }
+        queued_ = 0;
+    }
+    for (auto& entry : dropped) {
+        if (entry.drop) entry.drop(Error::CMD_FAILURE);
+    }
+}
+
+bool CommandScheduler::submit(CommandClass cls, Job run, Drop drop, uint64_t key)
+{
+    size_t c = index(cls);
+    Entry entry{std::move(run), std::move(drop), key, Clock::now()};
+    Drop victim;
+    bool accepted = true;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load()) {
+            stats_[c].rejected.fetch_add(1, std::memory_order_relaxed);
+            victim = std::move(entry.drop);
+            accepted = false;
+        } else {
+            auto& queue = queues_[c];
+            auto same = queue.end();
+            if (key != 0) {
+                same = std::find_if(queue.begin(), queue.end(), [key](const Entry& e) { return e.key == key; });
+            }
+
+            if (same != queue.end()) {
+                // Keeps its place and its enqueue time, so aging still counts from the first request.
+                victim = std::move(same->drop);
+                same->run = std::move(entry.run);
+                same->drop = std::move(entry.drop);
+                stats_[c].superseded.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                if (queued_ >= options_.capacity) {
+                    size_t lower = COMMAND_CLASSES;
+                    for (size_t l = COMMAND_CLASSES - 1; l > c; l--) {
+                        if (!queues_[l].empty()) {
+                            lower = l;
+                            break;
+                        }
+                    }
+                    if (lower == COMMAND_CLASSES) {
+                        stats_[c].rejected.fetch_add(1, std::memory_order_relaxed);
+                        victim = std::move(entry.drop);
+                        accepted = false;
+                    } else {
+                        victim = std::move(queues_[lower].back().drop);
+                        queues_[lower].pop_back();
+                        queued_--;
+                        stats_[lower].depth.fetch_sub(1, std::memory_order_relaxed);
+                        stats_[lower].preempted.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                if (accepted) {
+                    queue.push_back(std::move(entry));
+                    queued_++;
+                    stats_[c].depth.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    if (victim) victim(Error::CMD_FAILURE);
+    cv_.notify_one();
+    return accepted;
+}
+
+size_t CommandScheduler::pick(Clock::time_point now)
+{
+    // Oldest head past its class's max_wait goes first, even ahead of higher classes.
+    size_t aged = COMMAND_CLASSES;
+    for (size_t c = 0; c < COMMAND_CLASSES; c++) {
+        if (queues_[c].empty() || options_.max_wait[c].count() == 0) continue;
+        if (now - queues_[c].front().enqueued < options_.max_wait[c]) continue;
+        if (aged == COMMAND_CLASSES || queues_[c].front().enqueued < queues_[aged].front().enqueued) {
+            aged = c;
+        }
+    }
+
+    size_t highest = 0;
+    while (queues_[highest].empty()) highest++;
+
+    if (aged != COMMAND_CLASSES && aged != highest) {
+        stats_[aged].aged.fetch_add(1, std::memory_order_relaxed);
+        return aged;
+    }
+    return highest;
+}
+
+void CommandScheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_.load()) {
+        cv_.wait(lock, [this] { return !running_.load() || queued_ > 0; });
+        if (!running_.load()) break;
+
+        auto now = Clock::now();
+        size_t c = pick(now);
+        Entry entry = std::move(queues_[c].front());
+        queues_[c].pop_front();
+        queued_--;
+        stats_[c].depth.fetch_sub(1, std::memory_order_relaxed);
+        lock.unlock();
+
+        stats_[c].queue_delay.observe(std::chrono::duration_cast<std::chrono::microseconds>(now - entry.enqueued));
+        entry.run();
+        stats_[c].completed.fetch_add(1, std::memory_order_relaxed);
+
+        lock.lock();
+    }
+}
+
+void CommandScheduler::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    for (size_t c = 0; c < COMMAND_CLASSES; c++) {
+        const ClassStats* s = &stats_[c];
+        std::string cls = command_class_name(static_cast<CommandClass>(c));
+        registry.histogram("obu_scheduler_queue_delay_seconds", "Time a bus command waited in the scheduler queue.",
+                           {{"bus", name}, {"class", cls}}, s->queue_delay);
+        registry.gauge("obu_scheduler_queue_depth", "Commands queued on the bus.", {{"bus", name}, {"class", cls}},
+                       [s] { return static_cast<double>(s->depth.load(std::memory_order_relaxed)); });
+        registry.counter("obu_scheduler_commands_total", "Commands run on the bus.", {{"bus", name}, {"class", cls}},
+                         [s] { return static_cast<double>(s->completed.load(std::memory_order_relaxed)); });
+        registry.counter("obu_scheduler_aged_total", "Commands run ahead of higher classes after max_wait.",
+                         {{"bus", name}, {"class", cls}},
+                         [s] { return static_cast<double>(s->aged.load(std::memory_order_relaxed)); });
+        registry.counter("obu_scheduler_dropped_total", "Commands not run, by reason.",
+                         {{"bus", name}, {"class", cls}, {"reason", "rejected"}},
+                         [s] { return static_cast<double>(s->rejected.load(std::memory_order_relaxed)); });
+        registry.counter("obu_scheduler_dropped_total", "Commands not run, by reason.",
+                         {{"bus", name}, {"class", cls}, {"reason", "preempted"}},
+                         [s] { return static_cast<double>(s->preempted.load(std::memory_order_relaxed)); });
+        registry.counter("obu_scheduler_dropped_total", "Commands not run, by reason.",
+                         {{"bus", name}, {"class", cls}, {"reason", "superseded"}},
+                         [s] { return static_cast<double>(s->superseded.load(std::memory_order_relaxed)); });
+    }
+}
+
+} // namespace obu
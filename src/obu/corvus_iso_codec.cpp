@@ -0,0 +1,94 @@
+#include "obu/devices/corvus_iso_codec.hpp"
+#include <algorithm>
+
+namespace obu {
+namespace corvus {
+
+namespace {
+
+constexpr std::string_view MSG_TYPE_LOGON_RESP = "0110";
+constexpr std::string_view MSG_TYPE_ADMIN_RESP = "0210";
+
+constexpr std::string_view FIELD_UID = "63";
+constexpr std::string_view FIELD_TRACK2 = "35";
+
+// Value of the FS-separated field with the given 2-digit id, or empty
+std::string_view find_field(std::string_view msg, std::string_view id)
+{
+    size_t pos = msg.find(ISO_FS);
+    while (pos != std::string_view::npos) {
+        size_t start = pos + 1;
+        size_t end = msg.find(ISO_FS, start);
+        std::string_view field = msg.substr(start, end == std::string_view::npos ? end : end - start);
+        if (field.substr(0, 2) == id) {
+            return field.substr(2);
+        }
+        pos = end;
+    }
+    return {};
+}
+
+} // anonymous namespace
+
+int iso_message_sequence(std::string_view msg)
+{
+    if (msg.size() < 14) return -1;
+    int seq = 0;
+    for (size_t i = 10; i < 14; ++i) {
+        if (msg[i] < '0' || msg[i] > '9') return -1;
+        seq = seq * 10 + (msg[i] - '0');
+    }
+    return seq;
+}
+
+Result<Reply> IsoCodec::decode(std::string_view msg, Command command)
+{
+    std::string_view type = command == Command::LOGON ? MSG_TYPE_LOGON_RESP : MSG_TYPE_ADMIN_RESP;
+    if (msg.size() < 14 || msg.substr(0, 4) != type) {
+        return Result<Reply>::failure(Error::PARSE_ERROR);
+    }
+
+    Reply reply;
+    if (command == Command::READ_UID) {
+        reply.data = find_field(msg, FIELD_UID);
+    } else if (command == Command::READ_CARD) {
+        reply.data = find_field(msg, FIELD_TRACK2);
+    }
+    return Result<Reply>::success(reply);
+}
+
+Result<bool> IsoFrameBuffer::next(std::vector<uint8_t>& msg)
+{
+    auto stx = std::find(buffer_.begin(), buffer_.end(), ISO_STX);
+    buffer_.erase(buffer_.begin(), stx);
+    if (buffer_.empty()) {
+        return Result<bool>::success(false);
+    }
+
+    auto etx = std::find(buffer_.begin() + 1, buffer_.end(), ISO_ETX);
+    if (etx == buffer_.end()) {
+        if (buffer_.size() > MAX_MESSAGE_LEN + 3u) {
+            buffer_.clear();
+            return Result<bool>::failure(Error::PARSE_ERROR);
+        }
+        return Result<bool>::success(false);
+    }
+    if (etx + 1 == buffer_.end()) {
+        return Result<bool>::success(false);     // LRC not here yet
+    }
+
+    size_t len = etx - buffer_.begin() - 1;
+    uint8_t lrc = *(etx + 1);
+    bool valid = iso_lrc(buffer_.data() + 1, len) == lrc;
+    if (valid) {
+        msg.assign(buffer_.begin() + 1, etx);
+    }
+    buffer_.erase(buffer_.begin(), etx + 2);
+    if (!valid) {
+        return Result<bool>::failure(Error::CRC_MISSMATCH);
+    }
+    return Result<bool>::success(true);
+}
+
+} // namespace corvus
+} // namespace obu
@@ -1,155 +1,69 @@
 #include "obu/devices/corvus_nfc_reader.hpp"
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <cstring>
-#include <sstream>
-#include <iomanip>
+#include <cerrno>
 #include <chrono>
-#include <thread>
 
 namespace obu {
 
 namespace {
 
-class SHA1 {
+// Marks a read as running for its duration unless an outer loop
+// (start_reading) already owns the flag.
+class RunScope {
 public:
-    SHA1() { reset(); }
-    
-    void update(const uint8_t* data, size_t len) {
-        for (size_t i = 0; i < len; ++i) {
-            buffer_[bufferLen_++] = data[i];
-            if (bufferLen_ == 64) {
-                processBlock();
-                totalLen_ += 512;
-                bufferLen_ = 0;
-            }
-        }
+    RunScope(std::atomic<bool>& flag, CancellationToken& cancel) : flag_(flag)
+    {
+        // Discards a stop request left over from a previous run.
+        if (!flag.load()) cancel.reset();
+        owner_ = !flag.exchange(true);
     }
-    
-    void final(uint8_t* digest) {
-        totalLen_ += bufferLen_ * 8;
-        buffer_[bufferLen_++] = 0x80;
-        
-        if (bufferLen_ > 56) {
-            while (bufferLen_ < 64) buffer_[bufferLen_++] = 0;
-            processBlock();
-            bufferLen_ = 0;
-        }
-        
-        while (bufferLen_ < 56) buffer_[bufferLen_++] = 0;
-        
-        for (int i = 7; i >= 0; --i) {
-            buffer_[bufferLen_++] = (totalLen_ >> (i * 8)) & 0xFF;
-        }
-        processBlock();
-        
-        for (int i = 0; i < 5; ++i) {
-            digest[i * 4 + 0] = (h_[i] >> 24) & 0xFF;
-            digest[i * 4 + 1] = (h_[i] >> 16) & 0xFF;
-            digest[i * 4 + 2] = (h_[i] >> 8) & 0xFF;
-            digest[i * 4 + 3] = h_[i] & 0xFF;
-        }
-    }
-    
+    ~RunScope() { if (owner_) flag_.store(false); }
 private:
-    void reset() {
-        h_[0] = 0x67452301;
-        h_[1] = 0xEFCDAB89;
-        h_[2] = 0x98BADCFE;
-        h_[3] = 0x10325476;
-        h_[4] = 0xC3D2E1F0;
-        bufferLen_ = 0;
-        totalLen_ = 0;
-    }
-    
-    void processBlock() {
-        uint32_t w[80];
-        for (int i = 0; i < 16; ++i) {
-            w[i] = (buffer_[i * 4] << 24) | (buffer_[i * 4 + 1] << 16) |
-                   (buffer_[i * 4 + 2] << 8) | buffer_[i * 4 + 3];
-        }
-        for (int i = 16; i < 80; ++i) {
-            w[i] = rotl(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
-        }
-        
-        uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4];
-        
-        for (int i = 0; i < 80; ++i) {
-            uint32_t f, k;
-            if (i < 20) { f = (b & c) | ((~b) & d); k = 0x5A827999; }
-            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
-            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
-            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
-            
-            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
-            e = d; d = c; c = rotl(b, 30); b = a; a = temp;
-        }
-        
-        h_[0] += a; h_[1] += b; h_[2] += c; h_[3] += d; h_[4] += e;
-    }
-    
-    static uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
-    
-    uint32_t h_[5];
-    uint8_t buffer_[64];
-    size_t bufferLen_;
-    uint64_t totalLen_;
+    std::atomic<bool>& flag_;
+    bool owner_;
 };
 
-// Convert password to SHA1 hash (password padded to 9 bytes with zeros)
-std::string sha1_hex(const std::string& password) {
-    uint8_t padded[9] = {0};
-    size_t len = std::min(password.size(), size_t(9));
-    memcpy(padded, password.c_str(), len);
-    
-    SHA1 sha;
-    sha.update(padded, 9);
-    
-    uint8_t hash[20];
-    sha.final(hash);
-    
-    std::ostringstream oss;
-    oss << std::uppercase << std::hex << std::setfill('0');
-    for (int i = 0; i < 20; ++i) {
-        oss << std::setw(2) << static_cast<int>(hash[i]);
-    }
-    return oss.str();
-}
-
-// Set socket to non-blocking mode
-bool set_nonblocking(int fd, bool nonblocking) {
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags < 0) return false;
-    if (nonblocking) {
-        flags |= O_NONBLOCK;
-    } else {
-        flags &= ~O_NONBLOCK;
-    }
-    return fcntl(fd, F_SETFL, flags) >= 0;
-}
-
 } // anonymous namespace
 
-CorvusNfcReader::CorvusNfcReader(const char* host, int port)
-    : host_(host), port_(port) {}
+template <typename Codec>
+BasicCorvusReader<Codec>::BasicCorvusReader(const char* host, int port)
+    : host_(host), port_(port), credential_(Codec::credential("23646"))
+{
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+}
 
-CorvusNfcReader::~CorvusNfcReader()
+template <typename Codec>
+BasicCorvusReader<Codec>::~BasicCorvusReader()
 {
     stop_reading();
     disconnect();
+    ::close(timer_fd_);
+}
+
+template <typename Codec>
+void BasicCorvusReader<Codec>::stop_reading()
+{
+    running_.store(false);
+    cancel_.cancel();
 }
 
-uint16_t CorvusNfcReader::next_counter()
+template <typename Codec>
+uint16_t BasicCorvusReader<Codec>::next_counter()
 {
     counter_ = (counter_ + 1) % 10000;
     return counter_;
 }
 
-Result<bool> CorvusNfcReader::connect()
+template <typename Codec>
+Result<bool> BasicCorvusReader<Codec>::connect()
 {
     if (socket_fd_ >= 0) {
         return Result<bool>::success(true);
@@ -180,34 +94,40 @@ Result<bool> CorvusNfcReader::connect()
         return Result<bool>::failure(Error::PORT_ERROR);
     }
     
+    // Requests and keepalives are tiny; send them without Nagle delay.
+    int one = 1;
+    setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    
+    session_state_ = SessionState::CONNECTED;
     return Result<bool>::success(true);
 }
 
-void CorvusNfcReader::disconnect()
+template <typename Codec>
+void BasicCorvusReader<Codec>::disconnect()
 {
     if (socket_fd_ >= 0) {
         ::close(socket_fd_);
         socket_fd_ = -1;
     }
+    rx_.clear();
+    session_state_ = SessionState::DISCONNECTED;
 }
 
-// Send message with 2-byte length prefix (big endian)
-Result<bool> CorvusNfcReader::send_message(const std::vector<uint8_t>& msg)
+// Send the request built in tx_ (length prefix already in place)
+template <typename Codec>
+Result<bool> BasicCorvusReader<Codec>::send_message(bool built)
 {
     if (socket_fd_ < 0) {
         last_error_ = "Not connected";
         return Result<bool>::failure(Error::PORT_ERROR);
     }
+    if (!built) {
+        last_error_ = "Message too long";
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
     
-    // Build packet: 2-byte length (big endian) + payload
-    std::vector<uint8_t> packet;
-    uint16_t len = msg.size();
-    packet.push_back((len >> 8) & 0xFF);
-    packet.push_back(len & 0xFF);
-    packet.insert(packet.end(), msg.begin(), msg.end());
-    
-    ssize_t sent = ::send(socket_fd_, packet.data(), packet.size(), 0);
-    if (sent != static_cast<ssize_t>(packet.size())) {
+    ssize_t sent = ::send(socket_fd_, tx_.data(), tx_.size(), MSG_NOSIGNAL);
+    if (sent != static_cast<ssize_t>(tx_.size())) {
         last_error_ = "Send failed";
         return Result<bool>::failure(Error::WRITE_ERROR);
     }
@@ -215,227 +135,223 @@ Result<bool> CorvusNfcReader::send_message(const std::vector<uint8_t>& msg)
     return Result<bool>::success(true);
 }
 
-// Send keepalive (2 zero bytes)
-bool CorvusNfcReader::send_keepalive()
+template <typename Codec>
+bool BasicCorvusReader<Codec>::send_keepalive()
 {
     if (socket_fd_ < 0) return false;
-    uint8_t keepalive[2] = {0, 0};
-    return ::send(socket_fd_, keepalive, 2, MSG_NOSIGNAL) == 2;
+    if constexpr (Codec::HAS_KEEPALIVE) {
+        return ::send(socket_fd_, Codec::KEEPALIVE, sizeof(Codec::KEEPALIVE), MSG_NOSIGNAL) ==
+               static_cast<ssize_t>(sizeof(Codec::KEEPALIVE));
+    }
+    return true;
 }
 
-// Receive message - reads 2-byte length then payload
-Result<std::vector<uint8_t>> CorvusNfcReader::receive_message(int timeout_sec)
+// Appends whatever the socket has ready to the reassembly buffer
+template <typename Codec>
+Result<bool> BasicCorvusReader<Codec>::fill_rx_buffer()
+{
+    uint8_t tmp[1024];
+    ssize_t n = ::recv(socket_fd_, tmp, sizeof(tmp), MSG_DONTWAIT);
+    if (n > 0) {
+        rx_.feed(tmp, n);
+        return Result<bool>::success(true);
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return Result<bool>::success(false);
+    }
+    last_error_ = (n == 0) ? "Connection closed" : "Receive error";
+    return Result<bool>::failure(Error::READ_ERROR);
+}
+
+// Receive the next message, whatever its sequence number
+template <typename Codec>
+Result<std::vector<uint8_t>> BasicCorvusReader<Codec>::receive_message(int timeout_sec)
 {
     if (socket_fd_ < 0) {
         last_error_ = "Not connected";
         return Result<std::vector<uint8_t>>::failure(Error::PORT_ERROR);
     }
     
-    struct pollfd pfd;
-    pfd.fd = socket_fd_;
-    pfd.events = POLLIN;
-    
-    int ret = poll(&pfd, 1, timeout_sec * 1000);
-    if (ret <= 0) {
-        last_error_ = (ret == 0) ? "Timeout" : "Poll error";
-        return Result<std::vector<uint8_t>>::failure(Error::TIMEOUT);
-    }
-    
-    // Read length (2 bytes)
-    uint8_t len_buf[2];
-    ssize_t received = ::recv(socket_fd_, len_buf, 2, 0);
-    if (received != 2) {
-        last_error_ = "Failed to read length";
-        return Result<std::vector<uint8_t>>::failure(Error::READ_ERROR);
-    }
-    
-    uint16_t len = (len_buf[0] << 8) | len_buf[1];
-    if (len == 0 || len > 4096) {
-        last_error_ = "Invalid message length";
-        return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
-    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout_sec);
+    std::vector<uint8_t> msg;
     
-    // Read payload
-    std::vector<uint8_t> buffer(len);
-    received = ::recv(socket_fd_, buffer.data(), len, MSG_WAITALL);
-    if (received != len) {
-        last_error_ = "Failed to read payload";
-        return Result<std::vector<uint8_t>>::failure(Error::READ_ERROR);
+    while (true) {
+        auto taken = rx_.next(msg);
+        if (!taken.ok()) {
+            last_error_ = "Invalid frame";
+            return Result<std::vector<uint8_t>>::failure(taken.error());
+        }
+        if (taken.value()) {
+            return Result<std::vector<uint8_t>>::success(std::move(msg));
+        }
+        
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        struct pollfd pfd = {socket_fd_, POLLIN, 0};
+        int ret = left > 0 ? poll(&pfd, 1, static_cast<int>(left)) : 0;
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            last_error_ = (ret == 0) ? "Timeout" : "Poll error";
+            return Result<std::vector<uint8_t>>::failure(Error::TIMEOUT);
+        }
+        
+        auto filled = fill_rx_buffer();
+        if (!filled.ok()) {
+            return Result<std::vector<uint8_t>>::failure(filled.error());
+        }
     }
-    
-    return Result<std::vector<uint8_t>>::success(std::move(buffer));
 }
 
-// Wait for response with keepalive
-Result<std::vector<uint8_t>> CorvusNfcReader::wait_for_response_with_keepalive(int timeout_sec)
+// Wait for the response to request `seq` with keepalive. Blocks in poll() on
+// the socket, the per-connection keepalive timerfd and the cancellation tokens, so
+// a response is handed back as soon as it arrives. Responses carrying another
+// sequence number (late answers to a cancelled or timed-out request) are dropped.
+template <typename Codec>
+Result<std::vector<uint8_t>> BasicCorvusReader<Codec>::wait_for_response_with_keepalive(int timeout_sec, uint16_t seq)
 {
     if (socket_fd_ < 0) {
         last_error_ = "Not connected";
         return Result<std::vector<uint8_t>>::failure(Error::PORT_ERROR);
     }
     
-    set_nonblocking(socket_fd_, true);
-    
-    auto start = std::chrono::steady_clock::now();
-    auto timeout = std::chrono::seconds(timeout_sec);
-    
-    std::vector<uint8_t> buffer;
-    
-    while (std::chrono::steady_clock::now() - start < timeout) {
-        if (running_.load() == false) {
-            // Cancelled
-            set_nonblocking(socket_fd_, false);
-            last_error_ = "Cancelled";
-            return Result<std::vector<uint8_t>>::failure(Error::TIMEOUT);
+    if constexpr (Codec::HAS_KEEPALIVE) {
+        struct itimerspec its;
+        its.it_interval.tv_sec = 0;
+        its.it_interval.tv_nsec = KEEPALIVE_INTERVAL_MS * 1000000L;
+        its.it_value = its.it_interval;
+        timerfd_settime(timer_fd_, 0, &its, nullptr);
+    }
+    
+    auto disarm = [this]() {
+        struct itimerspec off = {};
+        timerfd_settime(timer_fd_, 0, &off, nullptr);
+    };
+    auto fail = [&](Error error, const char* msg) {
+        disarm();
+        if (msg) last_error_ = msg;
+        return Result<std::vector<uint8_t>>::failure(error);
+    };
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout_sec);
+    std::vector<uint8_t> msg;
+    
+    while (true) {
+        auto taken = rx_.next(msg);
+        if (!taken.ok()) {
+            last_error_ = "Invalid frame";
+            return fail(taken.error(), nullptr);
+        }
+        if (taken.value()) {
+            if (Codec::matches(corvus::as_view(msg), seq)) {
+                disarm();
+                return Result<std::vector<uint8_t>>::success(std::move(msg));
+            }
+            stale_responses_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            return fail(Error::TIMEOUT, "Timeout waiting for response");
         }
         
-        // Try to receive
-        uint8_t tmp[1024];
-        ssize_t n = ::recv(socket_fd_, tmp, sizeof(tmp), 0);
+        struct pollfd pfds[4] = {
+            {socket_fd_, POLLIN, 0},
+            {timer_fd_, POLLIN, 0},
+            {cancel_.fd(), POLLIN, 0},
+            {shutdown_ ? shutdown_->fd() : -1, POLLIN, 0},
+        };
+        int ret = poll(pfds, 4, static_cast<int>(left));
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return fail(Error::READ_ERROR, "Poll error");
+        }
         
-        if (n > 0) {
-            buffer.insert(buffer.end(), tmp, tmp + n);
-            
-            // Check if we have a complete message
-            if (buffer.size() >= 2) {
-                uint16_t expected_len = (buffer[0] << 8) | buffer[1];
-                if (buffer.size() >= 2 + expected_len) {
-                    // Complete message received
-                    std::vector<uint8_t> payload(buffer.begin() + 2, buffer.begin() + 2 + expected_len);
-                    set_nonblocking(socket_fd_, false);
-                    return Result<std::vector<uint8_t>>::success(std::move(payload));
-                }
+        if ((pfds[2].revents | pfds[3].revents) & POLLIN) {
+            return fail(Error::TIMEOUT, "Cancelled");
+        }
+        
+        if (pfds[0].revents) {
+            auto filled = fill_rx_buffer();
+            if (!filled.ok()) {
+                return fail(filled.error(), nullptr);
             }
-        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            set_nonblocking(socket_fd_, false);
-            last_error_ = "Receive error";
-            return Result<std::vector<uint8_t>>::failure(Error::READ_ERROR);
         }
         
-        // Send keepalive every 250ms
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        static int keepalive_counter = 0;
-        if (++keepalive_counter % 2 == 0) {  // Every 200ms
+        if (pfds[1].revents & POLLIN) {
+            uint64_t expirations;
+            (void)::read(timer_fd_, &expirations, sizeof(expirations));
             if (!send_keepalive()) {
-                set_nonblocking(socket_fd_, false);
-                last_error_ = "Keepalive failed";
-                return Result<std::vector<uint8_t>>::failure(Error::WRITE_ERROR);
+                return fail(Error::WRITE_ERROR, "Keepalive failed");
             }
         }
     }
-    
-    set_nonblocking(socket_fd_, false);
-    last_error_ = "Timeout waiting for response";
-    return Result<std::vector<uint8_t>>::failure(Error::TIMEOUT);
-}
-
-// Build messages according to LIIngenicoECR protocol
-
-std::vector<uint8_t> CorvusNfcReader::build_operational_msg(uint16_t counter)
-{
-    // Format: "300000" + seq(4) + "01"
-    std::ostringstream oss;
-    oss << "300000" << std::setw(4) << std::setfill('0') << counter << "01";
-    std::string msg = oss.str();
-    return std::vector<uint8_t>(msg.begin(), msg.end());
 }
 
-std::vector<uint8_t> CorvusNfcReader::build_logon_msg(uint16_t counter, 
-                                                       const std::string& op_id, 
-                                                       const std::string& pwd)
-{
-    // Format: "010000" + seq(4) + "01" + "L" + operatorId + ";P" + SHA1(password)
-    std::string password_hash = sha1_hex(pwd);
-    
-    std::ostringstream oss;
-    oss << "010000" << std::setw(4) << std::setfill('0') << counter << "01";
-    oss << "L" << op_id << ";P" << password_hash;
-    
-    std::string msg = oss.str();
-    return std::vector<uint8_t>(msg.begin(), msg.end());
-}
-
-std::vector<uint8_t> CorvusNfcReader::build_read_uid_msg(uint16_t counter)
-{
-    // Format: "010000" + seq(4) + "95"
-    std::ostringstream oss;
-    oss << "010000" << std::setw(4) << std::setfill('0') << counter << "95";
-    std::string msg = oss.str();
-    return std::vector<uint8_t>(msg.begin(), msg.end());
-}
+// Public API implementations
 
-std::vector<uint8_t> CorvusNfcReader::build_read_card_msg(uint16_t counter)
+template <typename Codec>
+void BasicCorvusReader<Codec>::set_credentials(const std::string& operator_id, const std::string& password)
 {
-    // Format: "010000" + seq(4) + "90"
-    std::ostringstream oss;
-    oss << "010000" << std::setw(4) << std::setfill('0') << counter << "90";
-    std::string msg = oss.str();
-    return std::vector<uint8_t>(msg.begin(), msg.end());
+    operator_id_ = operator_id;
+    credential_ = Codec::credential(password);
+    invalidate_session();
 }
 
-// Parse UID from response
-// Response format: "110000" + seq(4) + "95" + "000" + UID
-std::string CorvusNfcReader::parse_uid_response(const std::vector<uint8_t>& response)
+template <typename Codec>
+void BasicCorvusReader<Codec>::invalidate_session()
 {
-    std::string resp(response.begin(), response.end());
-    
-    // Find "95000" which indicates success
-    size_t pos = resp.find("95000");
-    if (pos != std::string::npos && pos + 5 < resp.size()) {
-        return resp.substr(pos + 5);  // Everything after "95000" is UID
+    if (session_state_ == SessionState::LOGGED_ON) {
+        session_state_ = SessionState::CONNECTED;
     }
-    
-    return "";
 }
 
-std::string CorvusNfcReader::parse_card_response(const std::vector<uint8_t>& response)
+// Transport failures drop the socket; protocol-level failures only force a
+// fresh operational check + logon. A plain timeout (no card tapped) keeps the session.
+template <typename Codec>
+void BasicCorvusReader<Codec>::note_failure(Error error)
 {
-    std::string resp(response.begin(), response.end());
-    
-    // Find "90000" which indicates success
-    size_t pos = resp.find("90000");
-    if (pos != std::string::npos && pos + 5 < resp.size()) {
-        // Card data is after "90000", split by "="
-        std::string data = resp.substr(pos + 5);
-        size_t eq = data.find('=');
-        if (eq != std::string::npos) {
-            return data.substr(0, eq);  // PAN is before "="
-        }
-        return data;
+    switch (error) {
+        case Error::TIMEOUT:
+            break;
+        case Error::PORT_ERROR:
+        case Error::READ_ERROR:
+        case Error::WRITE_ERROR:
+            disconnect();
+            break;
+        default:
+            invalidate_session();
+            break;
     }
-    
-    return "";
 }
 
-// Check if response indicates success ("000" at position 12-15)
-bool CorvusNfcReader::is_success_response(const std::vector<uint8_t>& response)
-{
-    if (response.size() < 15) return false;
-    return response[12] == '0' && response[13] == '0' && response[14] == '0';
-}
-
-// Public API implementations
-
-Result<bool> CorvusNfcReader::is_terminal_operational()
+template <typename Codec>
+Result<bool> BasicCorvusReader<Codec>::is_terminal_operational()
 {
     auto conn_result = connect();
     if (!conn_result.ok()) {
         return conn_result;
     }
     
-    auto msg = build_operational_msg(next_counter());
-    auto send_result = send_message(msg);
+    uint16_t seq = next_counter();
+    auto send_result = send_message(Codec::operational(tx_, seq));
     if (!send_result.ok()) {
+        note_failure(send_result.error());
         return send_result;
     }
     
-    auto recv_result = wait_for_response_with_keepalive(5);
+    auto recv_result = wait_for_response_with_keepalive(5, seq);
     if (!recv_result.ok()) {
+        note_failure(recv_result.error());
         return Result<bool>::failure(recv_result.error());
     }
     
-    // Check for "000" success code
-    if (!is_success_response(recv_result.value())) {
+    auto resp = Codec::decode(corvus::as_view(recv_result.value()), corvus::Command::OPERATIONAL);
+    if (!resp.ok() || !resp.value().success()) {
+        invalidate_session();
         last_error_ = "Terminal not operational";
         return Result<bool>::failure(Error::DEVICE_ERROR);
     }
@@ -443,149 +359,230 @@ Result<bool> CorvusNfcReader::is_terminal_operational()
     return Result<bool>::success(true);
 }
 
-Result<bool> CorvusNfcReader::logon(const std::string& operator_id, const std::string& password)
+template <typename Codec>
+Result<bool> BasicCorvusReader<Codec>::logon(const std::string& operator_id, const std::string& password)
 {
+    set_credentials(operator_id, password);
+    
     auto conn_result = connect();
     if (!conn_result.ok()) {
         return conn_result;
     }
     
-    auto msg = build_logon_msg(next_counter(), operator_id, password);
-    auto send_result = send_message(msg);
+    uint16_t seq = next_counter();
+    auto send_result = send_message(Codec::logon(tx_, seq, operator_id_, credential_));
     if (!send_result.ok()) {
+        note_failure(send_result.error());
         return send_result;
     }
     
-    auto recv_result = wait_for_response_with_keepalive(10);
+    auto recv_result = wait_for_response_with_keepalive(10, seq);
     if (!recv_result.ok()) {
+        note_failure(recv_result.error());
         return Result<bool>::failure(recv_result.error());
     }
     
-    // Check for "000" success code
-    if (!is_success_response(recv_result.value())) {
+    auto resp = Codec::decode(corvus::as_view(recv_result.value()), corvus::Command::LOGON);
+    if (!resp.ok() || !resp.value().success()) {
         last_error_ = "Logon failed";
         return Result<bool>::failure(Error::DEVICE_ERROR);
     }
     
+    session_state_ = SessionState::LOGGED_ON;
+    validated_at_ = std::chrono::steady_clock::now();
     return Result<bool>::success(true);
 }
 
-Result<std::string> CorvusNfcReader::read_nfc_uid(int timeout_sec)
+// Logs on once per connection; afterwards a tap costs only the read command.
+template <typename Codec>
+Result<bool> BasicCorvusReader<Codec>::ensure_session()
 {
     auto conn_result = connect();
     if (!conn_result.ok()) {
-        return Result<std::string>::failure(conn_result.error());
+        return conn_result;
     }
     
-    running_.store(true);
+    auto now = std::chrono::steady_clock::now();
+    if (session_state_ == SessionState::LOGGED_ON && now - validated_at_ < revalidate_interval_) {
+        return Result<bool>::success(true);
+    }
     
-    // 1. Check terminal operational
-    auto check_msg = build_operational_msg(next_counter());
-    auto check_send = send_message(check_msg);
-    if (!check_send.ok()) {
-        running_.store(false);
-        return Result<std::string>::failure(check_send.error());
+    auto check_result = is_terminal_operational();
+    if (!check_result.ok()) {
+        return check_result;
     }
     
-    auto check_recv = wait_for_response_with_keepalive(5);
-    if (!check_recv.ok() || !is_success_response(check_recv.value())) {
-        running_.store(false);
-        last_error_ = "Terminal not operational";
-        return Result<std::string>::failure(Error::DEVICE_ERROR);
+    uint16_t seq = next_counter();
+    auto send_result = send_message(Codec::logon(tx_, seq, operator_id_, credential_));
+    if (!send_result.ok()) {
+        note_failure(send_result.error());
+        return send_result;
     }
     
-    // 2. Logon
-    auto logon_msg = build_logon_msg(next_counter(), "1", "23646");
-    auto logon_send = send_message(logon_msg);
-    if (!logon_send.ok()) {
-        running_.store(false);
-        return Result<std::string>::failure(logon_send.error());
+    // Logon may not return response: like CorvusReaderManager, take the
+    // silence as a session until the revalidate interval or a failed read
+    // drops it, so a terminal that never answers does not pay this every tap.
+    auto logon_recv = wait_for_response_with_keepalive(10, seq);
+    if (!logon_recv.ok()) {
+        if (logon_recv.error() == Error::TIMEOUT) {
+            session_state_ = SessionState::LOGGED_ON;
+            validated_at_ = std::chrono::steady_clock::now();
+            return Result<bool>::success(true);
+        }
+        invalidate_session();
+        note_failure(logon_recv.error());
+        return Result<bool>::failure(logon_recv.error());
+    }
+    
+    auto resp = Codec::decode(corvus::as_view(logon_recv.value()), corvus::Command::LOGON);
+    if (!resp.ok() || !resp.value().success()) {
+        invalidate_session();
+        last_error_ = "Logon failed";
+        return Result<bool>::failure(Error::DEVICE_ERROR);
     }
     
-    auto logon_recv = wait_for_response_with_keepalive(10);
-    // Logon may not return response immediately, continue anyway
+    session_state_ = SessionState::LOGGED_ON;
+    validated_at_ = now;
+    return Result<bool>::success(true);
+}
+
+template <typename Codec>
+Result<std::string> BasicCorvusReader<Codec>::read_nfc_uid(int timeout_sec)
+{
+    RunScope run(running_, cancel_);
     
-    // 3. Read NFC UID
-    auto read_msg = build_read_uid_msg(next_counter());
-    auto read_send = send_message(read_msg);
+    auto session_result = ensure_session();
+    if (!session_result.ok()) {
+        return Result<std::string>::failure(session_result.error());
+    }
+    
+    uint16_t seq = next_counter();
+    auto read_send = send_message(Codec::read_uid(tx_, seq));
     if (!read_send.ok()) {
-        running_.store(false);
+        note_failure(read_send.error());
         return Result<std::string>::failure(read_send.error());
     }
     
     // Wait for card with keepalive
-    auto read_recv = wait_for_response_with_keepalive(timeout_sec);
-    running_.store(false);
+    auto read_recv = wait_for_response_with_keepalive(timeout_sec, seq);
     
     if (!read_recv.ok()) {
+        note_failure(read_recv.error());
         return Result<std::string>::failure(read_recv.error());
     }
     
-    std::string uid = parse_uid_response(read_recv.value());
-    if (uid.empty()) {
+    auto resp = Codec::decode(corvus::as_view(read_recv.value()), corvus::Command::READ_UID);
+    if (!resp.ok()) {
+        invalidate_session();
+        last_error_ = "Malformed response";
+        return Result<std::string>::failure(Error::PARSE_ERROR);
+    }
+    // A refusal carries no data; report it as such, not as a parse error.
+    if (!resp.value().success()) {
+        invalidate_session();
+        last_error_ = "Read failed, result " + std::to_string(static_cast<int>(resp.value().result));
+        return Result<std::string>::failure(Error::CMD_FAILURE);
+    }
+    if (resp.value().data.empty()) {
+        invalidate_session();
         last_error_ = "No UID in response";
         return Result<std::string>::failure(Error::PARSE_ERROR);
     }
     
-    return Result<std::string>::success(uid);
+    std::string uid(resp.value().data);
+    if (status_) {
+        status_->publish_uid(StatusSource::CORVUS, uid);
+    }
+    return Result<std::string>::success(std::move(uid));
 }
 
-Result<std::string> CorvusNfcReader::read_card_data(int timeout_sec)
+template <typename Codec>
+Result<std::string> BasicCorvusReader<Codec>::read_card_data(int timeout_sec)
 {
-    auto conn_result = connect();
-    if (!conn_result.ok()) {
-        return Result<std::string>::failure(conn_result.error());
-    }
-    
-    running_.store(true);
-    
-    // 1. Check terminal
-    auto check_msg = build_operational_msg(next_counter());
-    send_message(check_msg);
-    wait_for_response_with_keepalive(5);
+    RunScope run(running_, cancel_);
     
-    // 2. Logon
-    auto logon_msg = build_logon_msg(next_counter(), "1", "23646");
-    send_message(logon_msg);
-    wait_for_response_with_keepalive(10);
+    auto session_result = ensure_session();
+    if (!session_result.ok()) {
+        return Result<std::string>::failure(session_result.error());
+    }
     
-    // 3. Read card data
-    auto read_msg = build_read_card_msg(next_counter());
-    auto read_send = send_message(read_msg);
+    uint16_t seq = next_counter();
+    auto read_send = send_message(Codec::read_card(tx_, seq));
     if (!read_send.ok()) {
-        running_.store(false);
+        note_failure(read_send.error());
         return Result<std::string>::failure(read_send.error());
     }
     
-    auto read_recv = wait_for_response_with_keepalive(timeout_sec);
-    running_.store(false);
+    auto read_recv = wait_for_response_with_keepalive(timeout_sec, seq);
     
     if (!read_recv.ok()) {
+        note_failure(read_recv.error());
         return Result<std::string>::failure(read_recv.error());
     }
     
-    std::string pan = parse_card_response(read_recv.value());
-    if (pan.empty()) {
+    auto resp = Codec::decode(corvus::as_view(read_recv.value()), corvus::Command::READ_CARD);
+    if (!resp.ok()) {
+        invalidate_session();
+        last_error_ = "Malformed response";
+        return Result<std::string>::failure(Error::PARSE_ERROR);
+    }
+    // A refusal carries no data; report it as such, not as a parse error.
+    if (!resp.value().success()) {
+        invalidate_session();
+        last_error_ = "Read failed, result " + std::to_string(static_cast<int>(resp.value().result));
+        return Result<std::string>::failure(Error::CMD_FAILURE);
+    }
+    if (resp.value().data.empty()) {
+        invalidate_session();
         last_error_ = "No card data in response";
         return Result<std::string>::failure(Error::PARSE_ERROR);
     }
     
-    return Result<std::string>::success(pan);
+    // PAN is before "="
+    return Result<std::string>::success(std::string(corvus::split_track2(resp.value().data).pan));
 }
 
-void CorvusNfcReader::start_reading(UidCallback callback)
+template <typename Codec>
+void BasicCorvusReader<Codec>::start_reading(UidCallback callback)
 {
     running_.store(true);
+    cancel_.reset();
     
+    // Each read blocks until a tap, its deadline or stop_reading(); the next
+    // read is armed immediately with no idle sleep in between.
     while (running_.load()) {
-        auto result = read_nfc_uid(5);
+        auto result = read_nfc_uid(DEFAULT_TIMEOUT_SEC);
         if (result.ok() && callback) {
             callback(result.value());
         }
+        if (shutdown_ && shutdown_->is_cancelled()) {
+            running_.store(false);
+        }
         
-        // Small delay between reads
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        // Don't spin on a dead proxy: hold off before reconnecting, but
+        // still return as soon as stop_reading() fires.
+        if (!result.ok() && result.error() != Error::TIMEOUT && running_.load()) {
+            struct pollfd pfds[2] = {
+                {cancel_.fd(), POLLIN, 0},
+                {shutdown_ ? shutdown_->fd() : -1, POLLIN, 0},
+            };
+            poll(pfds, 2, RETRY_DELAY_MS);
+        }
     }
 }
 
-} 
\ No newline at end of file
+template <typename Codec>
+void BasicCorvusReader<Codec>::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    const std::atomic<bool>* running = &running_;
+    const std::atomic<uint64_t>* stale = &stale_responses_;
+    registry.gauge("obu_reader_running", "1 while the reader loop is running.", {{"reader", name}},
+                   [running] { return running->load() ? 1.0 : 0.0; });
+    registry.counter("obu_corvus_stale_responses_total", "Responses that matched no pending request.",
+                     {{"reader", name}}, [stale] { return static_cast<double>(stale->load(std::memory_order_relaxed)); });
+}
+
+template class BasicCorvusReader<corvus::LengthPrefixedCodec>;
+template class BasicCorvusReader<corvus::IsoCodec>;
+
+}
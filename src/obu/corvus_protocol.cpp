@@ -0,0 +1,224 @@
+#include "obu/devices/corvus_protocol.hpp"
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace obu {
+namespace corvus {
+
+namespace {
+
+class SHA1 {
+public:
+    SHA1() { reset(); }
+    
+    void update(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; ++i) {
+            buffer_[bufferLen_++] = data[i];
+            if (bufferLen_ == 64) {
+                processBlock();
+                totalLen_ += 512;
+                bufferLen_ = 0;
+            }
+        }
+    }
+    
+    void final(uint8_t* digest) {
+        totalLen_ += bufferLen_ * 8;
+        buffer_[bufferLen_++] = 0x80;
+        
+        if (bufferLen_ > 56) {
+            while (bufferLen_ < 64) buffer_[bufferLen_++] = 0;
+            processBlock();
+            bufferLen_ = 0;
+        }
+        
+        while (bufferLen_ < 56) buffer_[bufferLen_++] = 0;
+        
+        for (int i = 7; i >= 0; --i) {
+            buffer_[bufferLen_++] = (totalLen_ >> (i * 8)) & 0xFF;
+        }
+        processBlock();
+        
+        for (int i = 0; i < 5; ++i) {
+            digest[i * 4 + 0] = (h_[i] >> 24) & 0xFF;
+            digest[i * 4 + 1] = (h_[i] >> 16) & 0xFF;
+            digest[i * 4 + 2] = (h_[i] >> 8) & 0xFF;
+            digest[i * 4 + 3] = h_[i] & 0xFF;
+        }
+    }
+    
+private:
+    void reset() {
+        h_[0] = 0x67452301;
+        h_[1] = 0xEFCDAB89;
+        h_[2] = 0x98BADCFE;
+        h_[3] = 0x10325476;
+        h_[4] = 0xC3D2E1F0;
+        bufferLen_ = 0;
+        totalLen_ = 0;
+    }
+    
+    void processBlock() {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (buffer_[i * 4] << 24) | (buffer_[i * 4 + 1] << 16) |
+                   (buffer_[i * 4 + 2] << 8) | buffer_[i * 4 + 3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16], 1);
+        }
+        
+        uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4];
+        
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | ((~b) & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+        }
+        
+        h_[0] += a; h_[1] += b; h_[2] += c; h_[3] += d; h_[4] += e;
+    }
+    
+    static uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+    
+    uint32_t h_[5];
+    uint8_t buffer_[64];
+    size_t bufferLen_;
+    uint64_t totalLen_;
+};
+
+} // anonymous namespace
+
+// Convert password to SHA1 hash (password padded to 9 bytes with zeros)
+std::string password_hash(const std::string& password)
+{
+    uint8_t padded[9] = {0};
+    size_t len = std::min(password.size(), size_t(9));
+    memcpy(padded, password.c_str(), len);
+    
+    SHA1 sha;
+    sha.update(padded, 9);
+    
+    uint8_t hash[20];
+    sha.final(hash);
+    
+    std::ostringstream oss;
+    oss << std::uppercase << std::hex << std::setfill('0');
+    for (int i = 0; i < 20; ++i) {
+        oss << std::setw(2) << static_cast<int>(hash[i]);
+    }
+    return oss.str();
+}
+
+namespace {
+
+bool all_digits(std::string_view s)
+{
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+int to_number(std::string_view s)
+{
+    int value = 0;
+    for (char c : s) {
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+} // anonymous namespace
+
+Result<Response> decode_response(std::string_view msg)
+{
+    // type(2) "0000" seq(4) command(2) result(3)
+    if (msg.size() < 15 || !all_digits(msg.substr(0, 15)) || msg.substr(2, 4) != "0000") {
+        return Result<Response>::failure(Error::PARSE_ERROR);
+    }
+
+    Response resp;
+    resp.type = msg.substr(0, 2);
+    resp.sequence = to_number(msg.substr(6, 4));
+    resp.command = msg.substr(10, 2);
+    resp.result = static_cast<ResultCode>(to_number(msg.substr(12, 3)));
+    resp.data = msg.substr(15);
+    return Result<Response>::success(resp);
+}
+
+Track2 split_track2(std::string_view data)
+{
+    Track2 track;
+    size_t eq = data.find('=');
+    track.pan = data.substr(0, eq);
+    if (eq != std::string_view::npos && data.size() - eq > 4) {
+        track.expiry = data.substr(eq + 1, 4);
+    }
+    return track;
+}
+
+// Sequence counter echoed at bytes 6..9 of every request and response
+int message_sequence(std::string_view msg)
+{
+    if (msg.size() < 10 || !all_digits(msg.substr(6, 4))) return -1;
+    return to_number(msg.substr(6, 4));
+}
+
+Result<Reply> LengthPrefixedCodec::decode(std::string_view msg, Command command)
+{
+    auto resp = decode_response(msg);
+    if (!resp.ok()) {
+        return Result<Reply>::failure(resp.error());
+    }
+
+    bool expected = false;
+    switch (command) {
+        case Command::OPERATIONAL: expected = resp.value().answers<OperationalFormat>(); break;
+        case Command::LOGON:       expected = resp.value().answers<LogonFormat>(); break;
+        case Command::READ_UID:    expected = resp.value().answers<ReadUidFormat>(); break;
+        case Command::READ_CARD:   expected = resp.value().answers<ReadCardFormat>(); break;
+    }
+    if (!expected) {
+        return Result<Reply>::failure(Error::PARSE_ERROR);
+    }
+
+    Reply reply;
+    reply.result = resp.value().result;
+    reply.data = resp.value().data;
+    return Result<Reply>::success(reply);
+}
+
+Result<bool> StreamBuffer::next(std::vector<uint8_t>& msg)
+{
+    size_t pos = 0;
+    while (buffer_.size() - pos >= 2) {
+        uint16_t len = (buffer_[pos] << 8) | buffer_[pos + 1];
+        if (len == 0) {
+            pos += 2;
+            continue;
+        }
+        if (len > MAX_MESSAGE_LEN) {
+            buffer_.clear();
+            return Result<bool>::failure(Error::PARSE_ERROR);
+        }
+        if (buffer_.size() - pos < 2u + len) {
+            break;
+        }
+        msg.assign(buffer_.begin() + pos + 2, buffer_.begin() + pos + 2 + len);
+        buffer_.erase(buffer_.begin(), buffer_.begin() + pos + 2 + len);
+        return Result<bool>::success(true);
+    }
+    buffer_.erase(buffer_.begin(), buffer_.begin() + pos);
+    return Result<bool>::success(false);
+}
+
+} // namespace corvus
+} // namespace obu
@@ -0,0 +1,584 @@
+#include "obu/devices/corvus_reader_manager.hpp"
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+namespace obu {
+
+namespace {
+
+constexpr int CHECK_TIMEOUT_SEC = 5;
+constexpr int LOGON_TIMEOUT_SEC = 10;
+
+} // anonymous namespace
+
+CorvusReaderManager::CorvusReaderManager(std::vector<Endpoint> endpoints)
+    : CorvusReaderManager(std::move(endpoints), Options())
+{
+}
+
+CorvusReaderManager::CorvusReaderManager(std::vector<Endpoint> endpoints, Options options)
+    : options_(std::move(options)),
+      password_hash_(corvus::password_hash(options_.password)),
+      rng_(std::random_device{}())
+{
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        auto link = std::make_unique<Link>();
+        link->endpoint = endpoints[i];
+        link->index = i;
+        links_.push_back(std::move(link));
+    }
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+CorvusReaderManager::~CorvusReaderManager()
+{
+    stop();
+    ::close(wake_fd_);
+}
+
+Result<bool> CorvusReaderManager::start()
+{
+    if (running_.load()) {
+        return Result<bool>::success(true);
+    }
+    if (wake_fd_ < 0 || links_.empty()) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    if (thread_.joinable()) {
+        thread_.join();     // a loop that ended on its own
+    }
+    running_.store(true);
+    thread_ = std::thread([this] { run(); });
+    return Result<bool>::success(true);
+}
+
+// running_ flips under mutex_, so a read_nfc_uid() racing with stop() is
+// either queued before the final drain in run() or refused.
+void CorvusReaderManager::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void CorvusReaderManager::wake()
+{
+    uint64_t one = 1;
+    (void)::write(wake_fd_, &one, sizeof(one));
+}
+
+Result<std::string> CorvusReaderManager::read_nfc_uid(int timeout_sec)
+{
+    auto request = std::make_shared<Request>();
+    request->deadline = Clock::now() + std::chrono::seconds(timeout_sec);
+    auto future = request->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load()) {
+            return Result<std::string>::failure(Error::PORT_ERROR);
+        }
+        incoming_.push_back(request);
+    }
+    wake();
+    return future.get();
+}
+
+void CorvusReaderManager::start_reading(UidCallback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = std::move(callback);
+        continuous_ = true;
+    }
+    wake();
+}
+
+void CorvusReaderManager::stop_reading()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        continuous_ = false;
+    }
+    wake();
+}
+
+size_t CorvusReaderManager::operational_count() const
+{
+    size_t count = 0;
+    for (const auto& link : links_) {
+        auto s = link->state.load();
+        if (s == LinkState::READY || s == LinkState::READING) count++;
+    }
+    return count;
+}
+
+void CorvusReaderManager::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    registry.gauge("obu_reader_running", "1 while the reader loop is running.", {{"reader", name}},
+                   [this] { return running_.load() ? 1.0 : 0.0; });
+    registry.gauge("obu_corvus_operational_links", "Links logged on and ready to read.", {{"reader", name}},
+                   [this] { return static_cast<double>(operational_count()); });
+    registry.gauge("obu_corvus_pending_reads", "Routed reads waiting for a terminal.", {{"reader", name}},
+                   [this] { return static_cast<double>(pending_reads()); });
+    for (const auto& link : links_) {
+        const Link* l = link.get();
+        registry.gauge("obu_corvus_link_state", "0 disconnected, 1 connecting, 2 checking, 3 logging on, 4 ready, 5 reading.",
+                       {{"reader", name}, {"endpoint", l->endpoint.host + ":" + std::to_string(l->endpoint.port)}},
+                       [l] { return static_cast<double>(l->state.load()); });
+    }
+}
+
+uint16_t CorvusReaderManager::next_counter(Link& link)
+{
+    link.counter = (link.counter + 1) % 10000;
+    return link.counter;
+}
+
+void CorvusReaderManager::run()
+{
+    auto start = Clock::now();
+    for (auto& link : links_) {
+        link->retry_at = start;
+    }
+
+    std::vector<struct pollfd> pfds;
+    std::vector<Link*> polled;
+
+    while (running_.load()) {
+        auto now = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (!incoming_.empty()) {
+                queued_.push_back(std::move(incoming_.front()));
+                incoming_.pop_front();
+            }
+        }
+
+        for (auto& link : links_) {
+            service(*link, now);
+        }
+        dispatch(now);
+        pending_reads_.store(queued_.size(), std::memory_order_relaxed);
+
+        pfds.clear();
+        polled.clear();
+        pfds.push_back({wake_fd_, POLLIN, 0});
+        pfds.push_back({timers_.fd(), POLLIN, 0});
+        for (auto& link : links_) {
+            if (link->fd < 0) continue;
+            short events = link->state.load() == LinkState::CONNECTING ? POLLOUT : POLLIN;
+            pfds.push_back({link->fd, events, 0});
+            polled.push_back(link.get());
+        }
+
+        int ret = poll(pfds.data(), pfds.size(), next_timeout_ms(now));
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            uint64_t v;
+            (void)::read(wake_fd_, &v, sizeof(v));
+        }
+        if (pfds[1].revents & POLLIN) {
+            timers_.dispatch();
+        }
+
+        now = Clock::now();
+        for (size_t i = 0; i < polled.size(); ++i) {
+            if (!pfds[i + 2].revents) continue;
+            Link& link = *polled[i];
+            if (link.state.load() == LinkState::CONNECTING) {
+                finish_connect(link, now);
+            } else {
+                on_readable(link, now);
+            }
+        }
+    }
+
+    for (auto& link : links_) {
+        timers_.cancel(link->keepalive);
+        if (link->request) {
+            link->request->promise.set_value(Result<std::string>::failure(Error::TIMEOUT));
+            link->request.reset();
+        }
+        if (link->fd >= 0) {
+            ::close(link->fd);
+            link->fd = -1;
+        }
+        link->rx.clear();
+        link->state.store(LinkState::DISCONNECTED);
+    }
+
+    // Also reached on a poll() failure; refuse new reads before draining.
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_.store(false);
+    for (auto* q : {&queued_, &incoming_}) {
+        for (auto& request : *q) {
+            request->promise.set_value(Result<std::string>::failure(Error::TIMEOUT));
+        }
+        q->clear();
+    }
+}
+
+// Sleep exactly until the nearest link or request deadline. Keepalives are
+// on timers_, whose fd is in the poll set.
+int CorvusReaderManager::next_timeout_ms(Clock::time_point now) const
+{
+    Clock::time_point next = Clock::time_point::max();
+    auto revalidate = std::chrono::seconds(options_.revalidate_sec);
+
+    for (const auto& link : links_) {
+        switch (link->state.load()) {
+            case LinkState::DISCONNECTED:
+                next = std::min(next, link->retry_at);
+                break;
+            case LinkState::CONNECTING:
+                next = std::min(next, link->deadline);
+                break;
+            case LinkState::CHECKING:
+            case LinkState::LOGGING_ON:
+            case LinkState::READING:
+                next = std::min(next, link->deadline);
+                break;
+            case LinkState::READY:
+                next = std::min(next, link->validated_at + revalidate);
+                break;
+        }
+    }
+    for (const auto& request : queued_) {
+        next = std::min(next, request->deadline);
+    }
+
+    if (next == Clock::time_point::max()) {
+        return -1;
+    }
+    if (next <= now) {
+        return 0;
+    }
+    // Round up so we never wake just before the deadline and spin.
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(next - now).count();
+    return static_cast<int>((us + 999) / 1000);
+}
+
+void CorvusReaderManager::service(Link& link, Clock::time_point now)
+{
+    switch (link.state.load()) {
+        case LinkState::DISCONNECTED:
+            if (now >= link.retry_at) {
+                begin_connect(link, now);
+            }
+            break;
+
+        case LinkState::CONNECTING:
+            if (now >= link.deadline) {
+                fail_link(link, now);
+            }
+            break;
+
+        case LinkState::CHECKING:
+        case LinkState::LOGGING_ON:
+        case LinkState::READING:
+            if (now >= link.deadline) {
+                auto s = link.state.load();
+                link.pending_seq = -1;
+                if (s == LinkState::CHECKING) {
+                    fail_link(link, now);
+                } else if (s == LinkState::LOGGING_ON) {
+                    // Logon may not return response, continue anyway
+                    link.validated_at = now;
+                    link.failures = 0;
+                    set_ready(link);
+                } else {
+                    if (link.request) {
+                        link.request->promise.set_value(Result<std::string>::failure(Error::TIMEOUT));
+                        link.request.reset();
+                    }
+                    set_ready(link);
+                }
+            }
+            break;
+
+        case LinkState::READY:
+            if (now - link.validated_at >= std::chrono::seconds(options_.revalidate_sec)) {
+                begin_check(link, now);
+            }
+            break;
+    }
+}
+
+void CorvusReaderManager::dispatch(Clock::time_point now)
+{
+    for (auto it = queued_.begin(); it != queued_.end();) {
+        if ((*it)->deadline <= now) {
+            (*it)->promise.set_value(Result<std::string>::failure(Error::TIMEOUT));
+            it = queued_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    bool continuous;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        continuous = continuous_;
+    }
+
+    for (auto& link : links_) {
+        if (link->state.load() != LinkState::READY) continue;
+
+        // A link that only ever goes READING -> READY would otherwise never
+        // reach the revalidation in service().
+        if (now - link->validated_at >= std::chrono::seconds(options_.revalidate_sec)) {
+            begin_check(*link, now);
+        } else if (continuous) {
+            // Queued requests are served by whichever terminal is tapped first.
+            arm_read(*link, now, now + std::chrono::seconds(options_.read_timeout_sec));
+        } else if (!queued_.empty()) {
+            link->request = std::move(queued_.front());
+            queued_.pop_front();
+            arm_read(*link, now, link->request->deadline);
+        }
+    }
+}
+
+void CorvusReaderManager::begin_connect(Link& link, Clock::time_point now)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(link.endpoint.port);
+    if (inet_pton(AF_INET, link.endpoint.host.c_str(), &addr.sin_addr) <= 0) {
+        fail_link(link, now);
+        return;
+    }
+
+    link.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (link.fd < 0) {
+        fail_link(link, now);
+        return;
+    }
+
+    link.rx.clear();
+    link.state.store(LinkState::CONNECTING);
+    link.deadline = now + std::chrono::milliseconds(options_.connect_timeout_ms);
+
+    if (::connect(link.fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        finish_connect(link, now);
+    } else if (errno != EINPROGRESS) {
+        fail_link(link, now);
+    }
+}
+
+void CorvusReaderManager::finish_connect(Link& link, Clock::time_point now)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(link.fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+        fail_link(link, now);
+        return;
+    }
+
+    int one = 1;
+    setsockopt(link.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    begin_check(link, now);
+}
+
+void CorvusReaderManager::begin_check(Link& link, Clock::time_point now)
+{
+    uint16_t seq = next_counter(link);
+    send_request(link, seq, corvus::build_operational_msg(tx_, seq), LinkState::CHECKING,
+                 now, now + std::chrono::seconds(CHECK_TIMEOUT_SEC));
+}
+
+void CorvusReaderManager::arm_read(Link& link, Clock::time_point now, Clock::time_point deadline)
+{
+    uint16_t seq = next_counter(link);
+    send_request(link, seq, corvus::build_read_uid_msg(tx_, seq), LinkState::READING, now, deadline);
+}
+
+bool CorvusReaderManager::send_request(Link& link, uint16_t seq, bool built,
+                                       LinkState next, Clock::time_point now, Clock::time_point deadline)
+{
+    if (!built) {
+        fail_link(link, now);
+        return false;
+    }
+    ssize_t sent = ::send(link.fd, tx_.data(), tx_.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent != static_cast<ssize_t>(tx_.size())) {
+        fail_link(link, now);
+        return false;
+    }
+
+    link.pending_seq = seq;
+    link.deadline = deadline;
+    link.state.store(next);
+    if (!timers_.active(link.keepalive)) {
+        link.keepalive = timers_.schedule_every(std::chrono::milliseconds(CorvusNfcReader::KEEPALIVE_INTERVAL_MS),
+                                                [this, &link] { send_keepalive(link); });
+    }
+    return true;
+}
+
+void CorvusReaderManager::on_readable(Link& link, Clock::time_point now)
+{
+    uint8_t tmp[1024];
+    while (link.fd >= 0) {
+        ssize_t n = ::recv(link.fd, tmp, sizeof(tmp), MSG_DONTWAIT);
+        if (n > 0) {
+            link.rx.feed(tmp, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        fail_link(link, now);
+        return;
+    }
+
+    std::vector<uint8_t> msg;
+    while (link.fd >= 0) {
+        auto got = link.rx.next(msg);
+        if (!got.ok()) {
+            fail_link(link, now);
+            return;
+        }
+        if (!got.value()) break;
+        on_message(link, msg, now);
+    }
+}
+
+void CorvusReaderManager::on_message(Link& link, const std::vector<uint8_t>& msg, Clock::time_point now)
+{
+    auto decoded = corvus::decode_response(corvus::as_view(msg));
+    if (!decoded.ok() || decoded.value().sequence != link.pending_seq) {
+        return;  // malformed, or a stale answer to a request we gave up on
+    }
+    const corvus::Response& resp = decoded.value();
+    link.pending_seq = -1;
+
+    switch (link.state.load()) {
+        case LinkState::CHECKING: {
+            if (!resp.answers<corvus::OperationalFormat>() || !resp.success()) {
+                fail_link(link, now);
+                return;
+            }
+            uint16_t seq = next_counter(link);
+            send_request(link, seq, corvus::build_logon_msg(tx_, seq, options_.operator_id, password_hash_),
+                         LinkState::LOGGING_ON, now, now + std::chrono::seconds(LOGON_TIMEOUT_SEC));
+            break;
+        }
+
+        case LinkState::LOGGING_ON:
+            if (!resp.answers<corvus::LogonFormat>() || !resp.success()) {
+                fail_link(link, now);
+                return;
+            }
+            link.validated_at = now;
+            link.failures = 0;
+            set_ready(link);
+            break;
+
+        case LinkState::READING: {
+            set_ready(link);
+            if (!resp.answers<corvus::ReadUidFormat>() || !resp.success() || resp.data.empty()) {
+                // Unexpected answer: force a fresh operational check + logon.
+                link.validated_at = Clock::time_point();
+                if (link.request) {
+                    bool refused = resp.answers<corvus::ReadUidFormat>() && !resp.success();
+                    Error error = refused ? Error::CMD_FAILURE : Error::PARSE_ERROR;
+                    link.request->promise.set_value(Result<std::string>::failure(error));
+                    link.request.reset();
+                }
+                return;
+            }
+
+            std::string uid(resp.data);
+            if (status_) {
+                status_->publish_uid(StatusSource::CORVUS, uid);
+            }
+            if (link.request) {
+                link.request->promise.set_value(Result<std::string>::success(uid));
+                link.request.reset();
+                return;
+            }
+            if (!queued_.empty()) {
+                queued_.front()->promise.set_value(Result<std::string>::success(uid));
+                queued_.pop_front();
+            }
+
+            UidCallback callback;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                callback = callback_;
+            }
+            if (callback) {
+                callback(link.index, uid);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// Drops the connection and schedules a reconnect with jittered exponential
+// backoff. A routed read in progress fails over to the next ready terminal.
+void CorvusReaderManager::fail_link(Link& link, Clock::time_point now)
+{
+    if (link.fd >= 0) {
+        ::close(link.fd);
+        link.fd = -1;
+    }
+    link.rx.clear();
+    link.pending_seq = -1;
+    link.state.store(LinkState::DISCONNECTED);
+    timers_.cancel(link.keepalive);
+
+    if (link.request) {
+        queued_.push_front(std::move(link.request));
+        link.request.reset();
+    }
+
+    int shift = std::min(link.failures, 16);
+    link.failures++;
+    int64_t base = std::min<int64_t>(int64_t(options_.backoff_min_ms) << shift, options_.backoff_max_ms);
+    std::uniform_int_distribution<int64_t> jitter(base / 2, base);
+    link.retry_at = now + std::chrono::milliseconds(jitter(rng_));
+}
+
+// Idle links need no keepalive; ECRProxy only expects them while a request is outstanding.
+void CorvusReaderManager::set_ready(Link& link)
+{
+    link.state.store(LinkState::READY);
+    timers_.cancel(link.keepalive);
+}
+
+void CorvusReaderManager::send_keepalive(Link& link)
+{
+    uint8_t keepalive[2] = {0, 0};
+    if (::send(link.fd, keepalive, 2, MSG_NOSIGNAL | MSG_DONTWAIT) != 2) {
+        fail_link(link, Clock::now());
+    }
+}
+
+} // namespace obu
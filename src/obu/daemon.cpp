@@ -0,0 +1,624 @@
+#include "obu/daemon/daemon.hpp"
+#include "transport/serial.hpp"
+#include "devices/mboard.hpp"
+#include "devices/terminal.hpp"
+#include "devices/qr_scanner.hpp"
+#include "validator/nfc_reader.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+namespace obu {
+
+using namespace daemon;
+
+namespace {
+
+// Queued GPS polls coalesce under this key, so a slow board never builds a backlog.
+constexpr uint64_t GPS_POLL_KEY = 1;
+
+// True if another process accepts connections on addr. A socket file left by
+// one that died refuses them and can be unlinked.
+bool socket_in_use(const struct sockaddr_un& addr)
+{
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    bool answered = ::connect(fd, (const struct sockaddr*)&addr, sizeof(addr)) == 0;
+    ::close(fd);
+    return answered;
+}
+
+} // anonymous namespace
+
+Daemon::Daemon(DaemonConfig config) : config_(std::move(config)) {}
+
+Daemon::~Daemon()
+{
+    stop();
+}
+
+Result<bool> Daemon::start()
+{
+    if (running_.load()) {
+        return Result<bool>::success(true);
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (config_.socket_path.size() >= sizeof(addr.sun_path)) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+    memcpy(addr.sun_path, config_.socket_path.c_str(), config_.socket_path.size());
+
+    // A second daemon must not take the socket, and with it the serial
+    // ports, from a running one.
+    if (socket_in_use(addr)) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    ::unlink(config_.socket_path.c_str());
+    if (listen_fd_ < 0 || wake_fd_ < 0 ||
+        ::bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 16) < 0) {
+        if (listen_fd_ >= 0) ::close(listen_fd_);
+        if (wake_fd_ >= 0) ::close(wake_fd_);
+        listen_fd_ = wake_fd_ = -1;
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    shutdown_.reset();
+    running_.store(true);
+
+    auto opened = open_devices();
+    if (!opened.ok()) {
+        stop();
+        return opened;
+    }
+
+    loop_ = std::thread([this] { run(); });
+    return Result<bool>::success(true);
+}
+
+void Daemon::stop()
+{
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    shutdown_.cancel();
+    wake();
+    if (loop_.joinable()) {
+        loop_.join();
+    }
+    close_devices();
+
+    for (auto& entry : clients_) {
+        ::close(entry.second.fd);
+    }
+    clients_.clear();
+    client_count_.store(0);
+    waiters_.clear();
+    posted_.clear();
+
+    ::close(listen_fd_);
+    ::close(wake_fd_);
+    listen_fd_ = wake_fd_ = -1;
+    ::unlink(config_.socket_path.c_str());
+}
+
+Result<bool> Daemon::open_devices()
+{
+    if (!config_.status_segment.empty()) {
+        status_.reset(new StatusPublisher(config_.status_segment));
+        if (!status_->open().ok()) {
+            status_.reset();
+        }
+    }
+
+    if (!config_.mboard_port.empty()) {
+        mboard_serial_.reset(new SerialPort());
+        auto opened = mboard_serial_->open(config_.mboard_port);
+        if (!opened.ok()) return opened;
+        mboard_.reset(new Mboard(*mboard_serial_));
+        mboard_->set_status_publisher(status_.get());
+        mboard_bus_.start();
+        next_gps_ = Clock::now();
+
+        RegisterWriter::Options write_options;
+        write_options.window = std::chrono::milliseconds(config_.register_write_window_ms);
+        writer_.reset(new RegisterWriter(*mboard_, mboard_bus_, write_options));
+
+        if (!config_.watch_registers.empty()) {
+            shadow_.reset(new MboardShadow(*mboard_, mboard_bus_));
+            for (const auto& span : config_.watch_registers) {
+                shadow_->watch(span.start, span.count);
+                shadow_->subscribe(span.start, span.count, [this](const std::vector<RegisterChange>& changes) {
+                    std::vector<uint8_t> payload;
+                    for (const auto& change : changes) {
+                        payload.push_back(change.reg);
+                        payload.push_back(change.value);
+                    }
+                    post_event(TOPIC_REGISTERS, 0, std::move(payload));
+                });
+            }
+            writer_->set_shadow(shadow_.get());
+            next_registers_ = Clock::now();
+        }
+        writer_->start();
+    }
+
+    if (!config_.terminal_port.empty()) {
+        terminal_serial_.reset(new SerialPort());
+        auto opened = terminal_serial_->open(config_.terminal_port);
+        if (!opened.ok()) return opened;
+        terminal_.reset(new Terminal(*terminal_serial_));
+        terminal_->set_status_publisher(status_.get());
+        terminal_bus_.start();
+    }
+
+    if (!config_.qr_port.empty()) {
+        qr_serial_.reset(new SerialPort());
+        auto opened = qr_serial_->open(config_.qr_port);
+        if (!opened.ok()) return opened;
+        qr_serial_->set_cancel_token(&shutdown_);
+        qr_.reset(new QrScanner(*qr_serial_));
+        qr_->set_status_publisher(status_.get());
+        qr_->set_scan_callback([this](const std::string& code) {
+            post_event(TOPIC_QR, 0, std::vector<uint8_t>(code.begin(), code.end()));
+        });
+        qr_thread_ = std::thread([this] { run_reader([this] { return qr_->start_continuous(); }); });
+    }
+
+    if (!config_.validator_port.empty()) {
+        validator_.reset(new validator::NfcReader(config_.validator_port.c_str()));
+        validator_->set_cancel_token(&shutdown_);
+        validator_->set_status_publisher(status_.get());
+        validator_->set_card_callback([this](const validator::NfcCardInfo& info) {
+            CardEvent card;
+            card.source = static_cast<uint8_t>(StatusSource::VALIDATOR);
+            card.atqa = info.atqa;
+            card.sak = info.sak;
+            card.ct = info.ct;
+            card.bcc1 = info.bcc1;
+            card.bcc2 = info.bcc2;
+            card.uid = info.uid_hex;
+            card.extra = info.extra;
+            post_event(TOPIC_CARD, card.source, encode_card(card));
+        });
+        validator_thread_ = std::thread([this] { run_reader([this] { return validator_->start_reading(); }); });
+    }
+
+    if (!config_.corvus.empty()) {
+        corvus_.reset(new CorvusReaderManager(config_.corvus));
+        corvus_->set_status_publisher(status_.get());
+        auto started = corvus_->start();
+        if (!started.ok()) return started;
+        corvus_->start_reading([this](size_t, const std::string& uid) {
+            CardEvent card;
+            card.source = static_cast<uint8_t>(StatusSource::CORVUS);
+            card.uid = uid;
+            post_event(TOPIC_CARD, card.source, encode_card(card));
+        });
+    }
+
+    return Result<bool>::success(true);
+}
+
+void Daemon::close_devices()
+{
+    if (qr_) qr_->stop();
+    if (validator_) validator_->stop();
+    if (qr_thread_.joinable()) qr_thread_.join();
+    if (validator_thread_.joinable()) validator_thread_.join();
+    if (corvus_) {
+        corvus_->stop_reading();
+        corvus_->stop();
+    }
+    if (writer_) writer_->stop();
+    mboard_bus_.stop();
+    terminal_bus_.stop();
+
+    writer_.reset();
+    shadow_.reset();
+    corvus_.reset();
+    validator_.reset();
+    qr_.reset();
+    terminal_.reset();
+    mboard_.reset();
+    qr_serial_.reset();
+    terminal_serial_.reset();
+    mboard_serial_.reset();
+    status_.reset();
+}
+
+// Keeps a continuous reader going until shutdown, restarting it after
+// reader_retry_ms whenever it fails (device unplugged, no answer at init).
+void Daemon::run_reader(const std::function<Result<bool>()>& body)
+{
+    while (!shutdown_.is_cancelled()) {
+        body();
+        if (shutdown_.is_cancelled()) break;
+        struct pollfd pfd = {shutdown_.fd(), POLLIN, 0};
+        poll(&pfd, 1, config_.reader_retry_ms);
+    }
+}
+
+void Daemon::wake()
+{
+    uint64_t one = 1;
+    (void)::write(wake_fd_, &one, sizeof(one));
+}
+
+void Daemon::post_reply(uint64_t client, std::vector<uint8_t> frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted_.push_back(Posted{client, 0, 0, std::move(frame)});
+    }
+    wake();
+}
+
+void Daemon::post_event(uint8_t topic, uint8_t source, std::vector<uint8_t> payload)
+{
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted_.push_back(Posted{0, topic, source, std::move(payload)});
+    }
+    wake();
+}
+
+void Daemon::run()
+{
+    std::vector<struct pollfd> pfds;
+    std::vector<uint64_t> polled;
+    std::vector<uint64_t> closing;
+
+    while (running_.load()) {
+        drain_posted();
+        auto now = Clock::now();
+        expire_waiters(now);
+        poll_gps(now);
+        poll_registers(now);
+
+        pfds.clear();
+        polled.clear();
+        pfds.push_back({wake_fd_, POLLIN, 0});
+        pfds.push_back({listen_fd_, POLLIN, 0});
+        for (auto& entry : clients_) {
+            short events = POLLIN;
+            if (entry.second.tx_sent < entry.second.tx.size()) events |= POLLOUT;
+            pfds.push_back({entry.second.fd, events, 0});
+            polled.push_back(entry.first);
+        }
+
+        if (poll(pfds.data(), pfds.size(), next_timeout_ms(now)) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            uint64_t v;
+            (void)::read(wake_fd_, &v, sizeof(v));
+        }
+        if (pfds[1].revents & POLLIN) {
+            accept_clients();
+        }
+
+        closing.clear();
+        for (size_t i = 0; i < polled.size(); i++) {
+            auto it = clients_.find(polled[i]);
+            if (it == clients_.end()) continue;
+            short revents = pfds[i + 2].revents;
+            bool ok = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) ok = read_client(it->first, it->second);
+            if (ok && (revents & POLLOUT)) ok = flush_client(it->second);
+            if (!ok) closing.push_back(it->first);
+        }
+        for (auto& entry : clients_) {
+            if (entry.second.tx.size() - entry.second.tx_sent > config_.max_client_backlog) {
+                closing.push_back(entry.first);
+                dropped_clients_.fetch_add(1);
+            }
+        }
+        for (uint64_t id : closing) {
+            auto it = clients_.find(id);
+            if (it == clients_.end()) continue;
+            ::close(it->second.fd);
+            clients_.erase(it);
+            waiters_.erase(std::remove_if(waiters_.begin(), waiters_.end(),
+                                          [id](const Waiter& w) { return w.client == id; }),
+                           waiters_.end());
+        }
+        client_count_.store(clients_.size());
+    }
+}
+
+void Daemon::drain_posted()
+{
+    std::deque<Posted> batch;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        batch.swap(posted_);
+    }
+    for (auto& p : batch) {
+        if (p.client) {
+            queue_frame(p.client, p.bytes);
+        } else {
+            deliver_event(p.topic, p.source, p.bytes);
+        }
+    }
+}
+
+void Daemon::deliver_event(uint8_t topic, uint8_t source, const std::vector<uint8_t>& payload)
+{
+    events_.fetch_add(1);
+
+    auto frame = encode_event(topic, payload.data(), payload.size());
+    for (auto& entry : clients_) {
+        if (entry.second.topics & (1u << topic)) {
+            queue_frame(entry.first, frame);
+        }
+    }
+
+    for (auto it = waiters_.begin(); it != waiters_.end();) {
+        if (it->topic == topic && (it->source == 0 || it->source == source)) {
+            queue_frame(it->client, encode_reply(it->id, payload.data(), payload.size()));
+            it = waiters_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Daemon::expire_waiters(Clock::time_point now)
+{
+    for (auto it = waiters_.begin(); it != waiters_.end();) {
+        if (it->deadline <= now) {
+            queue_frame(it->client, encode_reply(it->id, Error::TIMEOUT));
+            it = waiters_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void Daemon::poll_gps(Clock::time_point now)
+{
+    if (!mboard_ || config_.gps_interval_ms <= 0 || now < next_gps_) return;
+    next_gps_ = now + std::chrono::milliseconds(config_.gps_interval_ms);
+
+    mboard_bus_.submit(CommandClass::TELEMETRY, [this] {
+        auto gps = mboard_->gps();
+        if (gps.ok() && !gps.value().nmea.empty()) {
+            const auto& nmea = gps.value().nmea;
+            post_event(TOPIC_GPS, 0, std::vector<uint8_t>(nmea.begin(), nmea.end()));
+        }
+    }, nullptr, GPS_POLL_KEY);
+}
+
+void Daemon::poll_registers(Clock::time_point now)
+{
+    if (!shadow_ || config_.register_interval_ms <= 0 || now < next_registers_) return;
+    next_registers_ = now + std::chrono::milliseconds(config_.register_interval_ms);
+    shadow_->refresh();
+}
+
+int Daemon::next_timeout_ms(Clock::time_point now) const
+{
+    bool gps = mboard_ && config_.gps_interval_ms > 0;
+    bool registers = shadow_ && config_.register_interval_ms > 0;
+    if (waiters_.empty() && !gps && !registers) return -1;
+    auto next = Clock::time_point::max();
+    if (gps) next = next_gps_;
+    if (registers) next = std::min(next, next_registers_);
+    for (const auto& w : waiters_) next = std::min(next, w.deadline);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+    return ms < 0 ? 0 : static_cast<int>(ms);
+}
+
+void Daemon::accept_clients()
+{
+    int fd;
+    while ((fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+        if (clients_.size() >= config_.max_clients) {
+            ::close(fd);
+            continue;
+        }
+        Client client;
+        client.fd = fd;
+        clients_.emplace(next_client_++, std::move(client));
+    }
+    client_count_.store(clients_.size());
+}
+
+bool Daemon::read_client(uint64_t id, Client& client)
+{
+    uint8_t buf[16 * 1024];
+    for (;;) {
+        ssize_t n = ::read(client.fd, buf, sizeof(buf));
+        if (n > 0) {
+            client.rx.feed(buf, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) break;
+        return false;   // EOF or error
+    }
+
+    Frame frame;
+    for (;;) {
+        auto next = client.rx.next(frame);
+        if (!next.ok()) return false;
+        if (!next.value()) break;
+        handle(id, client, frame);
+    }
+    return true;
+}
+
+bool Daemon::flush_client(Client& client)
+{
+    while (client.tx_sent < client.tx.size()) {
+        ssize_t n = ::send(client.fd, client.tx.data() + client.tx_sent, client.tx.size() - client.tx_sent,
+                           MSG_NOSIGNAL);
+        if (n > 0) {
+            client.tx_sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) return true;
+        return false;
+    }
+    client.tx.clear();
+    client.tx_sent = 0;
+    return true;
+}
+
+// Appends and writes straight away; whatever the socket does not take now
+// goes out on POLLOUT. The backlog limit is enforced by the loop.
+void Daemon::queue_frame(uint64_t id, const std::vector<uint8_t>& frame)
+{
+    auto it = clients_.find(id);
+    if (it == clients_.end()) return;
+    Client& client = it->second;
+    bool idle = client.tx_sent == client.tx.size();
+    client.tx.insert(client.tx.end(), frame.begin(), frame.end());
+    if (idle) flush_client(client);
+}
+
+void Daemon::handle(uint64_t id, Client& client, const Frame& frame)
+{
+    requests_.fetch_add(1);
+    uint32_t rid = frame.id;
+    const auto& body = frame.body;
+
+    auto reply_error = [&](Error error) { queue_frame(id, encode_reply(rid, error)); };
+    auto reply_ok = [&] { queue_frame(id, encode_reply(rid, nullptr, 0)); };
+
+    switch (frame.type) {
+        case MSG_MBOARD_ALIVE:
+        case MSG_MBOARD_READ_REGISTERS:
+        case MSG_MBOARD_GPS: {
+            if (!mboard_) return reply_error(Error::DEVICE_ERROR);
+            if (frame.type == MSG_MBOARD_READ_REGISTERS && body.size() < 2) return reply_error(Error::PARSE_ERROR);
+            uint8_t type = frame.type;
+            uint8_t start = body.size() >= 2 ? body[0] : 0;
+            uint8_t count = body.size() >= 2 ? body[1] : 0;
+            bool fresh = body.size() >= 3 && (body[2] & READ_FRESH);
+            std::vector<uint8_t> cached;
+            if (type == MSG_MBOARD_READ_REGISTERS && shadow_ && !fresh && shadow_->cached(start, count, cached)) {
+                return queue_frame(id, encode_reply(rid, cached.data(), cached.size()));
+            }
+            // Register reads gate validation (door and route state); ALIVE and GPS are polls.
+            auto cls = type == MSG_MBOARD_READ_REGISTERS ? CommandClass::VALIDATION : CommandClass::TELEMETRY;
+            mboard_bus_.submit(cls, [this, id, rid, type, start, count] {
+                if (type == MSG_MBOARD_ALIVE) {
+                    auto r = mboard_->alive();
+                    if (!r.ok()) return post_reply(id, encode_reply(rid, r.error()));
+                    auto payload = encode_alive(r.value());
+                    post_reply(id, encode_reply(rid, payload.data(), payload.size()));
+                } else if (type == MSG_MBOARD_READ_REGISTERS) {
+                    auto r = shadow_ ? shadow_->fetch(start, count) : mboard_->read_registers(start, count);
+                    if (!r.ok()) return post_reply(id, encode_reply(rid, r.error()));
+                    post_reply(id, encode_reply(rid, r.value().data(), r.value().size()));
+                } else {
+                    auto r = mboard_->gps();
+                    if (!r.ok()) return post_reply(id, encode_reply(rid, r.error()));
+                    const auto& nmea = r.value().nmea;
+                    post_reply(id, encode_reply(rid, reinterpret_cast<const uint8_t*>(nmea.data()), nmea.size()));
+                }
+            }, [this, id, rid](Error error) { post_reply(id, encode_reply(rid, error)); });
+            return;
+        }
+
+        case MSG_MBOARD_WRITE_REGISTERS: {
+            if (!writer_) return reply_error(Error::DEVICE_ERROR);
+            if (body.size() < 2) return reply_error(Error::PARSE_ERROR);
+            writer_->write(body[0], std::vector<uint8_t>(body.begin() + 1, body.end()),
+                           [this, id, rid](const Result<bool>& r) {
+                post_reply(id, r.ok() ? encode_reply(rid, nullptr, 0) : encode_reply(rid, r.error()));
+            });
+            return;
+        }
+
+        case MSG_TERMINAL_ALIVE:
+        case MSG_TERMINAL_BEEP: {
+            if (!terminal_) return reply_error(Error::DEVICE_ERROR);
+            if (body.size() < 1) return reply_error(Error::PARSE_ERROR);
+            uint8_t type = frame.type;
+            auto addr = static_cast<TerminalAddress>(body[0]);
+            auto cls = type == MSG_TERMINAL_BEEP ? CommandClass::FEEDBACK : CommandClass::TELEMETRY;
+            terminal_bus_.submit(cls, [this, id, rid, type, addr] {
+                if (type == MSG_TERMINAL_ALIVE) {
+                    auto r = terminal_->alive(addr);
+                    if (!r.ok()) return post_reply(id, encode_reply(rid, r.error()));
+                    auto payload = encode_terminal_alive(r.value());
+                    post_reply(id, encode_reply(rid, payload.data(), payload.size()));
+                } else {
+                    auto r = terminal_->beep(addr);
+                    post_reply(id, r.ok() ? encode_reply(rid, nullptr, 0) : encode_reply(rid, r.error()));
+                }
+            }, [this, id, rid](Error error) { post_reply(id, encode_reply(rid, error)); });
+            return;
+        }
+
+        case MSG_QR_SCAN:
+        case MSG_CARD_READ: {
+            bool qr = frame.type == MSG_QR_SCAN;
+            size_t need = qr ? 4 : 5;
+            if (body.size() < need) return reply_error(Error::PARSE_ERROR);
+            Waiter w;
+            w.client = id;
+            w.id = rid;
+            w.topic = qr ? TOPIC_QR : TOPIC_CARD;
+            w.source = qr ? 0 : body[0];
+            w.deadline = Clock::now() + std::chrono::milliseconds(get_be(&body[need - 4], 4));
+
+            bool available = qr ? qr_ != nullptr
+                : w.source == static_cast<uint8_t>(StatusSource::VALIDATOR) ? validator_ != nullptr
+                : w.source == static_cast<uint8_t>(StatusSource::CORVUS) ? corvus_ != nullptr
+                : (validator_ || corvus_);
+            if (!available) return reply_error(Error::DEVICE_ERROR);
+            waiters_.push_back(w);
+            return;
+        }
+
+        case MSG_SUBSCRIBE:
+            if (body.size() < 4) return reply_error(Error::PARSE_ERROR);
+            client.topics = get_be(body.data(), 4);
+            return reply_ok();
+
+        case MSG_PING:
+            return reply_ok();
+
+        default:
+            return reply_error(Error::PARSE_ERROR);
+    }
+}
+
+void Daemon::register_metrics(MetricsRegistry& registry) const
+{
+    registry.gauge("obu_daemon_clients", "Connected clients.", {},
+                   [this] { return static_cast<double>(client_count_.load()); });
+    registry.counter("obu_daemon_requests_total", "Requests received from clients.", {},
+                     [this] { return static_cast<double>(requests_.load()); });
+    registry.counter("obu_daemon_events_total", "Device events fanned out to clients.", {},
+                     [this] { return static_cast<double>(events_.load()); });
+    registry.counter("obu_daemon_dropped_clients_total", "Clients dropped for exceeding the send backlog.", {},
+                     [this] { return static_cast<double>(dropped_clients_.load()); });
+    mboard_bus_.register_metrics(registry, "mboard");
+    if (shadow_) shadow_->register_metrics(registry, "mboard");
+    if (writer_) writer_->register_metrics(registry, "mboard");
+    terminal_bus_.register_metrics(registry, "terminal");
+}
+
+} // namespace obu
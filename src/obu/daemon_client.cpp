@@ -0,0 +1,257 @@
+#include "obu/daemon/client.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+
+namespace obu {
+
+using namespace daemon;
+
+DaemonClient::DaemonClient(std::string socket_path)
+    : path_(std::move(socket_path))
+{
+    closed_.cancel();
+}
+
+DaemonClient::~DaemonClient()
+{
+    disconnect();
+}
+
+Result<bool> DaemonClient::connect()
+{
+    if (connected_.load()) {
+        return Result<bool>::success(true);
+    }
+    disconnect();   // reaps the reader of a dropped connection
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+    memcpy(addr.sun_path, path_.c_str(), path_.size());
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    shutdown_.reset();
+    closed_.reset();
+    connected_.store(true);
+    reader_ = std::thread([this] { run(); });
+
+    // Listeners added before (re)connecting.
+    update_subscription(true);
+    return Result<bool>::success(true);
+}
+
+void DaemonClient::disconnect()
+{
+    shutdown_.cancel();
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+std::future<DaemonClient::Reply> DaemonClient::request(uint8_t type, std::vector<uint8_t> body)
+{
+    uint32_t id;
+    return submit(type, body, id);
+}
+
+DaemonClient::Reply DaemonClient::call(uint8_t type, std::vector<uint8_t> body, int timeout_ms)
+{
+    uint32_t id;
+    auto reply = submit(type, body, id);
+    if (reply.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_.erase(id);
+        return Reply::failure(Error::TIMEOUT);
+    }
+    return reply.get();
+}
+
+std::future<DaemonClient::Reply> DaemonClient::submit(uint8_t type, const std::vector<uint8_t>& body, uint32_t& id)
+{
+    std::promise<Reply> promise;
+    auto future = promise.get_future();
+    {
+        // connected_ only drops under pending_mutex_, so nothing is added after fail_pending().
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (!connected_.load()) {
+            id = 0;
+            promise.set_value(Reply::failure(Error::PORT_ERROR));
+            return future;
+        }
+        id = next_id_++;
+        if (next_id_ == 0) next_id_ = 1;    // 0 is reserved for events
+        pending_.emplace(id, std::move(promise));
+    }
+
+    // On failure the reader sees the broken socket and fails the request.
+    send_frame(encode_frame(type, id, body.data(), body.size()));
+    return future;
+}
+
+bool DaemonClient::send_frame(const std::vector<uint8_t>& frame)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t n = ::send(fd_, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            ::shutdown(fd_, SHUT_RDWR);
+            return false;
+        }
+    }
+    return true;
+}
+
+int DaemonClient::add_listener(uint8_t topic, EventCallback callback)
+{
+    int handle;
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        handle = next_listener_++;
+        listeners_[handle] = Listener{topic, std::move(callback)};
+    }
+    update_subscription();
+    return handle;
+}
+
+void DaemonClient::remove_listener(int handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        listeners_.erase(handle);
+    }
+    update_subscription();
+}
+
+// Sends SUBSCRIBE when the set of topics with listeners changed, or always
+// right after connect. The reply is not waited for.
+void DaemonClient::update_subscription(bool force)
+{
+    uint32_t topics = 0;
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        for (const auto& entry : listeners_) {
+            topics |= 1u << entry.second.topic;
+        }
+        if (topics == topics_ && !force) {
+            return;
+        }
+        topics_ = topics;
+    }
+    if (!connected_.load()) {
+        return;
+    }
+
+    std::vector<uint8_t> body;
+    put_be(body, topics, 4);
+    request(MSG_SUBSCRIBE, std::move(body));
+}
+
+void DaemonClient::run()
+{
+    FrameReader rx;
+    Frame frame;
+    uint8_t buf[16 * 1024];
+
+    struct pollfd pfds[2] = {
+        {fd_, POLLIN, 0},
+        {shutdown_.fd(), POLLIN, 0},
+    };
+
+    bool ok = true;
+    while (ok && !shutdown_.is_cancelled()) {
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfds[1].revents & POLLIN) break;
+        if (!(pfds[0].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+        ssize_t n = ::read(fd_, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        rx.feed(buf, n);
+
+        for (;;) {
+            auto next = rx.next(frame);
+            if (!next.ok()) {
+                ok = false;
+                break;
+            }
+            if (!next.value()) break;
+            dispatch(frame);
+        }
+    }
+
+    fail_pending();
+    closed_.cancel();
+}
+
+void DaemonClient::dispatch(const Frame& frame)
+{
+    if (frame.type == MSG_REPLY) {
+        std::promise<Reply> promise;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            auto it = pending_.find(frame.id);
+            if (it == pending_.end()) return;   // caller timed out
+            promise = std::move(it->second);
+            pending_.erase(it);
+        }
+        promise.set_value(decode_reply(frame.body));
+        return;
+    }
+
+    if (frame.type == MSG_EVENT && !frame.body.empty()) {
+        uint8_t topic = frame.body[0];
+        std::vector<uint8_t> payload(frame.body.begin() + 1, frame.body.end());
+
+        std::vector<EventCallback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(listener_mutex_);
+            for (const auto& entry : listeners_) {
+                if (entry.second.topic == topic) callbacks.push_back(entry.second.callback);
+            }
+        }
+        for (auto& callback : callbacks) {
+            callback(payload);
+        }
+    }
+}
+
+void DaemonClient::fail_pending()
+{
+    std::map<uint32_t, std::promise<Reply>> failed;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        connected_.store(false);
+        failed.swap(pending_);
+    }
+    for (auto& entry : failed) {
+        entry.second.set_value(Reply::failure(Error::PORT_ERROR));
+    }
+}
+
+} // namespace obu
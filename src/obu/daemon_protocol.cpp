@@ -0,0 +1,171 @@
+#include "obu/daemon/protocol.hpp"
+#include "common/messages.hpp"
+#include <algorithm>
+
+namespace obu {
+namespace daemon {
+
+namespace {
+
+// Fixed part of a CARD event; the UID length, UID text and extra data follow.
+using CardEventSchema = schema::Message<CardEvent,
+    schema::Be<&CardEvent::source>,
+    schema::Be<&CardEvent::atqa>,
+    schema::Be<&CardEvent::sak>,
+    schema::Be<&CardEvent::ct>,
+    schema::Be<&CardEvent::bcc1>,
+    schema::Be<&CardEvent::bcc2>>;
+
+} // anonymous namespace
+
+void put_be(std::vector<uint8_t>& out, uint32_t v, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+    }
+}
+
+uint32_t get_be(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+std::vector<uint8_t> encode_frame(uint8_t type, uint32_t id, const uint8_t* body, size_t len)
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER + len);
+    frame.push_back(type);
+    put_be(frame, id, 4);
+    put_be(frame, static_cast<uint32_t>(len), 4);
+    frame.insert(frame.end(), body, body + len);
+    return frame;
+}
+
+std::vector<uint8_t> encode_reply(uint32_t id, Error error)
+{
+    uint8_t status = static_cast<uint8_t>(error) + 1;
+    return encode_frame(MSG_REPLY, id, &status, 1);
+}
+
+std::vector<uint8_t> encode_reply(uint32_t id, const uint8_t* payload, size_t len)
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER + 1 + len);
+    frame.push_back(MSG_REPLY);
+    put_be(frame, id, 4);
+    put_be(frame, static_cast<uint32_t>(len + 1), 4);
+    frame.push_back(0);
+    frame.insert(frame.end(), payload, payload + len);
+    return frame;
+}
+
+std::vector<uint8_t> encode_event(uint8_t topic, const uint8_t* payload, size_t len)
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER + 1 + len);
+    frame.push_back(MSG_EVENT);
+    put_be(frame, 0, 4);
+    put_be(frame, static_cast<uint32_t>(len + 1), 4);
+    frame.push_back(topic);
+    frame.insert(frame.end(), payload, payload + len);
+    return frame;
+}
+
+Result<std::vector<uint8_t>> decode_reply(const std::vector<uint8_t>& body)
+{
+    if (body.empty()) {
+        return Result<std::vector<uint8_t>>::failure(Error::PARSE_ERROR);
+    }
+    if (body[0] != 0) {
+        return Result<std::vector<uint8_t>>::failure(static_cast<Error>(body[0] - 1));
+    }
+    return Result<std::vector<uint8_t>>::success(std::vector<uint8_t>(body.begin() + 1, body.end()));
+}
+
+std::vector<uint8_t> encode_alive(const AliveResponse& alive)
+{
+    return AliveSchema::encode(alive);
+}
+
+Result<AliveResponse> decode_alive(const std::vector<uint8_t>& payload)
+{
+    return AliveSchema::decode(payload);
+}
+
+std::vector<uint8_t> encode_terminal_alive(const TerminalAliveResponse& alive)
+{
+    return TerminalAliveSchema::encode(alive);
+}
+
+Result<TerminalAliveResponse> decode_terminal_alive(const std::vector<uint8_t>& payload)
+{
+    return TerminalAliveSchema::decode(payload);
+}
+
+std::vector<uint8_t> encode_card(const CardEvent& card)
+{
+    size_t uid_len = std::min<size_t>(card.uid.size(), 0xFF);
+    std::vector<uint8_t> out;
+    out.reserve(CardEventSchema::size + 1 + uid_len + card.extra.size());
+    CardEventSchema::append(out, card);
+    out.push_back(static_cast<uint8_t>(uid_len));
+    out.insert(out.end(), card.uid.begin(), card.uid.begin() + uid_len);
+    out.insert(out.end(), card.extra.begin(), card.extra.end());
+    return out;
+}
+
+Result<CardEvent> decode_card(const std::vector<uint8_t>& payload)
+{
+    auto card = CardEventSchema::decode(payload);
+    if (!card.ok()) {
+        return card;
+    }
+    size_t at = CardEventSchema::size;
+    if (payload.size() <= at || payload.size() - at - 1 < payload[at]) {
+        return Result<CardEvent>::failure(Error::INVALID_RESPONSE);
+    }
+    size_t uid_len = payload[at++];
+    CardEvent event = card.value();
+    event.uid.assign(payload.begin() + at, payload.begin() + at + uid_len);
+    event.extra.assign(payload.begin() + at + uid_len, payload.end());
+    return Result<CardEvent>::success(std::move(event));
+}
+
+Result<bool> FrameReader::next(Frame& frame)
+{
+    size_t avail = buffer_.size() - start_;
+    if (avail < FRAME_HEADER) {
+        if (start_ > 0 && avail == 0) {
+            buffer_.clear();
+            start_ = 0;
+        }
+        return Result<bool>::success(false);
+    }
+
+    const uint8_t* p = buffer_.data() + start_;
+    size_t body_len = get_be(p + 5, 4);
+    if (body_len > MAX_FRAME_BODY) {
+        return Result<bool>::failure(Error::PARSE_ERROR);
+    }
+    if (avail < FRAME_HEADER + body_len) {
+        // Keep the partial frame at the front so the buffer stays bounded.
+        if (start_ > 0) {
+            buffer_.erase(buffer_.begin(), buffer_.begin() + start_);
+            start_ = 0;
+        }
+        return Result<bool>::success(false);
+    }
+
+    frame.type = p[0];
+    frame.id = get_be(p + 1, 4);
+    frame.body.assign(p + FRAME_HEADER, p + FRAME_HEADER + body_len);
+    start_ += FRAME_HEADER + body_len;
+    return Result<bool>::success(true);
+}
+
+} // namespace daemon
+} // namespace obu
@@ -0,0 +1,205 @@
+#include "obu/daemon/remote.hpp"
+#include "obu/common/status_segment.hpp"
+#include <poll.h>
+
+namespace obu {
+namespace remote {
+
+using namespace daemon;
+
+namespace {
+
+// Extra wait for a QR_SCAN / CARD_READ reply past the daemon-side deadline,
+// so the daemon's TIMEOUT arrives rather than a local one.
+constexpr int REPLY_MARGIN_MS = 500;
+
+std::vector<uint8_t> wait_body(int timeout_ms)
+{
+    std::vector<uint8_t> body;
+    put_be(body, static_cast<uint32_t>(timeout_ms), 4);
+    return body;
+}
+
+std::vector<uint8_t> card_read_body(StatusSource source, int timeout_ms)
+{
+    std::vector<uint8_t> body;
+    body.push_back(static_cast<uint8_t>(source));
+    put_be(body, static_cast<uint32_t>(timeout_ms), 4);
+    return body;
+}
+
+std::string to_string(const std::vector<uint8_t>& payload)
+{
+    return std::string(payload.begin(), payload.end());
+}
+
+validator::NfcCardInfo to_card_info(const CardEvent& card)
+{
+    validator::NfcCardInfo info;
+    info.uid_hex = card.uid;
+    info.atqa = card.atqa;
+    info.sak = card.sak;
+    info.ct = card.ct;
+    info.bcc1 = card.bcc1;
+    info.bcc2 = card.bcc2;
+    info.extra = card.extra;
+    return info;
+}
+
+} // anonymous namespace
+
+Result<AliveResponse> Mboard::alive()
+{
+    auto reply = client_.call(MSG_MBOARD_ALIVE);
+    if (!reply.ok()) {
+        return Result<AliveResponse>::failure(reply.error());
+    }
+    return decode_alive(reply.value());
+}
+
+Result<GpsData> Mboard::gps()
+{
+    auto reply = client_.call(MSG_MBOARD_GPS);
+    if (!reply.ok()) {
+        return Result<GpsData>::failure(reply.error());
+    }
+    GpsData gps;
+    gps.nmea = to_string(reply.value());
+    return Result<GpsData>::success(std::move(gps));
+}
+
+Result<std::vector<uint8_t>> Mboard::read_registers(uint8_t start, uint8_t count, bool fresh)
+{
+    if (fresh) {
+        return client_.call(MSG_MBOARD_READ_REGISTERS, {start, count, READ_FRESH});
+    }
+    return client_.call(MSG_MBOARD_READ_REGISTERS, {start, count});
+}
+
+Result<bool> Mboard::write_registers(uint8_t start, const std::vector<uint8_t>& values)
+{
+    std::vector<uint8_t> body;
+    body.reserve(values.size() + 1);
+    body.push_back(start);
+    body.insert(body.end(), values.begin(), values.end());
+    auto reply = client_.call(MSG_MBOARD_WRITE_REGISTERS, std::move(body));
+    if (!reply.ok()) {
+        return Result<bool>::failure(reply.error());
+    }
+    return Result<bool>::success(true);
+}
+
+Result<TerminalAliveResponse> Terminal::alive(TerminalAddress addr)
+{
+    auto reply = client_.call(MSG_TERMINAL_ALIVE, {static_cast<uint8_t>(addr)});
+    if (!reply.ok()) {
+        return Result<TerminalAliveResponse>::failure(reply.error());
+    }
+    return decode_terminal_alive(reply.value());
+}
+
+Result<bool> Terminal::beep(TerminalAddress addr)
+{
+    auto reply = client_.call(MSG_TERMINAL_BEEP, {static_cast<uint8_t>(addr)});
+    if (!reply.ok()) {
+        return Result<bool>::failure(reply.error());
+    }
+    return Result<bool>::success(true);
+}
+
+Result<bool> EventLoop::run(uint8_t topic, DaemonClient::EventCallback callback)
+{
+    if (!client_.is_connected()) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    stop_.reset();
+    running_.store(true);
+    int listener = client_.add_listener(topic, std::move(callback));
+
+    struct pollfd pfds[2] = {
+        {stop_.fd(), POLLIN, 0},
+        {client_.closed().fd(), POLLIN, 0},
+    };
+    while (running_.load()) {
+        int ret = poll(pfds, 2, -1);
+        if (ret > 0) break;
+    }
+
+    client_.remove_listener(listener);
+    running_.store(false);
+    if (client_.closed().is_cancelled()) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+    return Result<bool>::success(true);
+}
+
+Result<std::string> QrScanner::scan_once()
+{
+    auto reply = client_.call(MSG_QR_SCAN, wait_body(SCAN_TIMEOUT_MS), SCAN_TIMEOUT_MS + REPLY_MARGIN_MS);
+    if (!reply.ok()) {
+        return Result<std::string>::failure(reply.error());
+    }
+    return Result<std::string>::success(to_string(reply.value()));
+}
+
+Result<bool> QrScanner::start_continuous()
+{
+    return run(TOPIC_QR, [this](const std::vector<uint8_t>& payload) {
+        if (scan_callback_) {
+            scan_callback_(to_string(payload));
+        }
+    });
+}
+
+Result<validator::NfcCardInfo> NfcReader::read_single_card(int timeout_ms)
+{
+    auto reply = client_.call(MSG_CARD_READ, card_read_body(StatusSource::VALIDATOR, timeout_ms),
+                              timeout_ms + REPLY_MARGIN_MS);
+    if (!reply.ok()) {
+        return Result<validator::NfcCardInfo>::failure(reply.error());
+    }
+    auto card = decode_card(reply.value());
+    if (!card.ok()) {
+        return Result<validator::NfcCardInfo>::failure(card.error());
+    }
+    return Result<validator::NfcCardInfo>::success(to_card_info(card.value()));
+}
+
+Result<bool> NfcReader::start_reading()
+{
+    return run(TOPIC_CARD, [this](const std::vector<uint8_t>& payload) {
+        auto card = decode_card(payload);
+        if (card.ok() && card.value().source == static_cast<uint8_t>(StatusSource::VALIDATOR) && card_callback_) {
+            card_callback_(to_card_info(card.value()));
+        }
+    });
+}
+
+Result<std::string> CorvusNfcReader::read_nfc_uid(int timeout_sec)
+{
+    int timeout_ms = timeout_sec * 1000;
+    auto reply = client_.call(MSG_CARD_READ, card_read_body(StatusSource::CORVUS, timeout_ms),
+                              timeout_ms + REPLY_MARGIN_MS);
+    if (!reply.ok()) {
+        return Result<std::string>::failure(reply.error());
+    }
+    auto card = decode_card(reply.value());
+    if (!card.ok()) {
+        return Result<std::string>::failure(card.error());
+    }
+    return Result<std::string>::success(card.value().uid);
+}
+
+void CorvusNfcReader::start_reading(UidCallback callback)
+{
+    run(TOPIC_CARD, [callback](const std::vector<uint8_t>& payload) {
+        auto card = decode_card(payload);
+        if (card.ok() && card.value().source == static_cast<uint8_t>(StatusSource::CORVUS)) {
+            callback(card.value().uid);
+        }
+    });
+}
+
+} // namespace remote
+} // namespace obu
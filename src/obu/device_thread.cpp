@@ -0,0 +1,119 @@
+#include "obu/common/device_thread.hpp"
+#include <sched.h>
+#include <sys/mman.h>
+#include <alloca.h>
+#include <future>
+#include <algorithm>
+
+namespace obu {
+
+namespace {
+
+constexpr size_t STACK_PAGE = 4096;
+
+// Touches `bytes` of stack below the caller so the pages are mapped (and,
+// with mlockall(MCL_FUTURE), locked) before the worker needs them.
+__attribute__((noinline)) void touch_stack(size_t bytes)
+{
+    volatile char* stack = static_cast<volatile char*>(alloca(bytes));
+    for (size_t i = 0; i < bytes; i += STACK_PAGE) {
+        stack[i] = 0;
+    }
+}
+
+struct StartContext
+{
+    DeviceThread* self;
+    std::promise<void> applied;
+};
+
+} // anonymous namespace
+
+DeviceThread::~DeviceThread()
+{
+    join();
+}
+
+Result<bool> DeviceThread::start(const ThreadOptions& options, std::function<void()> body)
+{
+    if (started_) {
+        return Result<bool>::failure(Error::CMD_FAILURE);
+    }
+
+    options_ = options;
+    body_ = std::move(body);
+    status_ = ThreadStatus();
+
+    if (options_.lock_memory) {
+        status_.memory_locked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (options_.stack_size > 0) {
+        pthread_attr_setstacksize(&attr, options_.stack_size);
+    }
+
+    StartContext ctx{this, {}};
+    auto applied = ctx.applied.get_future();
+    int err = pthread_create(&thread_, &attr, &DeviceThread::entry, &ctx);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        return Result<bool>::failure(Error::CMD_FAILURE);
+    }
+
+    started_ = true;
+    applied.wait();
+    return Result<bool>::success(true);
+}
+
+void DeviceThread::join()
+{
+    if (started_) {
+        pthread_join(thread_, nullptr);
+        started_ = false;
+    }
+}
+
+void* DeviceThread::entry(void* arg)
+{
+    auto* ctx = static_cast<StartContext*>(arg);
+    DeviceThread* self = ctx->self;
+    self->apply();
+    ctx->applied.set_value();   // ctx lives on start()'s stack; not touched after this
+
+    self->body_();
+    return nullptr;
+}
+
+// Runs on the new thread, before the body.
+void DeviceThread::apply()
+{
+    if (!options_.name.empty()) {
+        pthread_setname_np(pthread_self(), options_.name.substr(0, 15).c_str());
+    }
+
+    if (options_.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options_.cpu, &set);
+        status_.pinned = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    if (options_.rt_priority > 0) {
+        struct sched_param param = {};
+        param.sched_priority = options_.rt_priority;
+        status_.realtime = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    }
+
+    if (options_.prefault_stack > 0) {
+        size_t bytes = options_.prefault_stack;
+        if (options_.stack_size > 0) {
+            bytes = std::min(bytes, options_.stack_size * 3 / 4);   // leave room for the body
+        }
+        touch_stack(bytes);
+        status_.stack_prefaulted = true;
+    }
+}
+
+} // namespace obu
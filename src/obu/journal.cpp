@@ -0,0 +1,253 @@
+#include "obu/uplink/journal.hpp"
+#include "common/crc16.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+
+namespace obu {
+
+namespace {
+
+bool pread_full(int fd, uint8_t* buf, size_t len, uint64_t offset)
+{
+    while (len > 0) {
+        ssize_t n = ::pread(fd, buf, len, static_cast<off_t>(offset));
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        buf += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+void put_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (v >> 24) & 0xFF;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+uint32_t get_be32(const uint8_t* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+} // anonymous namespace
+
+EventJournal::EventJournal(std::string path, bool sync_on_append)
+    : path_(std::move(path)), sync_on_append_(sync_on_append) {}
+
+EventJournal::~EventJournal()
+{
+    close();
+}
+
+Result<bool> EventJournal::open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        return Result<bool>::success(true);
+    }
+
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    end_ = recover_end();
+    // Drop a torn tail left by a crash mid-append.
+    if (ftruncate(fd_, static_cast<off_t>(end_)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    return Result<bool>::success(true);
+}
+
+void EventJournal::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+uint64_t EventJournal::recover_end()
+{
+    struct stat st;
+    if (fstat(fd_, &st) != 0) return 0;
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+
+    uint64_t pos = 0;
+    std::vector<uint8_t> payload;
+    while (pos + RECORD_HEADER <= size) {
+        uint8_t hdr[RECORD_HEADER];
+        if (!pread_full(fd_, hdr, sizeof(hdr), pos)) break;
+
+        uint32_t len = get_be32(hdr);
+        if (len > MAX_RECORD || pos + RECORD_HEADER + len > size) break;
+
+        payload.resize(len);
+        if (!pread_full(fd_, payload.data(), len, pos + RECORD_HEADER)) break;
+        uint16_t crc = (hdr[4] << 8) | hdr[5];
+        if (CRC16::calculate(payload.data(), len) != crc) break;
+
+        pos += RECORD_HEADER + len;
+    }
+    return pos;
+}
+
+Result<uint64_t> EventJournal::append(const uint8_t* data, size_t len)
+{
+    if (len > MAX_RECORD) {
+        return Result<uint64_t>::failure(Error::WRITE_ERROR);
+    }
+
+    std::vector<uint8_t> record(RECORD_HEADER + len);
+    put_be32(record.data(), static_cast<uint32_t>(len));
+    uint16_t crc = CRC16::calculate(data, len);
+    record[4] = (crc >> 8) & 0xFF;
+    record[5] = crc & 0xFF;
+    std::copy(data, data + len, record.begin() + RECORD_HEADER);
+
+    uint64_t offset;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ < 0) {
+            return Result<uint64_t>::failure(Error::PORT_ERROR);
+        }
+        offset = end_;
+        ssize_t n = ::pwrite(fd_, record.data(), record.size(), static_cast<off_t>(offset));
+        if (n != static_cast<ssize_t>(record.size())) {
+            return Result<uint64_t>::failure(Error::WRITE_ERROR);
+        }
+        if (sync_on_append_) {
+            fdatasync(fd_);
+        }
+        end_ += record.size();
+    }
+    cv_.notify_all();
+    return Result<uint64_t>::success(offset);
+}
+
+Result<uint64_t> EventJournal::append(const std::string& event)
+{
+    return append(reinterpret_cast<const uint8_t*>(event.data()), event.size());
+}
+
+Result<uint64_t> EventJournal::read(uint64_t offset, size_t max_bytes, size_t max_events,
+                                    const RecordFn& fn) const
+{
+    int fd;
+    uint64_t end;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fd = fd_;
+        end = end_;
+    }
+    if (fd < 0) {
+        return Result<uint64_t>::failure(Error::PORT_ERROR);
+    }
+
+    std::vector<uint8_t> payload;
+    size_t bytes = 0;
+    size_t events = 0;
+    while (offset + RECORD_HEADER <= end && events < max_events) {
+        uint8_t hdr[RECORD_HEADER];
+        if (!pread_full(fd, hdr, sizeof(hdr), offset)) {
+            return Result<uint64_t>::failure(Error::READ_ERROR);
+        }
+        uint32_t len = get_be32(hdr);
+        if (len > MAX_RECORD || offset + RECORD_HEADER + len > end) {
+            return Result<uint64_t>::failure(Error::PARSE_ERROR);
+        }
+        // Always take at least one record so an oversized event cannot stall the reader.
+        if (events > 0 && bytes + len > max_bytes) break;
+
+        payload.resize(len);
+        if (!pread_full(fd, payload.data(), len, offset + RECORD_HEADER)) {
+            return Result<uint64_t>::failure(Error::READ_ERROR);
+        }
+        fn(offset, payload.data(), len);
+
+        offset += RECORD_HEADER + len;
+        bytes += len;
+        events++;
+    }
+    return Result<uint64_t>::success(offset);
+}
+
+uint64_t EventJournal::end_offset() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return end_;
+}
+
+bool EventJournal::wait_for_data(uint64_t offset, int timeout_ms, const std::atomic<bool>* running)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [&] { return end_ > offset || (running && !running->load()); };
+    if (timeout_ms < 0) {
+        cv_.wait(lock, ready);
+    } else {
+        cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    }
+    return end_ > offset;
+}
+
+void EventJournal::wake()
+{
+    // Taking the lock orders this against a waiter that is about to sleep.
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    cv_.notify_all();
+}
+
+Result<uint64_t> JournalCursor::load()
+{
+    int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return Result<uint64_t>::success(0);
+        }
+        return Result<uint64_t>::failure(Error::READ_ERROR);
+    }
+
+    uint8_t buf[8];
+    ssize_t n = ::read(fd, buf, sizeof(buf));
+    ::close(fd);
+    if (n != sizeof(buf)) {
+        return Result<uint64_t>::failure(Error::PARSE_ERROR);
+    }
+    uint64_t offset = (uint64_t(get_be32(buf)) << 32) | get_be32(buf + 4);
+    return Result<uint64_t>::success(offset);
+}
+
+Result<bool> JournalCursor::store(uint64_t offset)
+{
+    std::string tmp = path_ + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+
+    uint8_t buf[8];
+    put_be32(buf, static_cast<uint32_t>(offset >> 32));
+    put_be32(buf + 4, static_cast<uint32_t>(offset));
+    bool ok = ::write(fd, buf, sizeof(buf)) == sizeof(buf) && fdatasync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    return Result<bool>::success(true);
+}
+
+} // namespace obu
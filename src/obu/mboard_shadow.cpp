@@ -0,0 +1,254 @@
+#include "obu/devices/mboard_shadow.hpp"
+#include "devices/mboard.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace obu {
+
+namespace {
+
+bool test(const std::array<uint64_t, 4>& bits, size_t reg)
+{
+    return (bits[reg / 64] >> (reg % 64)) & 1;
+}
+
+void set(std::array<uint64_t, 4>& bits, size_t reg)
+{
+    bits[reg / 64] |= 1ull << (reg % 64);
+}
+
+void clear(std::array<uint64_t, 4>& bits, size_t reg)
+{
+    bits[reg / 64] &= ~(1ull << (reg % 64));
+}
+
+} // anonymous namespace
+
+MboardShadow::MboardShadow(Mboard& mboard, CommandScheduler& bus) : MboardShadow(mboard, bus, Options()) {}
+
+MboardShadow::MboardShadow(Mboard& mboard, CommandScheduler& bus, Options options)
+    : mboard_(mboard), bus_(bus), options_(options)
+{
+    options_.max_span = std::max<size_t>(1, std::min<size_t>(options_.max_span, 255));
+}
+
+void MboardShadow::watch(uint8_t start, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t reg = start; reg < REGISTERS && reg < start + count; reg++) {
+        set(watched_, reg);
+    }
+    replan();
+}
+
+std::vector<RegisterSpan> MboardShadow::plan() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return plan_;
+}
+
+// Greedy left to right: a span grows over gaps of up to max_gap unwatched
+// registers and stops at max_span.
+void MboardShadow::replan()
+{
+    plan_.clear();
+    size_t reg = 0;
+    while (reg < REGISTERS) {
+        if (!test(watched_, reg)) {
+            reg++;
+            continue;
+        }
+        size_t start = reg;
+        size_t end = reg + 1;
+        size_t gap = 0;
+        for (size_t next = end; next < REGISTERS && next - start < options_.max_span; next++) {
+            if (test(watched_, next)) {
+                end = next + 1;
+                gap = 0;
+            } else if (++gap > options_.max_gap) {
+                break;
+            }
+        }
+        plan_.push_back(RegisterSpan{static_cast<uint8_t>(start), static_cast<uint8_t>(end - start)});
+        reg = end;
+    }
+}
+
+int MboardShadow::subscribe(uint8_t start, size_t count, Listener listener)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int id = next_id_++;
+    subscribers_.push_back(Subscriber{id, start, count, std::move(listener)});
+    return id;
+}
+
+void MboardShadow::unsubscribe(int id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [id](const Subscriber& s) { return s.id == id; }),
+                       subscribers_.end());
+}
+
+bool MboardShadow::refresh()
+{
+    // Any non-zero key unique to this shadow; the scheduler coalesces on it.
+    uint64_t key = reinterpret_cast<uintptr_t>(this);
+    return bus_.submit(CommandClass::TELEMETRY, [this] {
+        std::vector<RegisterSpan> spans = plan();
+        std::vector<RegisterChange> changes;
+        for (const auto& span : spans) {
+            auto values = mboard_.read_registers(span.start, span.count);
+            transactions_.fetch_add(1, std::memory_order_relaxed);
+            if (!values.ok()) {
+                errors_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            apply(span.start, values.value(), changes);
+        }
+        refreshes_.fetch_add(1, std::memory_order_relaxed);
+        notify(changes);
+    }, nullptr, key);
+}
+
+Result<std::vector<uint8_t>> MboardShadow::read(uint8_t start, uint8_t count, bool fresh)
+{
+    std::vector<uint8_t> values;
+    if (!fresh && cached(start, count, values)) {
+        return Result<std::vector<uint8_t>>::success(std::move(values));
+    }
+    return bus_.call(CommandClass::VALIDATION, [this, start, count] { return fetch(start, count); });
+}
+
+bool MboardShadow::cached(uint8_t start, uint8_t count, std::vector<uint8_t>& out)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (all_valid(start, count)) {
+            size_t n = std::min<size_t>(count, REGISTERS - start);
+            out.assign(values_.begin() + start, values_.begin() + start + n);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+Result<std::vector<uint8_t>> MboardShadow::fetch(uint8_t start, uint8_t count)
+{
+    auto values = mboard_.read_registers(start, count);
+    transactions_.fetch_add(1, std::memory_order_relaxed);
+    if (!values.ok()) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        return values;
+    }
+    std::vector<RegisterChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        apply(start, values.value(), changes);
+    }
+    notify(changes);
+    return values;
+}
+
+void MboardShadow::written(uint8_t start, const std::vector<uint8_t>& values)
+{
+    std::vector<RegisterChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        apply(start, values, changes);
+    }
+    notify(changes);
+}
+
+void MboardShadow::invalidate(uint8_t start, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t reg = start; reg < REGISTERS && reg < start + count; reg++) {
+        clear(valid_, reg);
+    }
+}
+
+bool MboardShadow::all_valid(uint8_t start, size_t count) const
+{
+    for (size_t reg = start; reg < REGISTERS && reg < start + count; reg++) {
+        if (!test(valid_, reg)) return false;
+    }
+    return true;
+}
+
+// Compares eight registers per step; only words that differ are walked byte
+// by byte, so an unchanged span costs a handful of compares.
+void MboardShadow::apply(uint8_t start, const std::vector<uint8_t>& values, std::vector<RegisterChange>& changes)
+{
+    size_t n = std::min(values.size(), REGISTERS - start);
+    uint8_t* shadow = values_.data() + start;
+    const uint8_t* fresh = values.data();
+
+    auto compare = [&](size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            if (shadow[i] != fresh[i] && test(valid_, start + i)) {
+                changes.push_back(RegisterChange{static_cast<uint8_t>(start + i), shadow[i], fresh[i]});
+            }
+        }
+    };
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t old_word, new_word;
+        memcpy(&old_word, shadow + i, 8);
+        memcpy(&new_word, fresh + i, 8);
+        if (old_word != new_word) compare(i, i + 8);
+    }
+    compare(i, n);
+
+    memcpy(shadow, fresh, n);
+    for (size_t reg = start; reg < start + n; reg++) {
+        set(valid_, reg);
+    }
+}
+
+void MboardShadow::notify(const std::vector<RegisterChange>& changes)
+{
+    if (changes.empty()) return;
+    changes_.fetch_add(changes.size(), std::memory_order_relaxed);
+
+    std::vector<std::pair<Listener, std::vector<RegisterChange>>> calls;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& sub : subscribers_) {
+            std::vector<RegisterChange> mine;
+            for (const auto& change : changes) {
+                if (change.reg >= sub.start && change.reg < sub.start + sub.count) mine.push_back(change);
+            }
+            if (!mine.empty()) calls.emplace_back(sub.listener, std::move(mine));
+        }
+    }
+    for (const auto& call : calls) {
+        call.first(call.second);
+    }
+}
+
+void MboardShadow::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    registry.counter("obu_register_shadow_reads_total", "Register reads, by whether the shadow could answer.",
+                     {{"device", name}, {"result", "hit"}},
+                     [this] { return static_cast<double>(hits_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_shadow_reads_total", "Register reads, by whether the shadow could answer.",
+                     {{"device", name}, {"result", "miss"}},
+                     [this] { return static_cast<double>(misses_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_shadow_transactions_total", "READ_REGISTERS sent by the shadow.", {{"device", name}},
+                     [this] { return static_cast<double>(transactions_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_shadow_refreshes_total", "Completed refreshes of the watched registers.",
+                     {{"device", name}},
+                     [this] { return static_cast<double>(refreshes_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_shadow_changes_total", "Register changes delivered to subscribers.",
+                     {{"device", name}},
+                     [this] { return static_cast<double>(changes_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_shadow_errors_total", "Failed READ_REGISTERS.", {{"device", name}},
+                     [this] { return static_cast<double>(errors_.load(std::memory_order_relaxed)); });
+}
+
+} // namespace obu
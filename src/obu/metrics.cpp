@@ -0,0 +1,180 @@
+#include "obu/common/metrics.hpp"
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace obu {
+
+namespace {
+
+void write_labels(std::ostringstream& out, const MetricsRegistry::Labels& labels, const char* extra_key = nullptr,
+                  const std::string& extra_value = std::string())
+{
+    if (labels.empty() && !extra_key) return;
+
+    out << '{';
+    bool first = true;
+    for (const auto& label : labels) {
+        if (!first) out << ',';
+        out << label.first << "=\"";
+        for (char c : label.second) {
+            if (c == '\\' || c == '"') out << '\\' << c;
+            else if (c == '\n') out << "\\n";
+            else out << c;
+        }
+        out << '"';
+        first = false;
+    }
+    if (extra_key) {
+        if (!first) out << ',';
+        out << extra_key << "=\"" << extra_value << '"';
+    }
+    out << '}';
+}
+
+void write_value(std::ostringstream& out, double value)
+{
+    if (std::isnan(value)) {
+        out << "NaN";
+    } else if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        out << static_cast<int64_t>(value);
+    } else {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.9g", value);
+        out << buf;
+    }
+}
+
+void write_histogram(std::ostringstream& out, const std::string& name, const MetricsRegistry::Labels& labels,
+                     const LatencyHistogram& histogram)
+{
+    // Buckets are read one by one while observers keep adding, so the count
+    // is taken as the sum actually read and the series stays monotonic.
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::BOUNDS_US.size(); i++) {
+        cumulative += histogram.bucket(i);
+        char le[32];
+        snprintf(le, sizeof(le), "%g", LatencyHistogram::BOUNDS_US[i] / 1e6);
+        out << name << "_bucket";
+        write_labels(out, labels, "le", le);
+        out << ' ' << cumulative << '\n';
+    }
+    cumulative += histogram.bucket(LatencyHistogram::BOUNDS_US.size());
+    out << name << "_bucket";
+    write_labels(out, labels, "le", "+Inf");
+    out << ' ' << cumulative << '\n';
+
+    out << name << "_sum";
+    write_labels(out, labels);
+    out << ' ';
+    write_value(out, histogram.sum_us() / 1e6);
+    out << '\n';
+    out << name << "_count";
+    write_labels(out, labels);
+    out << ' ' << cumulative << '\n';
+}
+
+} // anonymous namespace
+
+void LatencyHistogram::observe(std::chrono::microseconds elapsed)
+{
+    int64_t us = elapsed.count() < 0 ? 0 : elapsed.count();
+    size_t i = 0;
+    while (i < BOUNDS_US.size() && us > BOUNDS_US[i]) i++;
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(static_cast<uint64_t>(us), std::memory_order_relaxed);
+}
+
+CommandLatency::~CommandLatency()
+{
+    for (auto& slot : slots_) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+void CommandLatency::observe(uint8_t command, std::chrono::microseconds elapsed)
+{
+    LatencyHistogram* histogram = slots_[command].load(std::memory_order_acquire);
+    if (!histogram) {
+        auto* created = new LatencyHistogram();
+        if (slots_[command].compare_exchange_strong(histogram, created, std::memory_order_acq_rel)) {
+            histogram = created;
+        } else {
+            delete created;     // another thread installed one first
+        }
+    }
+    histogram->observe(elapsed);
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Type type)
+{
+    for (auto& f : families_) {
+        if (f.name == name) return f;
+    }
+    families_.push_back(Family{name, help, type, {}});
+    return families_.back();
+}
+
+void MetricsRegistry::counter(const std::string& name, const std::string& help, Labels labels, Reader read)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    family(name, help, Type::COUNTER).series.push_back(Series{std::move(labels), std::move(read), nullptr, nullptr});
+}
+
+void MetricsRegistry::gauge(const std::string& name, const std::string& help, Labels labels, Reader read)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    family(name, help, Type::GAUGE).series.push_back(Series{std::move(labels), std::move(read), nullptr, nullptr});
+}
+
+void MetricsRegistry::histogram(const std::string& name, const std::string& help, Labels labels,
+                                const LatencyHistogram& histogram)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    family(name, help, Type::HISTOGRAM).series.push_back(Series{std::move(labels), nullptr, &histogram, nullptr});
+}
+
+void MetricsRegistry::histogram(const std::string& name, const std::string& help, Labels labels,
+                                const CommandLatency& commands)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    family(name, help, Type::HISTOGRAM).series.push_back(Series{std::move(labels), nullptr, nullptr, &commands});
+}
+
+std::string MetricsRegistry::render() const
+{
+    static const char* TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const auto& f : families_) {
+        out << "# HELP " << f.name << ' ' << f.help << '\n';
+        out << "# TYPE " << f.name << ' ' << TYPE_NAMES[static_cast<int>(f.type)] << '\n';
+
+        for (const auto& s : f.series) {
+            if (s.histogram) {
+                write_histogram(out, f.name, s.labels, *s.histogram);
+            } else if (s.commands) {
+                for (int command = 0; command < 256; command++) {
+                    const LatencyHistogram* histogram = s.commands->get(static_cast<uint8_t>(command));
+                    if (!histogram) continue;
+                    char hex[8];
+                    snprintf(hex, sizeof(hex), "0x%02X", command);
+                    Labels labels = s.labels;
+                    labels.emplace_back("command", hex);
+                    write_histogram(out, f.name, labels, *histogram);
+                }
+            } else {
+                out << f.name;
+                write_labels(out, s.labels);
+                out << ' ';
+                write_value(out, s.read());
+                out << '\n';
+            }
+        }
+    }
+    return out.str();
+}
+
+} // namespace obu
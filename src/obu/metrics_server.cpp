@@ -0,0 +1,132 @@
+#include "obu/common/metrics_server.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <cerrno>
+
+namespace obu {
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry, std::string path)
+    : registry_(registry), path_(std::move(path))
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+Result<bool> MetricsServer::start()
+{
+    if (running_.load()) {
+        return Result<bool>::success(true);
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+    memcpy(addr.sun_path, path_.c_str(), path_.size());
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    // A socket file left by a previous run would make bind() fail.
+    ::unlink(path_.c_str());
+    if (::bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listen_fd_, 4) < 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    cancel_.reset();
+    running_.store(true);
+    thread_ = std::thread([this] { run(); });
+    return Result<bool>::success(true);
+}
+
+void MetricsServer::stop()
+{
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    cancel_.cancel();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(path_.c_str());
+}
+
+void MetricsServer::run()
+{
+    while (running_.load()) {
+        struct pollfd pfds[2] = {
+            {cancel_.fd(), POLLIN, 0},
+            {listen_fd_, POLLIN, 0},
+        };
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfds[0].revents & POLLIN) {
+            break;
+        }
+        if (pfds[1].revents & POLLIN) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                serve(fd);
+                ::close(fd);
+            }
+        }
+    }
+}
+
+// Reads whatever request arrives within REQUEST_TIMEOUT_MS (HTTP clients send
+// theirs at once, plain readers send nothing), then writes the exposition.
+void MetricsServer::serve(int fd)
+{
+    char request[512];
+    size_t got = 0;
+    struct pollfd pfds[2] = {
+        {fd, POLLIN, 0},
+        {cancel_.fd(), POLLIN, 0},
+    };
+    while (got < sizeof(request) && poll(pfds, 2, REQUEST_TIMEOUT_MS) > 0 && !(pfds[1].revents & POLLIN)) {
+        ssize_t n = ::read(fd, request + got, sizeof(request) - got);
+        if (n <= 0) break;
+        got += n;
+        if (memmem(request, got, "\r\n\r\n", 4) || memmem(request, got, "\n\n", 2)) break;
+    }
+
+    std::string body = registry_.render();
+    std::string reply;
+    if (got >= 4 && memcmp(request, "GET ", 4) == 0) {
+        reply = "HTTP/1.0 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                "Connection: close\r\n\r\n";
+    }
+    reply += body;
+
+    const char* p = reply.data();
+    size_t left = reply.size();
+    while (left > 0) {
+        ssize_t n = ::send(fd, p, left, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        p += n;
+        left -= n;
+    }
+    scrapes_.fetch_add(1);
+}
+
+} // namespace obu
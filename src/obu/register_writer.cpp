@@ -0,0 +1,242 @@
+#include "obu/devices/register_writer.hpp"
+#include "devices/mboard.hpp"
+#include <algorithm>
+#include <memory>
+
+namespace obu {
+
+namespace {
+
+bool test(const std::array<uint64_t, 4>& bits, size_t reg)
+{
+    return (bits[reg / 64] >> (reg % 64)) & 1;
+}
+
+void set(std::array<uint64_t, 4>& bits, size_t reg)
+{
+    bits[reg / 64] |= 1ull << (reg % 64);
+}
+
+} // anonymous namespace
+
+RegisterWriter::RegisterWriter(Mboard& mboard, CommandScheduler& bus) : RegisterWriter(mboard, bus, Options()) {}
+
+RegisterWriter::RegisterWriter(Mboard& mboard, CommandScheduler& bus, Options options)
+    : mboard_(mboard), bus_(bus), options_(std::move(options))
+{
+    options_.max_span = std::max<size_t>(1, std::min<size_t>(options_.max_span, 255));
+}
+
+RegisterWriter::~RegisterWriter()
+{
+    stop();
+}
+
+Result<bool> RegisterWriter::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return Result<bool>::success(true);
+        }
+        running_ = true;
+    }
+    auto started = thread_.start(options_.thread, [this] { run(); });
+    if (!started.ok()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    return started;
+}
+
+void RegisterWriter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!batch_.empty()) {
+        submit(lock);
+    }
+}
+
+std::future<Result<bool>> RegisterWriter::write(uint8_t reg, uint8_t value)
+{
+    return write(reg, std::vector<uint8_t>{value});
+}
+
+std::future<Result<bool>> RegisterWriter::write(uint8_t start, std::vector<uint8_t> values)
+{
+    auto promise = std::make_shared<std::promise<Result<bool>>>();
+    auto future = promise->get_future();
+    write(start, std::move(values), [promise](const Result<bool>& result) { promise->set_value(result); });
+    return future;
+}
+
+void RegisterWriter::write(uint8_t start, std::vector<uint8_t> values, Done done)
+{
+    if (values.empty() || start + values.size() > MboardShadow::REGISTERS) {
+        done(Result<bool>::failure(Error::CMD_FAILURE));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_) {
+        lock.unlock();
+        done(Result<bool>::failure(Error::CMD_FAILURE));
+        return;
+    }
+
+    bool opened = batch_.empty();
+    if (opened) {
+        batch_.opened = Clock::now();
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+        size_t reg = start + i;
+        if (test(batch_.staged, reg)) {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+        }
+        set(batch_.staged, reg);
+        batch_.values[reg] = values[i];
+    }
+    batch_.pending.push_back(Pending{start, values.size(), std::move(done)});
+    writes_.fetch_add(1, std::memory_order_relaxed);
+    lock.unlock();
+
+    if (opened) {
+        cv_.notify_one();
+    }
+}
+
+void RegisterWriter::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (batch_.empty()) return;
+        flush_now_ = true;
+    }
+    cv_.notify_one();
+}
+
+void RegisterWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        if (batch_.empty() || job_queued_) {
+            cv_.wait(lock);
+            continue;
+        }
+        auto due = batch_.opened + options_.window;
+        if (!flush_now_ && Clock::now() < due) {
+            cv_.wait_until(lock, due);
+            continue;
+        }
+        flush_now_ = false;
+        submit(lock);
+    }
+}
+
+void RegisterWriter::submit(std::unique_lock<std::mutex>& lock)
+{
+    if (job_queued_) return;
+    job_queued_ = true;
+    lock.unlock();
+
+    // The job takes the batch as it stands when the bus gets to it.
+    auto take = [this] {
+        Batch batch;
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            batch = std::move(batch_);
+            batch_ = Batch();
+            job_queued_ = false;
+        }
+        cv_.notify_one();
+        return batch;
+    };
+    bus_.submit(options_.command_class, [this, take] { send(take()); },
+                [this, take](Error error) { fail(take(), error); });
+
+    lock.lock();
+}
+
+void RegisterWriter::send(Batch batch)
+{
+    if (batch.empty()) return;
+    send_delay_.observe(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - batch.opened));
+
+    struct Frame
+    {
+        size_t start;
+        size_t end;
+        Result<bool> result;
+    };
+    std::vector<Frame> frames;
+
+    size_t reg = 0;
+    while (reg < MboardShadow::REGISTERS) {
+        if (!test(batch.staged, reg)) {
+            reg++;
+            continue;
+        }
+        size_t start = reg;
+        while (reg < MboardShadow::REGISTERS && test(batch.staged, reg) && reg - start < options_.max_span) {
+            reg++;
+        }
+        std::vector<uint8_t> values(batch.values.begin() + start, batch.values.begin() + reg);
+        auto result = mboard_.write_registers(static_cast<uint8_t>(start), values);
+        frames_.fetch_add(1, std::memory_order_relaxed);
+        if (!result.ok()) {
+            errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Before completing the writes, so a caller that waited sees its own values.
+        if (shadow_ && result.ok()) {
+            shadow_->written(static_cast<uint8_t>(start), values);
+        } else if (shadow_) {
+            shadow_->invalidate(static_cast<uint8_t>(start), values.size());
+        }
+        frames.push_back(Frame{start, reg, result});
+    }
+
+    for (auto& pending : batch.pending) {
+        Result<bool> result = Result<bool>::success(true);
+        for (const auto& frame : frames) {
+            if (frame.start < pending.start + pending.count && pending.start < frame.end && !frame.result.ok()) {
+                result = frame.result;
+                break;
+            }
+        }
+        pending.done(result);
+    }
+}
+
+void RegisterWriter::fail(Batch batch, Error error)
+{
+    for (auto& pending : batch.pending) {
+        pending.done(Result<bool>::failure(error));
+    }
+}
+
+void RegisterWriter::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    registry.counter("obu_register_writes_total", "write() calls accepted.", {{"device", name}},
+                     [this] { return static_cast<double>(writes_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_write_frames_total", "WRITE_REGISTERS frames sent.", {{"device", name}},
+                     [this] { return static_cast<double>(frames_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_writes_coalesced_total", "Staged register values replaced before sending.",
+                     {{"device", name}},
+                     [this] { return static_cast<double>(coalesced_.load(std::memory_order_relaxed)); });
+    registry.counter("obu_register_write_errors_total", "Failed WRITE_REGISTERS frames.", {{"device", name}},
+                     [this] { return static_cast<double>(errors_.load(std::memory_order_relaxed)); });
+    registry.histogram("obu_register_write_delay_seconds", "Time from the first write of a batch to its send.",
+                       {{"device", name}}, send_delay_);
+}
+
+} // namespace obu
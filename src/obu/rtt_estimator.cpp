@@ -0,0 +1,39 @@
+#include "obu/common/rtt_estimator.hpp"
+#include <algorithm>
+
+namespace obu {
+
+RttEstimator::RttEstimator(int initial_timeout_ms, int min_timeout_ms, int max_timeout_ms)
+    : min_timeout_ms_(min_timeout_ms),
+      max_timeout_ms_(max_timeout_ms),
+      timeout_ms_(std::clamp(initial_timeout_ms, min_timeout_ms, max_timeout_ms))
+{
+}
+
+void RttEstimator::sample(std::chrono::microseconds rtt)
+{
+    using std::chrono::microseconds;
+
+    if (samples_ == 0) {
+        srtt_ = rtt;
+        rttvar_ = rtt / 2;
+    } else {
+        // alpha = 1/8, beta = 1/4
+        microseconds err = rtt > srtt_ ? rtt - srtt_ : srtt_ - rtt;
+        rttvar_ = (rttvar_ * 3 + err) / 4;
+        srtt_ = (srtt_ * 7 + rtt) / 8;
+    }
+    samples_++;
+
+    auto rto = srtt_ + std::max(microseconds(1000), rttvar_ * 4);
+    int ms = static_cast<int>((rto.count() + 999) / 1000);
+    timeout_ms_ = std::clamp(ms, min_timeout_ms_, max_timeout_ms_);
+}
+
+void RttEstimator::backoff()
+{
+    timeouts_++;
+    timeout_ms_ = std::min(timeout_ms_ * 2, max_timeout_ms_);
+}
+
+} // namespace obu
@@ -0,0 +1,185 @@
+#include "obu/uplink/standin_server.hpp"
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cstring>
+#include <cerrno>
+
+namespace obu {
+
+StandInServer::StandInServer(int port) : port_(port) {}
+
+StandInServer::~StandInServer()
+{
+    stop();
+}
+
+Result<bool> StandInServer::start()
+{
+    if (running_.load()) {
+        return Result<bool>::success(true);
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t addr_len = sizeof(addr);
+    if (::bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, 4) < 0 ||
+        getsockname(listen_fd_, (struct sockaddr*)&addr, &addr_len) < 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+    port_ = ntohs(addr.sin_port);
+
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    running_.store(true);
+    thread_ = std::thread([this] { run(); });
+    return Result<bool>::success(true);
+}
+
+void StandInServer::stop()
+{
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    (void)::write(wake_fd_, &one, sizeof(one));
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    close_client();
+    ::close(listen_fd_);
+    ::close(wake_fd_);
+    listen_fd_ = -1;
+    wake_fd_ = -1;
+}
+
+void StandInServer::drop_connection()
+{
+    drop_requested_.store(true);
+    uint64_t one = 1;
+    (void)::write(wake_fd_, &one, sizeof(one));
+}
+
+void StandInServer::close_client()
+{
+    if (client_fd_ >= 0) {
+        ::close(client_fd_);
+        client_fd_ = -1;
+    }
+    reader_.clear();
+}
+
+void StandInServer::run()
+{
+    while (running_.load()) {
+        struct pollfd pfds[3] = {
+            {wake_fd_, POLLIN, 0},
+            {listen_fd_, POLLIN, 0},
+            {client_fd_, POLLIN, 0},
+        };
+        int nfds = client_fd_ >= 0 ? 3 : 2;
+
+        if (poll(pfds, nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (pfds[0].revents & POLLIN) {
+            uint64_t v;
+            (void)::read(wake_fd_, &v, sizeof(v));
+            if (drop_requested_.exchange(false)) {
+                close_client();
+            }
+            continue;
+        }
+
+        if (pfds[1].revents & POLLIN) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                close_client();
+                client_fd_ = fd;
+            }
+            continue;
+        }
+
+        if (nfds == 3 && pfds[2].revents) {
+            uint8_t buf[4096];
+            ssize_t n = ::recv(client_fd_, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                close_client();
+                continue;
+            }
+            bytes_ += n;
+            reader_.feed(buf, n);
+
+            uplink::Frame frame;
+            while (true) {
+                auto got = reader_.next(frame);
+                if (!got.ok() || (got.value() && !handle_frame(frame))) {
+                    close_client();
+                    break;
+                }
+                if (!got.value()) break;
+            }
+        }
+    }
+}
+
+bool StandInServer::handle_frame(const uplink::Frame& frame)
+{
+    if (frame.type == uplink::MSG_BATCH) {
+        auto batch = uplink::decode_batch(frame.body);
+        if (!batch.ok()) {
+            return false;
+        }
+        // A batch starting past what we hold would leave a hole in the
+        // stream; drop the client rather than ack over it.
+        if (batch.value().first_offset > committed_.load()) {
+            return false;
+        }
+        // Replays after a lost ack are acknowledged but not delivered twice.
+        if (batch.value().next_offset > committed_.load()) {
+            auto events = uplink::split_events(batch.value());
+            if (!events.ok()) {
+                return false;
+            }
+            for (const auto& event : events.value()) {
+                if (event_callback_) event_callback_(event);
+            }
+            events_ += events.value().size();
+            committed_.store(batch.value().next_offset);
+        }
+    } else if (frame.type != uplink::MSG_HELLO) {
+        return false;
+    }
+
+    auto ack = uplink::encode_ack(committed_.load());
+    return ::send(client_fd_, ack.data(), ack.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(ack.size());
+}
+
+} // namespace obu
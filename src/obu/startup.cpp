@@ -0,0 +1,172 @@
+#include "obu/common/startup.hpp"
+#include <time.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <iomanip>
+
+namespace obu {
+
+namespace {
+
+constexpr int BAR_WIDTH = 50;
+
+std::chrono::milliseconds boot_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::nanoseconds(ts.tv_nsec));
+}
+
+double to_ms(StartupOrchestrator::Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+const char* outcome_name(StartupOrchestrator::Outcome outcome)
+{
+    switch (outcome) {
+        case StartupOrchestrator::Outcome::OK: return "ok";
+        case StartupOrchestrator::Outcome::FAILED: return "FAILED";
+        case StartupOrchestrator::Outcome::SKIPPED: return "skipped";
+        default: return "pending";
+    }
+}
+
+} // anonymous namespace
+
+void StartupOrchestrator::add(std::string name, Step step, std::vector<std::string> after, bool required)
+{
+    Entry entry;
+    entry.name = std::move(name);
+    entry.after = std::move(after);
+    entry.required = required;
+    entries_.push_back(std::move(entry));
+    steps_.push_back(std::move(step));
+}
+
+Result<bool> StartupOrchestrator::run()
+{
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::vector<std::thread> threads;
+    std::vector<bool> launched(entries_.size(), false);
+    size_t running = 0;
+
+    auto begin = Clock::now();
+    auto boot_at_begin = boot_time();
+    for (auto& entry : entries_) {
+        entry.outcome = Outcome::PENDING;
+    }
+
+    auto find = [this](const std::string& name) -> const Entry* {
+        for (const auto& entry : entries_) {
+            if (entry.name == name) return &entry;
+        }
+        return nullptr;
+    };
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        // Launch or skip until nothing changes; a skip can unblock further skips.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                Entry& entry = entries_[i];
+                if (launched[i] || entry.outcome != Outcome::PENDING) continue;
+
+                bool ready = true;
+                bool blocked = false;
+                for (const auto& dep : entry.after) {
+                    const Entry* other = find(dep);
+                    if (!other || other->outcome == Outcome::FAILED || other->outcome == Outcome::SKIPPED) {
+                        blocked = true;
+                        break;
+                    }
+                    if (other->outcome != Outcome::OK) ready = false;
+                }
+
+                if (blocked) {
+                    entry.outcome = Outcome::SKIPPED;
+                    entry.started = entry.finished = Clock::now() - begin;
+                    changed = true;
+                    continue;
+                }
+                if (!ready) continue;
+
+                launched[i] = true;
+                running++;
+                entry.started = Clock::now() - begin;
+                threads.emplace_back([&, i] {
+                    auto result = steps_[i]();
+                    std::lock_guard<std::mutex> guard(mutex);
+                    Entry& done = entries_[i];
+                    done.finished = Clock::now() - begin;
+                    done.outcome = result.ok() ? Outcome::OK : Outcome::FAILED;
+                    if (!result.ok()) done.error = result.error();
+                    running--;
+                    finished.notify_one();
+                });
+            }
+        }
+        if (running == 0) break;
+        finished.wait(lock);
+    }
+    lock.unlock();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Whatever is still pending waits on a cycle.
+    bool ok = true;
+    ready_after_ = Clock::duration::zero();
+    for (auto& entry : entries_) {
+        if (entry.outcome == Outcome::PENDING) {
+            entry.outcome = Outcome::SKIPPED;
+        }
+        if (!entry.required) continue;
+        if (entry.outcome != Outcome::OK) {
+            ok = false;
+        }
+        ready_after_ = std::max(ready_after_, entry.finished);
+    }
+    ready_since_boot_ = boot_at_begin + std::chrono::duration_cast<std::chrono::milliseconds>(ready_after_);
+
+    if (!ok) {
+        return Result<bool>::failure(Error::DEVICE_ERROR);
+    }
+    return Result<bool>::success(true);
+}
+
+void StartupOrchestrator::print(std::ostream& out) const
+{
+    auto total = Clock::duration::zero();
+    size_t width = 0;
+    for (const auto& entry : entries_) {
+        total = std::max(total, entry.finished);
+        width = std::max(width, entry.name.size());
+    }
+    double scale = total > Clock::duration::zero() ? BAR_WIDTH / to_ms(total) : 0.0;
+
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    for (const auto& entry : entries_) {
+        int from = static_cast<int>(to_ms(entry.started) * scale);
+        int to = std::max(from + 1, static_cast<int>(to_ms(entry.finished) * scale));
+        out << std::left << std::setw(static_cast<int>(width)) << entry.name << std::right
+            << "  " << std::setw(7) << to_ms(entry.started) << " - " << std::setw(7) << to_ms(entry.finished)
+            << " ms  |" << std::string(from, ' ') << std::string(to - from, '#')
+            << std::string(std::max(0, BAR_WIDTH - to), ' ') << "|  " << outcome_name(entry.outcome);
+        if (!entry.required) out << " (optional)";
+        out << "\n";
+    }
+    out << "ready after " << to_ms(ready_after_) << " ms, "
+        << ready_since_boot_.count() / 1000.0 << " s since boot\n";
+    out.flags(flags);
+}
+
+} // namespace obu
@@ -0,0 +1,142 @@
+#include "obu/common/state_snapshot.hpp"
+#include "common/crc16.hpp"
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+namespace obu {
+
+static_assert(std::is_trivially_copyable<DeviceState>::value, "DeviceState is stored byte for byte");
+
+namespace {
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x4F425553;    // "OBUS"
+constexpr uint16_t SNAPSHOT_VERSION = 1;
+
+} // anonymous namespace
+
+struct StateSnapshot::Slot
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t crc;           // over everything after this field
+    uint64_t sequence;
+    uint32_t size;
+    char boot_id[40];
+    DeviceState state;
+};
+
+namespace {
+
+constexpr size_t CRC_OFFSET = sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint16_t);
+
+uint16_t slot_crc(const void* slot, size_t size)
+{
+    auto* bytes = static_cast<const uint8_t*>(slot);
+    return CRC16::calculate(bytes + CRC_OFFSET, size - CRC_OFFSET);
+}
+
+void read_boot_id(char* out, size_t len)
+{
+    int fd = ::open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    ssize_t n = ::read(fd, out, len - 1);
+    ::close(fd);
+    if (n > 0 && out[n - 1] == '\n') n--;
+    out[n > 0 ? n : 0] = '\0';
+}
+
+} // anonymous namespace
+
+StateSnapshot::StateSnapshot(std::string path)
+    : path_(std::move(path))
+{
+}
+
+StateSnapshot::~StateSnapshot()
+{
+    close();
+}
+
+Result<bool> StateSnapshot::open()
+{
+    if (fd_ >= 0) {
+        return Result<bool>::success(restored_);
+    }
+
+    read_boot_id(boot_id_, sizeof(boot_id_));
+
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd_ < 0) {
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    const size_t bytes = 2 * sizeof(Slot);
+    if (ftruncate(fd_, bytes) != 0) {
+        close();
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        close();
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    slots_ = static_cast<Slot*>(map);
+
+    const Slot* best = nullptr;
+    for (int i = 0; i < 2; ++i) {
+        const Slot& slot = slots_[i];
+        if (slot.magic != SNAPSHOT_MAGIC || slot.version != SNAPSHOT_VERSION || slot.size != sizeof(Slot)) continue;
+        if (slot.crc != slot_crc(&slot, sizeof(Slot))) continue;
+        if (std::strncmp(slot.boot_id, boot_id_, sizeof(boot_id_)) != 0) continue;
+        if (!best || slot.sequence > best->sequence) best = &slot;
+    }
+
+    restored_ = best != nullptr;
+    if (best) {
+        std::memcpy(&state_, &best->state, sizeof(state_));
+        sequence_ = best->sequence;
+    } else {
+        std::memset(&state_, 0, sizeof(state_));
+        sequence_ = 0;
+    }
+    return Result<bool>::success(restored_);
+}
+
+void StateSnapshot::close()
+{
+    if (slots_) {
+        munmap(slots_, 2 * sizeof(Slot));
+        slots_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+// Writes into the slot not holding the current sequence. No msync: the page
+// cache outlives the process, and a reboot invalidates the state anyway.
+Result<bool> StateSnapshot::commit()
+{
+    if (!slots_) {
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+
+    sequence_++;
+    Slot& slot = slots_[sequence_ & 1];
+    slot.magic = 0;     // not loadable while half written
+    slot.version = SNAPSHOT_VERSION;
+    slot.sequence = sequence_;
+    slot.size = sizeof(Slot);
+    std::memcpy(slot.boot_id, boot_id_, sizeof(slot.boot_id));
+    std::memcpy(&slot.state, &state_, sizeof(state_));
+    slot.crc = slot_crc(&slot, sizeof(Slot));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot.magic = SNAPSHOT_MAGIC;
+    return Result<bool>::success(true);
+}
+
+} // namespace obu
@@ -0,0 +1,273 @@
+#include "obu/common/status_segment.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <cstring>
+#include <type_traits>
+
+namespace obu {
+
+struct StatusSegment
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t status_size;
+    int32_t publisher_pid;
+    uint32_t sequence;          // odd while a publish is in progress
+    uint32_t reserved;
+    DeviceStatus status;
+};
+
+static_assert(std::is_trivially_copyable<DeviceStatus>::value, "DeviceStatus is shared byte for byte");
+static_assert(sizeof(DeviceStatus) == 664, "DeviceStatus layout is part of the segment version");
+static_assert(sizeof(DeviceStatus) % sizeof(uint32_t) == 0, "copied as 32-bit words");
+static_assert(offsetof(StatusSegment, status) == 24, "StatusSegment header layout");
+
+namespace {
+
+constexpr uint32_t SEGMENT_MAGIC = 0x4F425354;     // "OBST"
+constexpr uint16_t SEGMENT_VERSION = 1;
+constexpr size_t STATUS_WORDS = sizeof(DeviceStatus) / sizeof(uint32_t);
+
+uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// Word-wise relaxed atomic copies, so the reader's copy racing a publish is
+// well defined; the sequence check then throws the torn copy away.
+void store_words(uint32_t* dst, const uint32_t* src)
+{
+    for (size_t i = 0; i < STATUS_WORDS; i++) {
+        __atomic_store_n(&dst[i], src[i], __ATOMIC_RELAXED);
+    }
+}
+
+void load_words(uint32_t* dst, const uint32_t* src)
+{
+    for (size_t i = 0; i < STATUS_WORDS; i++) {
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+    }
+}
+
+void copy_text(char* dst, size_t capacity, const std::string& text, size_t& len)
+{
+    len = text.size() < capacity ? text.size() : capacity - 1;
+    std::memcpy(dst, text.data(), len);
+    std::memset(dst + len, 0, capacity - len);
+}
+
+} // anonymous namespace
+
+StatusPublisher::StatusPublisher(std::string name)
+    : name_(std::move(name))
+{
+}
+
+StatusPublisher::~StatusPublisher()
+{
+    close();
+}
+
+Result<bool> StatusPublisher::open()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (segment_) {
+        return Result<bool>::success(true);
+    }
+
+    int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    if (ftruncate(fd, sizeof(StatusSegment)) != 0) {
+        ::close(fd);
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    void* map = mmap(nullptr, sizeof(StatusSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+    segment_ = static_cast<StatusSegment*>(map);
+
+    // Keep the sequence going across restarts so a reader never sees it move
+    // backwards, and step over a publish a crashed predecessor left open.
+    uint32_t seq = __atomic_load_n(&segment_->sequence, __ATOMIC_RELAXED);
+    if (segment_->magic != SEGMENT_MAGIC) seq = 0;
+    uint32_t writing = seq | 1u;
+    __atomic_store_n(&segment_->sequence, writing, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    segment_->version = SEGMENT_VERSION;
+    segment_->header_size = offsetof(StatusSegment, status);
+    segment_->status_size = sizeof(DeviceStatus);
+    segment_->publisher_pid = getpid();
+    std::memset(&shadow_, 0, sizeof(shadow_));
+    store_words(reinterpret_cast<uint32_t*>(&segment_->status), reinterpret_cast<const uint32_t*>(&shadow_));
+
+    __atomic_store_n(&segment_->sequence, writing + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&segment_->magic, SEGMENT_MAGIC, __ATOMIC_RELEASE);
+    return Result<bool>::success(true);
+}
+
+void StatusPublisher::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (segment_) {
+        munmap(segment_, sizeof(StatusSegment));
+        segment_ = nullptr;
+    }
+}
+
+void StatusPublisher::unlink()
+{
+    shm_unlink(name_.c_str());
+}
+
+// Caller holds mutex_.
+void StatusPublisher::publish()
+{
+    if (!segment_) return;
+
+    uint32_t seq = __atomic_load_n(&segment_->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&segment_->sequence, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    store_words(reinterpret_cast<uint32_t*>(&segment_->status), reinterpret_cast<const uint32_t*>(&shadow_));
+    __atomic_store_n(&segment_->sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+void StatusPublisher::publish_mboard(const AliveResponse& alive)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    shadow_.mboard = alive;
+    shadow_.mboard_updated_ns = monotonic_ns();
+    publish();
+}
+
+void StatusPublisher::publish_terminal(TerminalAddress addr, const TerminalAliveResponse& alive)
+{
+    size_t index = static_cast<uint8_t>(addr) - static_cast<uint8_t>(TerminalAddress::TERMINAL_A);
+    if (index >= DeviceStatus::TERMINALS) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    shadow_.terminal[index] = alive;
+    shadow_.terminal_updated_ns[index] = monotonic_ns();
+    publish();
+}
+
+void StatusPublisher::publish_uid(StatusSource source, const std::string& uid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t len;
+    copy_text(shadow_.uid, DeviceStatus::UID_LEN, uid, len);
+    shadow_.uid_len = static_cast<uint8_t>(len);
+    shadow_.uid_source = source;
+    shadow_.uid_count++;
+    shadow_.uid_updated_ns = monotonic_ns();
+    publish();
+}
+
+void StatusPublisher::publish_qr(const std::string& code)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t len;
+    copy_text(shadow_.qr_code, DeviceStatus::CODE_LEN, code, len);
+    shadow_.qr_len = static_cast<uint16_t>(len);
+    shadow_.qr_count++;
+    shadow_.qr_updated_ns = monotonic_ns();
+    publish();
+}
+
+StatusReader::StatusReader(std::string name)
+    : name_(std::move(name))
+{
+}
+
+StatusReader::~StatusReader()
+{
+    close();
+}
+
+Result<bool> StatusReader::open()
+{
+    if (segment_) {
+        return Result<bool>::success(true);
+    }
+
+    int fd = shm_open(name_.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return Result<bool>::failure(Error::READ_ERROR);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(StatusSegment)) {
+        ::close(fd);
+        return Result<bool>::failure(Error::READ_ERROR);
+    }
+    void* map = mmap(nullptr, sizeof(StatusSegment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return Result<bool>::failure(Error::READ_ERROR);
+    }
+
+    auto* segment = static_cast<const StatusSegment*>(map);
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != SEGMENT_MAGIC ||
+        segment->version != SEGMENT_VERSION ||
+        segment->header_size != offsetof(StatusSegment, status) ||
+        segment->status_size != sizeof(DeviceStatus)) {
+        munmap(map, sizeof(StatusSegment));
+        return Result<bool>::failure(Error::INVALID_RESPONSE);
+    }
+    segment_ = segment;
+    return Result<bool>::success(true);
+}
+
+void StatusReader::close()
+{
+    if (segment_) {
+        munmap(const_cast<StatusSegment*>(segment_), sizeof(StatusSegment));
+        segment_ = nullptr;
+    }
+}
+
+Result<DeviceStatus> StatusReader::read() const
+{
+    if (!segment_) {
+        return Result<DeviceStatus>::failure(Error::READ_ERROR);
+    }
+
+    DeviceStatus status;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        if (attempt >= SPIN_ATTEMPTS) {
+            sched_yield();
+        }
+        uint32_t before = __atomic_load_n(&segment_->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1u) {
+            continue;
+        }
+        load_words(reinterpret_cast<uint32_t*>(&status), reinterpret_cast<const uint32_t*>(&segment_->status));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&segment_->sequence, __ATOMIC_RELAXED) == before) {
+            return Result<DeviceStatus>::success(status);
+        }
+    }
+    return Result<DeviceStatus>::failure(Error::TIMEOUT);
+}
+
+uint32_t StatusReader::sequence() const
+{
+    return segment_ ? __atomic_load_n(&segment_->sequence, __ATOMIC_ACQUIRE) : 0;
+}
+
+int32_t StatusReader::publisher_pid() const
+{
+    return segment_ ? segment_->publisher_pid : 0;
+}
+
+} // namespace obu
@@ -0,0 +1,341 @@
+#include "obu/common/timer_wheel.hpp"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace obu {
+
+namespace {
+
+// TimerId = generation << 32 | (index + 1), so 0 is never a valid id.
+TimerWheel::TimerId make_id(int32_t idx, uint32_t generation)
+{
+    return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(idx + 1);
+}
+
+uint64_t rotr(uint64_t v, unsigned n)
+{
+    n &= 63;
+    return n ? (v >> n) | (v << (64 - n)) : v;
+}
+
+} // anonymous namespace
+
+TimerWheel::TimerWheel(std::chrono::milliseconds tick)
+    : origin_(Clock::now()), tick_(tick)
+{
+    for (auto& level : heads_) {
+        std::fill(std::begin(level), std::end(level), -1);
+    }
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+}
+
+TimerWheel::~TimerWheel()
+{
+    if (timer_fd_ >= 0) {
+        ::close(timer_fd_);
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, Callback callback)
+{
+    return add(Clock::now() + delay, Clock::duration::zero(), std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::schedule_every(std::chrono::milliseconds period, Callback callback)
+{
+    if (period <= std::chrono::milliseconds::zero()) {
+        return INVALID_TIMER;
+    }
+    return add(Clock::now() + period, period, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::add(Clock::time_point due, Clock::duration period, Callback callback)
+{
+    int32_t idx;
+    if (!free_.empty()) {
+        idx = free_.back();
+        free_.pop_back();
+    } else {
+        idx = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[idx];
+    node.callback = std::move(callback);
+    node.due = due;
+    node.period = period;
+    node.expires = to_tick(due);
+    node.active = true;
+    node.stats = Stats();
+    active_count_++;
+
+    place(idx);
+    if (node.expires < armed_tick_) {
+        rearm();
+    }
+    return make_id(idx, node.generation);
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+    int32_t idx = lookup(id);
+    if (idx < 0) {
+        return false;
+    }
+    unlink(idx);
+    release(idx);
+    return true;
+}
+
+bool TimerWheel::active(TimerId id) const
+{
+    return lookup(id) >= 0;
+}
+
+const TimerWheel::Stats* TimerWheel::stats(TimerId id) const
+{
+    int32_t idx = lookup(id);
+    return idx < 0 ? nullptr : &nodes_[idx].stats;
+}
+
+int32_t TimerWheel::lookup(TimerId id) const
+{
+    int64_t idx = static_cast<int64_t>(id & 0xFFFFFFFFu) - 1;
+    if (idx < 0 || idx >= static_cast<int64_t>(nodes_.size())) {
+        return -1;
+    }
+    const Node& node = nodes_[idx];
+    if (!node.active || node.generation != static_cast<uint32_t>(id >> 32)) {
+        return -1;
+    }
+    return static_cast<int32_t>(idx);
+}
+
+void TimerWheel::release(int32_t idx)
+{
+    Node& node = nodes_[idx];
+    node.active = false;
+    node.callback = nullptr;
+    node.generation++;
+    active_count_--;
+    free_.push_back(idx);
+}
+
+// Rounds up so a timer never fires before its due time.
+uint64_t TimerWheel::to_tick(Clock::time_point t) const
+{
+    if (t <= origin_) {
+        return 0;
+    }
+    auto elapsed = t - origin_;
+    return static_cast<uint64_t>((elapsed + tick_ - Clock::duration(1)) / tick_);
+}
+
+void TimerWheel::place(int32_t idx)
+{
+    Node& node = nodes_[idx];
+    uint64_t expires = std::max(node.expires, now_tick_ + 1);
+    uint64_t delta = std::min(expires - now_tick_, MAX_DELTA);
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    // Beyond the top level the timer parks at the far end and is re-placed on cascade.
+    uint64_t when = level == LEVELS - 1 && expires - now_tick_ > MAX_DELTA ? now_tick_ + MAX_DELTA : expires;
+    uint64_t slot = (when >> (SLOT_BITS * level)) & SLOT_MASK;
+
+    node.level = static_cast<int8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+    node.prev = -1;
+    node.next = heads_[level][slot];
+    if (node.next >= 0) {
+        nodes_[node.next].prev = idx;
+    }
+    heads_[level][slot] = idx;
+    occupied_[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(int32_t idx)
+{
+    Node& node = nodes_[idx];
+    if (node.level < 0) {
+        return;
+    }
+    if (node.prev >= 0) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.level][node.slot] = node.next;
+    }
+    if (node.next >= 0) {
+        nodes_[node.next].prev = node.prev;
+    }
+    if (heads_[node.level][node.slot] < 0) {
+        occupied_[node.level] &= ~(uint64_t(1) << node.slot);
+    }
+    node.level = -1;
+    node.prev = node.next = -1;
+}
+
+// Moves every timer of a higher-level slot down now that its range has come up.
+void TimerWheel::cascade(int level, uint64_t slot)
+{
+    int32_t idx = heads_[level][slot];
+    heads_[level][slot] = -1;
+    occupied_[level] &= ~(uint64_t(1) << slot);
+
+    while (idx >= 0) {
+        int32_t next = nodes_[idx].next;
+        nodes_[idx].level = -1;
+        if (nodes_[idx].expires <= now_tick_) {
+            nodes_[idx].expires = now_tick_;
+        }
+        // Due exactly now: put it in the slot about to be fired.
+        if (nodes_[idx].expires == now_tick_) {
+            Node& node = nodes_[idx];
+            uint64_t s = now_tick_ & SLOT_MASK;
+            node.level = 0;
+            node.slot = static_cast<uint8_t>(s);
+            node.prev = -1;
+            node.next = heads_[0][s];
+            if (node.next >= 0) nodes_[node.next].prev = idx;
+            heads_[0][s] = idx;
+            occupied_[0] |= uint64_t(1) << s;
+        } else {
+            place(idx);
+        }
+        idx = next;
+    }
+}
+
+void TimerWheel::fire(int32_t idx, Clock::time_point now)
+{
+    uint32_t generation = nodes_[idx].generation;
+    {
+        Node& node = nodes_[idx];
+        auto late = now > node.due ? now - node.due : Clock::duration::zero();
+        node.stats.fires++;
+        node.stats.total_lateness += late;
+        node.stats.max_lateness = std::max(node.stats.max_lateness, late);
+    }
+
+    // The callback may cancel this timer or add others (which can grow nodes_),
+    // so it runs from a local and the node is looked up again afterwards.
+    Callback callback = std::move(nodes_[idx].callback);
+    callback();
+
+    Node& node = nodes_[idx];
+    if (!node.active || node.generation != generation) {
+        return;
+    }
+    if (node.period == Clock::duration::zero()) {
+        release(idx);
+        return;
+    }
+
+    node.callback = std::move(callback);
+    node.due += node.period;
+    if (node.due <= now) {
+        auto behind = (now - node.due) / node.period + 1;
+        node.stats.skipped += behind;
+        node.due += node.period * behind;
+    }
+    node.expires = to_tick(node.due);
+    place(idx);
+}
+
+// Earliest tick at which something fires or a higher-level slot cascades.
+uint64_t TimerWheel::next_event_tick() const
+{
+    uint64_t best = UINT64_MAX;
+
+    if (occupied_[0]) {
+        uint64_t start = (now_tick_ + 1) & SLOT_MASK;
+        unsigned d = __builtin_ctzll(rotr(occupied_[0], static_cast<unsigned>(start)));
+        best = now_tick_ + 1 + d;
+    }
+
+    for (int level = 1; level < LEVELS; ++level) {
+        if (!occupied_[level]) continue;
+        unsigned shift = SLOT_BITS * level;
+        uint64_t base = now_tick_ >> shift;
+        uint64_t start = (base + 1) & SLOT_MASK;
+        unsigned d = __builtin_ctzll(rotr(occupied_[level], static_cast<unsigned>(start)));
+        best = std::min(best, (base + 1 + d) << shift);
+    }
+    return best;
+}
+
+size_t TimerWheel::dispatch()
+{
+    uint64_t expirations;
+    (void)::read(timer_fd_, &expirations, sizeof(expirations));
+
+    auto now = Clock::now();
+    uint64_t target = (now - origin_) / tick_;
+    size_t fired = 0;
+
+    while (true) {
+        uint64_t next = next_event_tick();
+        if (next > target) {
+            now_tick_ = std::max(now_tick_, target);
+            break;
+        }
+        now_tick_ = next;
+
+        if ((now_tick_ & SLOT_MASK) == 0) {
+            for (int level = 1; level < LEVELS; ++level) {
+                uint64_t slot = (now_tick_ >> (SLOT_BITS * level)) & SLOT_MASK;
+                cascade(level, slot);
+                if (slot != 0) break;
+            }
+        }
+
+        uint64_t slot = now_tick_ & SLOT_MASK;
+        while (heads_[0][slot] >= 0) {
+            int32_t idx = heads_[0][slot];
+            unlink(idx);
+            fire(idx, now);
+            fired++;
+        }
+    }
+
+    rearm();
+    return fired;
+}
+
+int TimerWheel::next_timeout_ms() const
+{
+    uint64_t next = next_event_tick();
+    if (next == UINT64_MAX) {
+        return -1;
+    }
+    auto when = origin_ + tick_ * next;
+    auto now = Clock::now();
+    if (when <= now) {
+        return 0;
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(when - now).count();
+    return static_cast<int>((us + 999) / 1000);
+}
+
+void TimerWheel::rearm()
+{
+    uint64_t next = next_event_tick();
+    armed_tick_ = next;
+
+    struct itimerspec its = {};
+    if (next != UINT64_MAX) {
+        auto when = (origin_ + tick_ * next).time_since_epoch();
+        auto sec = std::chrono::duration_cast<std::chrono::seconds>(when);
+        its.it_value.tv_sec = sec.count();
+        its.it_value.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(when - sec).count();
+        if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) {
+            its.it_value.tv_nsec = 1;
+        }
+    }
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &its, nullptr);
+}
+
+} // namespace obu
@@ -0,0 +1,183 @@
+#include "obu/uplink/batch.hpp"
+#include "common/lz_codec.hpp"
+
+namespace obu {
+namespace uplink {
+
+namespace {
+
+void put_be(std::vector<uint8_t>& out, uint64_t v, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+    }
+}
+
+uint64_t get_be(const uint8_t* p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+} // anonymous namespace
+
+void append_event(std::vector<uint8_t>& raw, const uint8_t* data, size_t len)
+{
+    size_t v = len;
+    while (v >= 0x80) {
+        raw.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    raw.push_back(static_cast<uint8_t>(v));
+    raw.insert(raw.end(), data, data + len);
+}
+
+std::vector<uint8_t> encode_frame(uint8_t type, const uint8_t* body, size_t len)
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER + len);
+    frame.push_back(type);
+    put_be(frame, len, 4);
+    frame.insert(frame.end(), body, body + len);
+    return frame;
+}
+
+std::vector<uint8_t> encode_batch(const Batch& batch, bool compress)
+{
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER + BATCH_HEADER + batch.raw.size());
+    frame.push_back(MSG_BATCH);
+    put_be(frame, 0, 4);  // body length, patched below
+    put_be(frame, batch.first_offset, 8);
+    put_be(frame, batch.next_offset, 8);
+    put_be(frame, batch.count, 2);
+    size_t flags_pos = frame.size();
+    frame.push_back(0);
+    put_be(frame, batch.raw.size(), 4);
+
+    size_t payload_pos = frame.size();
+    if (compress) {
+        LzCodec::compress(batch.raw.data(), batch.raw.size(), frame);
+    }
+    if (compress && frame.size() - payload_pos < batch.raw.size()) {
+        frame[flags_pos] = FLAG_LZ;
+    } else {
+        frame.resize(payload_pos);
+        frame.insert(frame.end(), batch.raw.begin(), batch.raw.end());
+    }
+
+    size_t body_len = frame.size() - FRAME_HEADER;
+    for (int i = 0; i < 4; ++i) {
+        frame[1 + i] = static_cast<uint8_t>(body_len >> ((3 - i) * 8));
+    }
+    return frame;
+}
+
+Result<Batch> decode_batch(const std::vector<uint8_t>& body)
+{
+    if (body.size() < BATCH_HEADER) {
+        return Result<Batch>::failure(Error::PARSE_ERROR);
+    }
+
+    Batch batch;
+    const uint8_t* p = body.data();
+    batch.first_offset = get_be(p, 8);
+    batch.next_offset = get_be(p + 8, 8);
+    batch.count = static_cast<uint16_t>(get_be(p + 16, 2));
+    uint8_t flags = p[18];
+    size_t raw_len = get_be(p + 19, 4);
+
+    const uint8_t* payload = p + BATCH_HEADER;
+    size_t payload_len = body.size() - BATCH_HEADER;
+
+    if (batch.next_offset < batch.first_offset || raw_len > MAX_FRAME_BODY * 8) {
+        return Result<Batch>::failure(Error::PARSE_ERROR);
+    }
+
+    if (flags & FLAG_LZ) {
+        auto raw = LzCodec::decompress(payload, payload_len, raw_len);
+        if (!raw.ok()) {
+            return Result<Batch>::failure(raw.error());
+        }
+        batch.raw = raw.value();
+    } else {
+        if (payload_len != raw_len) {
+            return Result<Batch>::failure(Error::PARSE_ERROR);
+        }
+        batch.raw.assign(payload, payload + payload_len);
+    }
+    return Result<Batch>::success(std::move(batch));
+}
+
+Result<std::vector<std::string>> split_events(const Batch& batch)
+{
+    std::vector<std::string> events;
+    events.reserve(batch.count);
+
+    size_t pos = 0;
+    const auto& raw = batch.raw;
+    while (pos < raw.size()) {
+        size_t len = 0;
+        int shift = 0;
+        while (true) {
+            if (pos >= raw.size() || shift > 28) {
+                return Result<std::vector<std::string>>::failure(Error::PARSE_ERROR);
+            }
+            uint8_t b = raw[pos++];
+            len |= static_cast<size_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+            shift += 7;
+        }
+        if (raw.size() - pos < len) {
+            return Result<std::vector<std::string>>::failure(Error::PARSE_ERROR);
+        }
+        events.emplace_back(reinterpret_cast<const char*>(raw.data() + pos), len);
+        pos += len;
+    }
+
+    if (events.size() != batch.count) {
+        return Result<std::vector<std::string>>::failure(Error::PARSE_ERROR);
+    }
+    return Result<std::vector<std::string>>::success(std::move(events));
+}
+
+std::vector<uint8_t> encode_ack(uint64_t next_offset)
+{
+    std::vector<uint8_t> body;
+    put_be(body, next_offset, 8);
+    return encode_frame(MSG_ACK, body.data(), body.size());
+}
+
+Result<uint64_t> decode_ack(const std::vector<uint8_t>& body)
+{
+    if (body.size() != 8) {
+        return Result<uint64_t>::failure(Error::PARSE_ERROR);
+    }
+    return Result<uint64_t>::success(get_be(body.data(), 8));
+}
+
+Result<bool> FrameReader::next(Frame& frame)
+{
+    if (buffer_.size() < FRAME_HEADER) {
+        return Result<bool>::success(false);
+    }
+
+    size_t body_len = get_be(buffer_.data() + 1, 4);
+    if (body_len > MAX_FRAME_BODY) {
+        return Result<bool>::failure(Error::PARSE_ERROR);
+    }
+    if (buffer_.size() < FRAME_HEADER + body_len) {
+        return Result<bool>::success(false);
+    }
+
+    frame.type = buffer_[0];
+    frame.body.assign(buffer_.begin() + FRAME_HEADER, buffer_.begin() + FRAME_HEADER + body_len);
+    buffer_.erase(buffer_.begin(), buffer_.begin() + FRAME_HEADER + body_len);
+    return Result<bool>::success(true);
+}
+
+} // namespace uplink
+} // namespace obu
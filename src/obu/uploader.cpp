@@ -0,0 +1,367 @@
+#include "obu/uplink/uploader.hpp"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+
+namespace obu {
+
+namespace {
+
+int remaining_ms(std::chrono::steady_clock::time_point deadline)
+{
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now()).count();
+    return left > 0 ? static_cast<int>(left) : 0;
+}
+
+} // anonymous namespace
+
+Uploader::Uploader(EventJournal& journal, UplinkConfig config)
+    : journal_(journal), config_(std::move(config)), cursor_file_(config_.cursor_path) {}
+
+Uploader::~Uploader()
+{
+    stop();
+    disconnect();
+}
+
+Result<bool> Uploader::connect()
+{
+    if (socket_fd_ >= 0) {
+        return Result<bool>::success(true);
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    if (inet_pton(AF_INET, config_.host.c_str(), &addr.sin_addr) <= 0) {
+        last_error_ = "Invalid address";
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        last_error_ = "Failed to create socket";
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        last_error_ = "Connection failed";
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    int err = 0;
+    socklen_t err_len = sizeof(err);
+    if (poll(&pfd, 1, config_.connect_timeout_ms) <= 0 ||
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 || err != 0) {
+        ::close(fd);
+        last_error_ = "Connection failed";
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
+    // Batches are already coalesced; do not let Nagle hold back the tail segment.
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    socket_fd_ = fd;
+    reader_.clear();
+    return handshake();
+}
+
+void Uploader::disconnect()
+{
+    if (socket_fd_ >= 0) {
+        ::close(socket_fd_);
+        socket_fd_ = -1;
+    }
+    reader_.clear();
+}
+
+// The server answers HELLO with the offset it already holds, so a client
+// whose last ack was lost resumes without resending acknowledged batches.
+Result<bool> Uploader::handshake()
+{
+    const auto& id = config_.vehicle_id;
+    auto hello = uplink::encode_frame(uplink::MSG_HELLO,
+                                      reinterpret_cast<const uint8_t*>(id.data()), id.size());
+    auto sent = send_all(hello);
+    if (!sent.ok()) {
+        disconnect();
+        return sent;
+    }
+
+    auto frame = read_frame(config_.ack_timeout_ms);
+    if (!frame.ok() || frame.value().type != uplink::MSG_ACK) {
+        disconnect();
+        last_error_ = "Handshake failed";
+        return Result<bool>::failure(frame.ok() ? Error::INVALID_RESPONSE : frame.error());
+    }
+
+    auto server_offset = uplink::decode_ack(frame.value().body);
+    if (!server_offset.ok()) {
+        disconnect();
+        return Result<bool>::failure(server_offset.error());
+    }
+
+    uint64_t resume = std::min(server_offset.value(), journal_.end_offset());
+    if (resume > cursor_.load()) {
+        auto stored = commit(resume);
+        if (!stored.ok()) {
+            return stored;
+        }
+    }
+    return Result<bool>::success(true);
+}
+
+Result<bool> Uploader::send_all(const std::vector<uint8_t>& data)
+{
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = ::send(socket_fd_, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+        if (n > 0) {
+            off += n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = {socket_fd_, POLLOUT, 0};
+            if (poll(&pfd, 1, config_.ack_timeout_ms) > 0) continue;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        last_error_ = "Send failed";
+        return Result<bool>::failure(Error::WRITE_ERROR);
+    }
+
+    counters_.wire_bytes.fetch_add(data.size(), std::memory_order_relaxed);
+    return Result<bool>::success(true);
+}
+
+Result<uplink::Frame> Uploader::read_frame(int timeout_ms)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    uplink::Frame frame;
+
+    while (true) {
+        auto got = reader_.next(frame);
+        if (!got.ok()) {
+            last_error_ = "Malformed frame";
+            return Result<uplink::Frame>::failure(got.error());
+        }
+        if (got.value()) {
+            return Result<uplink::Frame>::success(std::move(frame));
+        }
+
+        struct pollfd pfd = {socket_fd_, POLLIN, 0};
+        int ret = poll(&pfd, 1, remaining_ms(deadline));
+        if (ret == 0) {
+            last_error_ = "Timeout waiting for ack";
+            return Result<uplink::Frame>::failure(Error::TIMEOUT);
+        }
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            return Result<uplink::Frame>::failure(Error::READ_ERROR);
+        }
+
+        uint8_t buf[512];
+        ssize_t n = ::recv(socket_fd_, buf, sizeof(buf), 0);
+        if (n > 0) {
+            reader_.feed(buf, n);
+        } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+            last_error_ = "Connection closed";
+            return Result<uplink::Frame>::failure(Error::READ_ERROR);
+        }
+    }
+}
+
+Result<bool> Uploader::commit(uint64_t offset)
+{
+    auto stored = cursor_file_.store(offset);
+    if (!stored.ok()) {
+        last_error_ = "Failed to persist cursor";
+        return stored;
+    }
+    cursor_.store(offset);
+    return Result<bool>::success(true);
+}
+
+Result<size_t> Uploader::flush()
+{
+    if (!cursor_loaded_) {
+        auto loaded = cursor_file_.load();
+        if (!loaded.ok()) {
+            last_error_ = "Failed to load cursor";
+            return Result<size_t>::failure(loaded.error());
+        }
+        cursor_.store(loaded.value());
+        cursor_loaded_ = true;
+    }
+
+    if (journal_.end_offset() <= cursor_.load()) {
+        return Result<size_t>::success(0);
+    }
+
+    if (socket_fd_ < 0) {
+        auto conn = connect();
+        if (!conn.ok()) {
+            return Result<size_t>::failure(conn.error());
+        }
+        // Only a connect that replaces a lost link is a reconnect.
+        if (connected_before_) {
+            counters_.reconnects.fetch_add(1, std::memory_order_relaxed);
+        }
+        connected_before_ = true;
+    }
+
+    struct InFlight { uint64_t next_offset; size_t events; size_t raw_bytes; };
+    std::deque<InFlight> in_flight;
+    uint64_t send_offset = cursor_.load();
+    size_t acked_events = 0;
+
+    while (true) {
+        while (in_flight.size() < config_.window && send_offset < journal_.end_offset()) {
+            uplink::Batch batch;
+            batch.first_offset = send_offset;
+            batch.raw.reserve(config_.max_batch_bytes + 64);
+
+            auto next = journal_.read(send_offset, config_.max_batch_bytes, config_.max_batch_events,
+                [&](uint64_t, const uint8_t* data, size_t len) {
+                    uplink::append_event(batch.raw, data, len);
+                    batch.count++;
+                });
+            if (!next.ok()) {
+                last_error_ = "Journal read failed";
+                return Result<size_t>::failure(next.error());
+            }
+            batch.next_offset = next.value();
+
+            auto sent = send_all(uplink::encode_batch(batch, config_.compress));
+            if (!sent.ok()) {
+                disconnect();
+                return Result<size_t>::failure(sent.error());
+            }
+            in_flight.push_back({batch.next_offset, batch.count, batch.raw.size()});
+            send_offset = batch.next_offset;
+            counters_.batches_sent.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (in_flight.empty()) {
+            break;
+        }
+
+        auto frame = read_frame(config_.ack_timeout_ms);
+        if (!frame.ok()) {
+            disconnect();
+            return Result<size_t>::failure(frame.error());
+        }
+        if (frame.value().type != uplink::MSG_ACK) {
+            continue;
+        }
+        auto ack = uplink::decode_ack(frame.value().body);
+        if (!ack.ok()) {
+            disconnect();
+            return Result<size_t>::failure(ack.error());
+        }
+
+        // Acks are cumulative; one may cover several pipelined batches.
+        size_t events = 0;
+        size_t raw_bytes = 0;
+        while (!in_flight.empty() && in_flight.front().next_offset <= ack.value()) {
+            events += in_flight.front().events;
+            raw_bytes += in_flight.front().raw_bytes;
+            in_flight.pop_front();
+        }
+        if (ack.value() > cursor_.load()) {
+            auto stored = commit(ack.value());
+            if (!stored.ok()) {
+                return Result<size_t>::failure(stored.error());
+            }
+        }
+        acked_events += events;
+        counters_.events_acked.fetch_add(events, std::memory_order_relaxed);
+        counters_.raw_bytes.fetch_add(raw_bytes, std::memory_order_relaxed);
+    }
+
+    return Result<size_t>::success(acked_events);
+}
+
+Result<bool> Uploader::start()
+{
+    running_.store(true);
+    int backoff_ms = config_.retry_min_ms;
+
+    while (running_.load()) {
+        auto result = flush();
+        if (!running_.load()) {
+            break;
+        }
+
+        if (!result.ok()) {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wait_cv_.wait_for(lock, std::chrono::milliseconds(backoff_ms),
+                              [this] { return !running_.load(); });
+            backoff_ms = std::min(backoff_ms * 2, config_.retry_max_ms);
+            continue;
+        }
+
+        backoff_ms = config_.retry_min_ms;
+        journal_.wait_for_data(cursor_.load(), -1, &running_);
+    }
+
+    disconnect();
+    return Result<bool>::success(true);
+}
+
+void Uploader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        running_.store(false);
+    }
+    wait_cv_.notify_all();
+    journal_.wake();
+}
+
+UplinkStats Uploader::stats() const
+{
+    UplinkStats stats;
+    stats.events_acked = counters_.events_acked.load(std::memory_order_relaxed);
+    stats.batches_sent = counters_.batches_sent.load(std::memory_order_relaxed);
+    stats.raw_bytes = counters_.raw_bytes.load(std::memory_order_relaxed);
+    stats.wire_bytes = counters_.wire_bytes.load(std::memory_order_relaxed);
+    stats.reconnects = counters_.reconnects.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Uploader::register_metrics(MetricsRegistry& registry, const std::string& name) const
+{
+    MetricsRegistry::Labels labels = {{"uplink", name}};
+    registry.gauge("obu_uplink_backlog_bytes", "Journal bytes written but not yet acknowledged.", labels,
+                   [this] {
+                       uint64_t end = journal_.end_offset();
+                       uint64_t cursor = cursor_.load();
+                       return end > cursor ? static_cast<double>(end - cursor) : 0.0;
+                   });
+    registry.gauge("obu_uplink_running", "1 while the background uploader runs.", labels,
+                   [this] { return running_.load() ? 1.0 : 0.0; });
+    const Counters* c = &counters_;
+    auto load = [](const std::atomic<uint64_t>& v) { return static_cast<double>(v.load(std::memory_order_relaxed)); };
+    registry.counter("obu_uplink_events_acked_total", "Events acknowledged by the server.", labels,
+                     [c, load] { return load(c->events_acked); });
+    registry.counter("obu_uplink_wire_bytes_total", "Bytes written to the uplink socket.", labels,
+                     [c, load] { return load(c->wire_bytes); });
+    registry.counter("obu_uplink_reconnects_total", "Uplink reconnections.", labels,
+                     [c, load] { return load(c->reconnects); });
+}
+
+} // namespace obu
@@ -10,6 +10,9 @@ namespace {
     
     constexpr uint8_t RESP_ACK = 0x06;
     constexpr uint8_t RESP_NAK = 0x15;
+    constexpr uint8_t ACK_OR_NAK[] = {RESP_ACK, RESP_NAK};
+    
+    constexpr int SCAN_TIMEOUT_MS = 3000;
 }
 
 Result<bool> QrScanner::send_command(uint8_t cmd)
@@ -33,15 +36,26 @@ Result<bool> QrScanner::initialize()
         return Result<bool>::failure(result.error());
     }
     
-    bool running = true;
+    // Done as soon as the scanner acknowledges; 200 ms is only the upper bound.
     serial_.set_timeout_ms(200);
-    serial_.read(running); 
-    serial_.set_timeout_ms(3000);  
-    
-    initialized_ = true;
+    serial_.read_frame([](const std::vector<unsigned char>& rx) {
+        return std::find_first_of(rx.begin(), rx.end(), std::begin(ACK_OR_NAK), std::end(ACK_OR_NAK)) != rx.end();
+    });
+    ready();
     return Result<bool>::success(true);
 }
 
+void QrScanner::resume()
+{
+    ready();
+}
+
+void QrScanner::ready()
+{
+    serial_.set_timeout_ms(SCAN_TIMEOUT_MS);
+    initialized_ = true;
+}
+
 Result<bool> QrScanner::trigger_on()
 {
     return send_command(CMD_TRIGGER_ON);
@@ -90,8 +104,7 @@ std::string QrScanner::parse_scan_data(const std::vector<unsigned char>& data)
 
 Result<std::string> QrScanner::read_code()
 {
-    bool running = true;
-    auto result = serial_.read(running);
+    auto result = serial_.read();
     
     if (!result.ok()) {
         return Result<std::string>::failure(result.error());
@@ -108,6 +121,7 @@ Result<std::string> QrScanner::read_code()
 
 Result<std::string> QrScanner::scan_once()
 {
+    serial_.clear_cancel();
     if (!initialized_) {
         auto init_result = initialize();
         if (!init_result.ok()) {
@@ -124,6 +138,9 @@ Result<std::string> QrScanner::scan_once()
     
     trigger_off();
     
+    if (read_result.ok() && status_) {
+        status_->publish_qr(read_result.value());
+    }
     return read_result;
 }
 
@@ -137,6 +154,7 @@ Result<bool> QrScanner::start_continuous()
     }
     
     running_.store(true);
+    serial_.clear_cancel();
     
     auto on_result = trigger_on();
     if (!on_result.ok()) {
@@ -144,27 +162,31 @@ Result<bool> QrScanner::start_continuous()
         return Result<bool>::failure(on_result.error());
     }
     
+    // Block until a scan arrives or stop() cancels the read.
+    serial_.set_timeout_ms(SerialPort::WAIT_FOREVER);
+    
     std::string last_code;
     auto last_scan_time = std::chrono::steady_clock::now();
     constexpr auto DUPLICATE_THRESHOLD = std::chrono::milliseconds(1000);
     
     while (running_.load()) 
     {
-        bool run_flag = running_.load();
-        auto result = serial_.read(run_flag);
+        auto result = serial_.read();
         
         if (!result.ok()) {
             if (result.error() == Error::TIMEOUT) {
+                if (serial_.is_cancelled()) running_.store(false);
                 continue;
             }
             running_.store(false);
+            serial_.set_timeout_ms(SCAN_TIMEOUT_MS);
             trigger_off();
             return Result<bool>::failure(result.error());
         }
         
         std::string code = parse_scan_data(result.value());
         
-        if (!code.empty() && scan_callback_) {
+        if (!code.empty() && (scan_callback_ || status_)) {
             auto now = std::chrono::steady_clock::now();
             
             if (code != last_code || 
@@ -172,11 +194,24 @@ Result<bool> QrScanner::start_continuous()
             {
                 last_code = code;
                 last_scan_time = now;
-                scan_callback_(code);
+                if (status_) status_->publish_qr(code);
+                if (scan_callback_ && executor_) {
+                    executor_->post([callback = scan_callback_, code] { callback(code); });
+                } else if (scan_callback_) {
+                    scan_callback_(code);
+                }
             }
         }
     }
     
+    serial_.set_timeout_ms(SCAN_TIMEOUT_MS);
     trigger_off();
     return Result<bool>::success(true);
-}
\ No newline at end of file
+}
+
+void QrScanner::register_metrics(obu::MetricsRegistry& registry, const std::string& name) const
+{
+    const std::atomic<bool>* running = &running_;
+    registry.gauge("obu_reader_running", "1 while the reader loop is running.", {{"reader", name}},
+                   [running] { return running->load() ? 1.0 : 0.0; });
+}
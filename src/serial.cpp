@@ -1,8 +1,77 @@
 #include "transport/serial.hpp"
 #include "common/protocol.hpp"
 #include <poll.h>
+#include <linux/serial.h>
+#include <climits>
+#include <cstdlib>
+#include <chrono>
+
+namespace {
+
+speed_t to_speed(int baud)
+{
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 500000: return B500000;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 1500000: return B1500000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+        case 4000000: return B4000000;
+        default: return 0;
+    }
+}
+
+// sysfs attribute of the tty behind `port` (symlinks such as /dev/serial/by-id resolved).
+std::string sysfs_attr(const std::string& port, const char* dir, const char* attr)
+{
+    char resolved[PATH_MAX];
+    if (!realpath(port.c_str(), resolved))
+        return "";
+    const char* name = strrchr(resolved, '/');
+    return std::string(dir) + (name ? name + 1 : resolved) + "/" + attr;
+}
+
+bool write_attr(const std::string& path, int value)
+{
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    std::string text = std::to_string(value);
+    bool ok = ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    ::close(fd);
+    return ok;
+}
+
+int read_attr(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    char buf[16] = {};
+    ssize_t n = ::read(fd, buf, sizeof(buf) - 1);
+    ::close(fd);
+    return n > 0 ? atoi(buf) : -1;
+}
+
+const char* FTDI_DIR = "/sys/bus/usb-serial/devices/";
+const char* TTY_DIR = "/sys/class/tty/";
+
+} // anonymous namespace
 
 Result<bool> SerialPort::open(const std::string& port)
+{
+    return open(port, SerialProfile());
+}
+
+Result<bool> SerialPort::open(const std::string& port, const SerialProfile& profile)
 {
     port_ = port;
     
@@ -21,42 +90,117 @@ Result<bool> SerialPort::open(const std::string& port)
         return Result<bool>::failure(Error::PORT_ERROR);
     }
 
+    open_ = true;
+
+    auto applied = apply(profile);
+    if (!applied.ok()) {
+        close();
+        return applied;
+    }
+
+    tcflush(fd_, TCIOFLUSH);
+    return Result<bool>::success(true);
+}
+
+Result<bool> SerialPort::apply(const SerialProfile& profile)
+{
+    if (fd_ < 0)
+        return Result<bool>::failure(Error::PORT_ERROR);
+
+    speed_t speed = to_speed(profile.baud);
+    if (speed == 0) {
+        std::cerr << "Unsupported baud rate " << profile.baud << "\n";
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+    // VMIN without VTIME would let read() block past cancel() and the deadline.
+    if (profile.vmin < 0 || profile.vmin > 255 || profile.vtime < 0 || profile.vtime > 255 ||
+        (profile.vmin > 0 && profile.vtime == 0)) {
+        std::cerr << "Invalid VMIN/VTIME " << profile.vmin << "/" << profile.vtime << "\n";
+        return Result<bool>::failure(Error::PORT_ERROR);
+    }
+
     struct termios tty;
-    tcgetattr(fd_, &tty);  
-    
-    cfsetispeed(&tty, B115200);
-    cfsetospeed(&tty, B115200);
+    tcgetattr(fd_, &tty);
+
     cfmakeraw(&tty);
-    
-    tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;
-    tty.c_cflag &= ~PARENB;
-    tty.c_cflag &= ~CSTOPB;
-    tty.c_cflag |= CREAD | CLOCAL;
-    
-    tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 5;
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    set_8N1(tty);
+
+    static const tcflag_t sizes[] = {CS5, CS6, CS7, CS8};
+    if (profile.data_bits >= 5 && profile.data_bits <= 8)
+        tty.c_cflag = (tty.c_cflag & ~CSIZE) | sizes[profile.data_bits - 5];
+    if (profile.parity == 'E' || profile.parity == 'O') {
+        tty.c_cflag |= PARENB;
+        if (profile.parity == 'O')
+            tty.c_cflag |= PARODD;
+    }
+    if (profile.stop_bits == 2)
+        tty.c_cflag |= CSTOPB;
+    if (profile.rts_cts)
+        tty.c_cflag |= CRTSCTS;
+
+    tty.c_cc[VMIN] = static_cast<cc_t>(profile.vmin);
+    tty.c_cc[VTIME] = static_cast<cc_t>(profile.vtime);
     
     if(tcsetattr(fd_, TCSANOW, &tty) != 0)
     {
         std::cerr << "Error setting port attributes: " << strerror(errno) << "\n";
-        ::close(fd_);
-        fd_ = -1;
         return Result<bool>::failure(Error::PORT_ERROR);
     }
 
-    tcflush(fd_, TCIOFLUSH);
-    open_ = true;
+    apply_low_latency(profile.low_latency);
+    if (profile.rx_trigger_bytes > 0)
+        write_attr(sysfs_attr(port_, TTY_DIR, "rx_trig_bytes"), profile.rx_trigger_bytes);
+
+    profile_ = profile;
+    baud_ = profile.baud;
     return Result<bool>::success(true);
 }
 
+// Best effort: ptys and many USB drivers reject TIOCSSERIAL, which just
+// leaves is_low_latency() false. The previous flags are restored by close().
+void SerialPort::apply_low_latency(bool enable)
+{
+    low_latency_ = false;
+
+    struct serial_struct ss;
+    if (ioctl(fd_, TIOCGSERIAL, &ss) == 0) {
+        if (saved_serial_flags_ < 0)
+            saved_serial_flags_ = ss.flags;
+        if (enable)
+            ss.flags |= ASYNC_LOW_LATENCY;
+        else
+            ss.flags = (ss.flags & ~ASYNC_LOW_LATENCY) | (saved_serial_flags_ & ASYNC_LOW_LATENCY);
+        low_latency_ = ioctl(fd_, TIOCSSERIAL, &ss) == 0 && enable;
+    }
+
+    // FTDI adapters batch received bytes for latency_timer ms (16 by default).
+    std::string timer = sysfs_attr(port_, FTDI_DIR, "latency_timer");
+    if (enable) {
+        int current = read_attr(timer);
+        if (current >= 0 && saved_latency_timer_ < 0)
+            saved_latency_timer_ = current;
+        if (current >= 0 && write_attr(timer, 1))
+            low_latency_ = true;
+    } else if (saved_latency_timer_ >= 0) {
+        write_attr(timer, saved_latency_timer_);
+    }
+}
+
 Result<bool> SerialPort::close()
 {
     if(fd_ >= 0)
     {
+        if (saved_serial_flags_ >= 0 || saved_latency_timer_ >= 0)
+            apply_low_latency(false);
         tcsetattr(fd_, TCSANOW, &original_tty_);
         ::close(fd_);
         fd_ = -1;
         open_ = false;
+        low_latency_ = false;
+        saved_serial_flags_ = -1;
+        saved_latency_timer_ = -1;
         return Result<bool>::success(true);
     }
     return Result<bool>::success(false);
@@ -72,10 +216,93 @@ Result<size_t> SerialPort::write(const unsigned char* data, size_t len)
         return Result<size_t>::failure(Error::PORT_ERROR);
 
     tcdrain(fd_);
+    counters_.tx_bytes.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
     return Result<size_t>::success(static_cast<size_t>(written));
 }
 
+Result<std::vector<unsigned char>> SerialPort::read()
+{
+    bool running = true;
+    return read_until(running, nullptr);
+}
+
 Result<std::vector<unsigned char>> SerialPort::read(volatile bool& g_running)
+{
+    return read_until(g_running, nullptr);
+}
+
+Result<std::vector<unsigned char>> SerialPort::read_frame(const FrameCheck& complete)
+{
+    bool running = true;
+    return read_until(running, &complete);
+}
+
+Result<std::vector<unsigned char>> SerialPort::transact(const unsigned char* request, size_t len,
+                                                    const FrameCheck& complete,
+                                                    obu::RttEstimator& rtt, const obu::RetryPolicy& policy,
+                                                    const FrameCheck& matches)
+{
+    using Reply = Result<std::vector<unsigned char>>;
+    Reply reply = Reply::failure(Error::TIMEOUT);
+    bool matched = false;
+    FrameCheck done = [&](const std::vector<unsigned char>& rx) {
+        matched = matches ? matches(rx) : complete(rx);
+        return matched;
+    };
+
+    // Whatever is queued now answers an earlier command. Retries do not
+    // flush: that could cut a slow reply in half, and a late reply to an
+    // earlier attempt is as good as the one to the retry.
+    tcflush(fd_, TCIFLUSH);
+    for (int attempt = 0; attempt <= policy.retries; ++attempt) {
+        auto written = write(request, len);
+        if (!written.ok())
+            return Reply::failure(written.error());
+
+        // write() drains, so the RTO is the device's turnaround; the reply's
+        // own time on the wire is not counted against it.
+        auto sent = std::chrono::steady_clock::now();
+        auto first_byte = sent;
+        auto deadline = sent + std::chrono::milliseconds(rtt.timeout_ms());
+        for (;;) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) {
+                reply = Reply::failure(Error::TIMEOUT);
+                break;
+            }
+            set_timeout_ms(static_cast<int>(left));
+            matched = false;
+            bool running = true;
+            reply = read_until(running, &done, &first_byte);
+            if (!reply.ok())
+                break;
+            if (matched) {
+                if (attempt == 0) {
+                    rtt.sample(std::chrono::duration_cast<std::chrono::microseconds>(first_byte - sent));
+                }
+                return reply;
+            }
+            // The line went idle on frames for another request or on a
+            // fragment; keep waiting out this attempt.
+            if (complete(reply.value()))
+                counters_.stale_replies.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (reply.error() != Error::TIMEOUT || is_cancelled())
+            return reply;
+        rtt.backoff();
+        if (attempt < policy.retries)
+            counters_.retransmits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return reply;
+}
+
+// Blocks in poll() until the first byte, the timeout or a cancellation, then
+// collects bytes until `complete` accepts them or the line has been idle for
+// the profile's frame gap. There is no fixed polling slice, so an idle port
+// costs no wakeups and a cancel lands within microseconds.
+Result<std::vector<unsigned char>> SerialPort::read_until(volatile bool& g_running, const FrameCheck* complete,
+                                                      std::chrono::steady_clock::time_point* first_byte)
 {
     std::vector<unsigned char> buffer;
     
@@ -83,41 +310,113 @@ Result<std::vector<unsigned char>> SerialPort::read(volatile bool& g_running)
         return Result<std::vector<unsigned char>>::failure(Error::PORT_ERROR);
 
     unsigned char temp[256];
-    int elapsed = 0;
-    int last_data = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms_);
 
-    while (elapsed < timeout_ms_ && g_running)
+    while (g_running)
     {
-        struct pollfd pfd = {fd_, POLLIN, 0};
-        int ret = poll(&pfd, 1, 50);
-        
-        if (ret > 0)
-        {
-            ssize_t n = ::read(fd_, temp, sizeof(temp));
-            if (n > 0)
-            {
-                buffer.insert(buffer.end(), temp, temp + n);
-                last_data = 0;
-            }
+        int wait_ms = -1;
+        if (first_byte && !buffer.empty()) {
+            if (buffer.size() >= MAX_REPLY_BYTES)
+                break;
+        } else if (timeout_ms_ >= 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0)
+                break;
+            wait_ms = static_cast<int>(left);
         }
-        else if (ret < 0) {
+        if (!buffer.empty() && (wait_ms < 0 || wait_ms > profile_.frame_gap_ms))
+            wait_ms = profile_.frame_gap_ms;
+
+        struct pollfd pfds[3] = {
+            {fd_, POLLIN, 0},
+            {cancel_.fd(), POLLIN, 0},
+            {shutdown_ ? shutdown_->fd() : -1, POLLIN, 0},
+        };
+        int ret = poll(pfds, 3, wait_ms);
+
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
             return Result<std::vector<unsigned char>>::failure(Error::PORT_ERROR);
         }
+        if (ret == 0) {
+            if (!buffer.empty())
+                break;
+            continue;
+        }
 
-        elapsed += 50;
-        last_data += 50;
+        // Cancelled: whatever arrived so far is not handed out as a reply.
+        if ((pfds[1].revents | pfds[2].revents) & POLLIN)
+            return Result<std::vector<unsigned char>>::failure(Error::TIMEOUT);
 
-        if (!buffer.empty() && last_data >= 100)
-            break;
+        ssize_t n = ::read(fd_, temp, sizeof(temp));
+        if (n > 0) {
+            if (first_byte && buffer.empty())
+                *first_byte = std::chrono::steady_clock::now();
+            counters_.rx_bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            buffer.insert(buffer.end(), temp, temp + n);
+            if (complete && (*complete)(buffer))
+                break;
+        }
+        else if ((n < 0 && errno != EAGAIN && errno != EINTR) ||
+                 (n == 0 && (pfds[0].revents & (POLLHUP | POLLERR)))) {
+            return Result<std::vector<unsigned char>>::failure(Error::PORT_ERROR);
+        }
     }
 
     if (buffer.empty()) {
+        if (!is_cancelled())
+            counters_.read_timeouts.fetch_add(1, std::memory_order_relaxed);
         return Result<std::vector<unsigned char>>::failure(Error::TIMEOUT);
     }
 
+    counters_.frames.fetch_add(1, std::memory_order_relaxed);
+    counters_.last_rx_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
     return Result<std::vector<unsigned char>>::success(std::move(buffer));
 }
 
+void SerialPort::cancel()
+{
+    cancel_.cancel();
+}
+
+void SerialPort::clear_cancel()
+{
+    cancel_.reset();
+}
+
+void SerialPort::register_metrics(obu::MetricsRegistry& registry, const std::string& name) const
+{
+    const SerialCounters* c = &counters_;
+    obu::MetricsRegistry::Labels labels = {{"port", name}};
+    auto load = [](const std::atomic<uint64_t>& v) { return static_cast<double>(v.load(std::memory_order_relaxed)); };
+
+    registry.counter("obu_serial_rx_bytes_total", "Bytes read from the port.", labels,
+                     [c, load] { return load(c->rx_bytes); });
+    registry.counter("obu_serial_tx_bytes_total", "Bytes written to the port.", labels,
+                     [c, load] { return load(c->tx_bytes); });
+    registry.counter("obu_serial_frames_total", "Reads that returned data.", labels,
+                     [c, load] { return load(c->frames); });
+    registry.counter("obu_serial_read_timeouts_total", "Reads that timed out with no data.", labels,
+                     [c, load] { return load(c->read_timeouts); });
+    registry.counter("obu_serial_crc_errors_total", "Received frames that failed the CRC.", labels,
+                     [c, load] { return load(c->crc_errors); });
+    registry.counter("obu_serial_retransmits_total", "Requests resent after a lost reply.", labels,
+                     [c, load] { return load(c->retransmits); });
+    registry.counter("obu_serial_stale_replies_total", "Complete frames discarded as answering another request.", labels,
+                     [c, load] { return load(c->stale_replies); });
+    registry.gauge("obu_serial_last_rx_age_seconds", "Time since the port last received data, -1 if never.", labels,
+                   [c] {
+                       int64_t last = c->last_rx_ns.load(std::memory_order_relaxed);
+                       if (last == 0) return -1.0;
+                       auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+                       return (now - last) / 1e9;
+                   });
+}
+
 bool SerialPort::is_open()
 {
     return open_;
@@ -140,4 +439,7 @@ void SerialPort::set_timeout_ms(int timeout_ms)
 
 void SerialPort::set_8N1(termios &tty)
 {
+    tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;
+    tty.c_cflag &= ~(PARENB | PARODD | CSTOPB | CRTSCTS);
+    tty.c_cflag |= CREAD | CLOCAL;
 }
\ No newline at end of file
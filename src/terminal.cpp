@@ -1,6 +1,7 @@
 #include "devices/terminal.hpp"
 #include "common/protocol.hpp"
 #include "transport/epdi.hpp"
+#include "common/messages.hpp"
 
 Result<TerminalAliveResponse> Terminal::alive(TerminalAddress addr)
 {
@@ -9,21 +10,12 @@ Result<TerminalAliveResponse> Terminal::alive(TerminalAddress addr)
     if(!result.ok())
         return Result<TerminalAliveResponse>::failure(result.error());
 
-    auto& payload = result.value();
-    
-
-    
-    if (payload.size() < 10) {
-        return Result<TerminalAliveResponse>::failure(Error::INVALID_RESPONSE);
+    auto response = obu::TerminalAliveSchema::decode(result.value(), obu::TERMINAL_REPLY_HEADER);
+    if (response.ok() && status_) {
+        status_->publish_terminal(addr, response.value());
     }
     
-    TerminalAliveResponse response;
-    response.status = (payload[2] << 8) | payload[3];
-    response.hw_version = (payload[4] << 8) | payload[5];
-    response.sw_version = (payload[6] << 8) | payload[7];
-    response.bootloader_version = (payload[8] << 8) | payload[9];
-    
-    return Result<TerminalAliveResponse>::success(response);
+    return response;
 }
 
 Result<std::vector<uint8_t>> Terminal::send_command(TerminalAddress addr, uint8_t service, const uint8_t* data, size_t len)
@@ -36,33 +28,42 @@ Result<std::vector<uint8_t>> Terminal::send_command(TerminalAddress addr, uint8_
     }
     std::vector<uint8_t> frame = EpdiFrame::encode(cmd.data(), cmd.size());
     
-    auto write_result = serial_.write(frame.data(), frame.size());
-    if (!write_result.ok()) {
-        return Result<std::vector<uint8_t>>::failure(write_result.error());
-    }
-    
-    bool running = true;
-    auto read_result = serial_.read(running);
+    // The bus may echo the request first; done once a complete frame from the
+    // terminal is in. Frames are found by their DLE SYNC, past the tail of
+    // one an earlier read cut off.
+    uint8_t request_addr = cmd[0];
+    size_t reply_at = 0;
+    size_t reply_len = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    auto read_result = serial_.transact(frame.data(), frame.size(), [&](const std::vector<unsigned char>& rx) {
+        size_t at = EpdiFrame::sync(rx.data(), rx.size());
+        while (size_t n = EpdiFrame::complete_length(rx.data() + at, rx.size() - at)) {
+            if (rx[at + 2] != request_addr) {
+                reply_at = at;
+                reply_len = n;
+                return true;
+            }
+            at = EpdiFrame::sync(rx.data(), rx.size(), at + n);
+        }
+        return false;
+    }, rtt_, retry_);
+    latency_.observe(service, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time));
     if (!read_result.ok()) {
         return Result<std::vector<uint8_t>>::failure(read_result.error());
     }
-    
 
-    auto& raw = read_result.value();
-    
-    size_t second_frame_start = 0;
-    for (size_t i = 2; i < raw.size() - 4; i++) {
-        if (raw[i] == 0x10 && raw[i+1] == 0x03) {
-            second_frame_start = i + 4;
-            break;
-        }
-    }
-    
-    if (second_frame_start > 0 && second_frame_start < raw.size()) {
-        return EpdiFrame::decode(raw.data() + second_frame_start, raw.size() - second_frame_start);
+    auto reply = EpdiFrame::decode(read_result.value().data() + reply_at, reply_len);
+    if (!reply.ok() && reply.error() == Error::CRC_MISSMATCH) {
+        serial_.count_crc_error();
     }
-    
-    return EpdiFrame::decode(raw.data(), raw.size());
+    return reply;
+}
+
+void Terminal::register_metrics(obu::MetricsRegistry& registry, const std::string& name) const
+{
+    registry.histogram("obu_command_duration_seconds", "Request to reply time per command, retries included.",
+                       {{"device", name}}, latency_);
 }
 
 Result<bool> Terminal::beep(TerminalAddress addr)
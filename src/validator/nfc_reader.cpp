@@ -1,4 +1,6 @@
 #include "validator/nfc_reader.hpp"
+#include "transport/epdi.hpp"
+#include "common/messages.hpp"
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
@@ -6,6 +8,7 @@
 #include <sstream>
 #include <iomanip>
 #include <poll.h>
+#include <chrono>
 
 namespace validator {
 
@@ -17,47 +20,23 @@ NfcReader::~NfcReader()
     serial_.close();
 }
 
+// 921600 8N1 with the UART in low-latency mode. At this rate a whole card
+// frame is on the wire in well under a millisecond, so a short frame gap is enough.
+SerialProfile NfcReader::link_profile()
+{
+    SerialProfile profile;
+    profile.baud = DEFAULT_BAUD;
+    profile.vmin = 0;
+    profile.vtime = 1;
+    profile.frame_gap_ms = FRAME_GAP_MS;
+    profile.low_latency = true;
+    profile.rx_trigger_bytes = 1;
+    return profile;
+}
+
 Result<bool> NfcReader::configure_serial()
 {
-    int fd = ::open(port_.c_str(), O_RDWR | O_NOCTTY);
-    if (fd < 0) {
-        last_error_ = "Failed to open port";
-        return Result<bool>::failure(Error::PORT_ERROR);
-    }
-    
-    struct termios tty;
-    memset(&tty, 0, sizeof(tty));
-    
-    if (tcgetattr(fd, &tty) != 0) {
-        ::close(fd);
-        last_error_ = "Failed to get port attributes";
-        return Result<bool>::failure(Error::PORT_ERROR);
-    }
-    
-    cfsetospeed(&tty, B921600);
-    cfsetispeed(&tty, B921600);
-    
-    tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;
-    tty.c_iflag &= ~IGNBRK;
-    tty.c_lflag = 0;
-    tty.c_oflag = 0;
-    tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 10;
-    tty.c_cflag |= (CLOCAL | CREAD);
-    tty.c_cflag &= ~(PARENB | PARODD);
-    tty.c_cflag &= ~CSTOPB;
-    tty.c_cflag &= ~CRTSCTS;
-    
-    if (tcsetattr(fd, TCSANOW, &tty) != 0) {
-        ::close(fd);
-        last_error_ = "Failed to set port attributes";
-        return Result<bool>::failure(Error::PORT_ERROR);
-    }
-    
-    tcflush(fd, TCIOFLUSH);
-    ::close(fd);
-    
-    auto result = serial_.open(port_);
+    auto result = serial_.open(port_, link_profile());
     if (!result.ok()) {
         last_error_ = "Failed to open port";
         return Result<bool>::failure(result.error());
@@ -86,11 +65,13 @@ Result<bool> NfcReader::send_command(uint8_t cmd, const std::vector<uint8_t>& da
     return Result<bool>::success(true);
 }
 
+// Returns as soon as a complete DLE SYNC ... DLE ETX frame is in.
 Result<std::vector<uint8_t>> NfcReader::read_response(int timeout_ms)
 {
     serial_.set_timeout_ms(timeout_ms);
-    bool running = true;
-    return serial_.read(running);
+    return serial_.read_frame([](const std::vector<unsigned char>& rx) {
+        return EpdiFrame::complete_length(rx.data(), rx.size()) > 0;
+    });
 }
 
 Result<bool> NfcReader::authenticate()
@@ -102,21 +83,41 @@ Result<bool> NfcReader::authenticate()
     
     auto resp_result = read_response(1000);
     
-    std::vector<uint8_t> key;
+    key_.clear();
     if (resp_result.ok() && resp_result.value().size() >= 4) {
         auto& resp = resp_result.value();
-        key.assign(resp.begin() + 4, resp.end());
+        key_.assign(resp.begin() + 4, resp.end());
     }
     
-    send_result = send_command(CMD_AUTH_B, key);
+    send_result = send_command(CMD_AUTH_B, key_);
     if (!send_result.ok()) {
         return Result<bool>::failure(send_result.error());
     }
     
+    // The reply is only read off the line: readers differ in what they send
+    // back, and a fresh key exchange has nothing better to fall back to.
     read_response(1000);
     return Result<bool>::success(true);
 }
 
+bool NfcReader::acknowledges(const Result<std::vector<uint8_t>>& reply, uint8_t cmd)
+{
+    if (!reply.ok()) {
+        return false;
+    }
+    const auto& frame = reply.value();
+    size_t len = EpdiFrame::complete_length(frame.data(), frame.size());
+    if (len == 0) {
+        return false;
+    }
+    auto payload = EpdiFrame::decode(frame.data(), len);
+    if (!payload.ok()) {
+        return false;
+    }
+    const auto& p = payload.value();
+    return p.size() >= 4 && p[0] == ADDR_RESP && p[1] == cmd && (p.size() == 4 || p[4] == 0);
+}
+
 Result<bool> NfcReader::enable_reading()
 {
     return send_command(CMD_ENABLE);
@@ -143,6 +144,39 @@ Result<bool> NfcReader::initialize()
     return Result<bool>::success(true);
 }
 
+Result<bool> NfcReader::resume(const Session& session)
+{
+    if (initialized_.load()) {
+        return Result<bool>::success(false);
+    }
+    if (session.key.empty()) {
+        auto init_result = initialize();
+        return init_result.ok() ? Result<bool>::success(false) : init_result;
+    }
+    
+    auto config_result = configure_serial();
+    if (!config_result.ok()) {
+        return Result<bool>::failure(config_result.error());
+    }
+    
+    counter_ = session.counter;
+    key_ = session.key;
+    auto send_result = send_command(CMD_AUTH_B, key_);
+    if (send_result.ok() && acknowledges(read_response(1000), CMD_AUTH_B)) {
+        initialized_.store(true);
+        return Result<bool>::success(true);
+    }
+    
+    // Cached key rejected: full key exchange on the port that is already open.
+    auto auth_result = authenticate();
+    if (!auth_result.ok()) {
+        last_error_ = "Authentication failed";
+        return Result<bool>::failure(auth_result.error());
+    }
+    initialized_.store(true);
+    return Result<bool>::success(false);
+}
+
 std::string NfcReader::bytes_to_hex(const std::vector<uint8_t>& data)
 {
     std::ostringstream oss;
@@ -203,46 +237,28 @@ std::optional<NfcCardInfo> NfcReader::parse_card_info(const std::vector<uint8_t>
         payload.push_back(byte);
     }
     
-    if (payload.size() < 6) {
-        return std::nullopt;
-    }
-    
-    size_t pos = 0;
-    pos++; // dest_addr
-    uint8_t service = payload[pos++];
-    pos++; // counter
-    pos++; // source_addr
-    uint8_t ack = payload[pos++];
-    
-    if (service != SERVICE_READ_CARD || ack != 0) {
+    auto reply = obu::CardReplySchema::decode(payload);
+    if (!reply.ok()) {
         return std::nullopt;
     }
     
-    if (payload.size() - pos < 13) {
+    const auto& card = reply.value();
+    if (card.service != SERVICE_READ_CARD || card.ack != 0) {
         return std::nullopt;
     }
     
     NfcCardInfo info;
-    
-    info.atqa = static_cast<uint16_t>((static_cast<uint16_t>(payload[pos]) << 8) | payload[pos + 1]);
-    pos += 2;
-    
-    info.ct = payload[pos++];
-    
-    std::vector<uint8_t> uid;
-    uid.insert(uid.end(), payload.begin() + pos, payload.begin() + pos + 3);
-    pos += 3;
-    
-    info.bcc1 = payload[pos++];
-    
-    uid.insert(uid.end(), payload.begin() + pos, payload.begin() + pos + 4);
-    pos += 4;
-    
-    info.bcc2 = payload[pos++];
-    info.sak = payload[pos++];
-    
+    info.atqa = card.atqa;
+    info.ct = card.ct;
+    info.bcc1 = card.bcc1;
+    info.bcc2 = card.bcc2;
+    info.sak = card.sak;
+    
+    std::vector<uint8_t> uid(card.uid_cl1.begin(), card.uid_cl1.end());
+    uid.insert(uid.end(), card.uid_cl2.begin(), card.uid_cl2.end());
     info.uid_hex = bytes_to_hex(uid);
     
+    size_t pos = obu::CardReplySchema::size;
     if (payload.size() > pos) {
         info.extra.assign(payload.begin() + pos, payload.end());
     }
@@ -260,6 +276,7 @@ Result<bool> NfcReader::start_reading()
     }
     
     running_.store(true);
+    serial_.clear_cancel();
     std::vector<uint8_t> frame_buffer;
     
     while (running_.load()) {
@@ -273,12 +290,13 @@ Result<bool> NfcReader::start_reading()
         frame_buffer.clear();
         
         while (running_.load()) {
-            serial_.set_timeout_ms(100);
-            bool run_flag = running_.load();
-            auto read_result = serial_.read(run_flag);
+            // Blocks until the reader sends something or stop() cancels.
+            serial_.set_timeout_ms(SerialPort::WAIT_FOREVER);
+            auto read_result = serial_.read();
             
             if (!read_result.ok()) {
                 if (read_result.error() == Error::TIMEOUT) {
+                    if (serial_.is_cancelled()) running_.store(false);
                     continue;
                 }
                 last_error_ = "Read error";
@@ -291,7 +309,14 @@ Result<bool> NfcReader::start_reading()
             
             auto card_info = parse_card_info(frame_buffer);
             if (card_info.has_value()) {
-                if (card_callback_) {
+                if (status_) {
+                    status_->publish_uid(obu::StatusSource::VALIDATOR, card_info->uid_hex);
+                }
+                if (card_callback_ && executor_) {
+                    executor_->post([callback = card_callback_, card = std::move(card_info.value())] {
+                        callback(card);
+                    });
+                } else if (card_callback_) {
                     card_callback_(card_info.value());
                 }
                 break;
@@ -315,31 +340,46 @@ Result<NfcCardInfo> NfcReader::read_single_card(int timeout_ms)
         }
     }
     
+    serial_.clear_cancel();
     auto enable_result = enable_reading();
     if (!enable_result.ok()) {
         return Result<NfcCardInfo>::failure(enable_result.error());
     }
     
     std::vector<uint8_t> frame_buffer;
-    int elapsed = 0;
-    constexpr int poll_interval = 100;
-    
-    while (timeout_ms == 0 || elapsed < timeout_ms) {
-        serial_.set_timeout_ms(poll_interval);
-        bool running = true;
-        auto read_result = serial_.read(running);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    
+    // One blocking read per chunk of data; TIMEOUT means the deadline passed or stop() cancelled.
+    while (true) {
+        int left = SerialPort::WAIT_FOREVER;
+        if (timeout_ms != 0) {
+            left = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (left <= 0) {
+                break;
+            }
+        }
+        serial_.set_timeout_ms(left);
+        auto read_result = serial_.read();
         
-        if (read_result.ok()) {
-            auto& data = read_result.value();
-            frame_buffer.insert(frame_buffer.end(), data.begin(), data.end());
-            
-            auto card_info = parse_card_info(frame_buffer);
-            if (card_info.has_value()) {
-                return Result<NfcCardInfo>::success(card_info.value());
+        if (!read_result.ok()) {
+            if (read_result.error() == Error::TIMEOUT) {
+                break;
             }
+            last_error_ = "Read error";
+            return Result<NfcCardInfo>::failure(read_result.error());
         }
         
-        elapsed += poll_interval;
+        auto& data = read_result.value();
+        frame_buffer.insert(frame_buffer.end(), data.begin(), data.end());
+        
+        auto card_info = parse_card_info(frame_buffer);
+        if (card_info.has_value()) {
+            if (status_) {
+                status_->publish_uid(obu::StatusSource::VALIDATOR, card_info->uid_hex);
+            }
+            return Result<NfcCardInfo>::success(card_info.value());
+        }
         
         if (frame_buffer.size() > 1024) {
             frame_buffer.clear();
@@ -350,4 +390,12 @@ Result<NfcCardInfo> NfcReader::read_single_card(int timeout_ms)
     return Result<NfcCardInfo>::failure(Error::TIMEOUT);
 }
 
-}
\ No newline at end of file
+void NfcReader::register_metrics(obu::MetricsRegistry& registry, const std::string& name) const
+{
+    const std::atomic<bool>* running = &running_;
+    registry.gauge("obu_reader_running", "1 while the reader loop is running.", {{"reader", name}},
+                   [running] { return running->load() ? 1.0 : 0.0; });
+    serial_.register_metrics(registry, name);
+}
+
+}